@@ -0,0 +1,149 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Usage: bench.run [--out results.json] [--baseline baseline.json] [--tolerance 0.1] [filter]
+// Writes the results as JSON to --out (or stdout) and a table to stderr.
+// With --baseline it reports the change against it and fails when a benchmark got slower
+// by more than the tolerance plus three standard deviations.
+
+extern void bench_vec();
+extern void bench_quat();
+extern void bench_mat();
+extern void bench_skinning();
+extern void bench_packing();
+extern void bench_fast_math();
+extern void bench_trs();
+extern void bench_projection();
+
+struct result {
+	std::string name;
+	size_t      ops;
+	double      ns_per_op;
+	double      variance;
+};
+
+static std::vector<result> results;
+static const char*         filter = nullptr;
+
+void _benchmarkResult(const char* name, size_t ops, double ns_per_op, double variance) {
+	results.push_back({ name, ops, ns_per_op, variance });
+	fprintf(stderr, "%-40s %10.3f ns/op  +- %8.3f  %10.1f Mop/s\n", name, ns_per_op, std::sqrt(variance), 1e3 / ns_per_op);
+}
+
+static
+void write_json(std::ostream& out) {
+	out << "{\n\t\"benchmarks\": [\n";
+	for(size_t i = 0; i < results.size(); i++) {
+		result const& r = results[i];
+		out
+			<< "\t\t{ \"name\": \"" << r.name << "\""
+			<< ", \"ops\": " << r.ops
+			<< ", \"ns_per_op\": " << r.ns_per_op
+			<< ", \"stddev\": " << std::sqrt(r.variance)
+			<< ", \"variance\": " << r.variance
+			<< ", \"mops_per_s\": " << 1e3 / r.ns_per_op
+			<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "\t]\n}\n";
+}
+
+/// Reads the benchmarks back from a file written by write_json(), which is all it understands
+static
+std::vector<result> read_json(std::istream& in) {
+	auto number = [](std::string const& line, const char* key) {
+		size_t const pos = line.find(key);
+		return pos == std::string::npos ? 0.0 : atof(line.c_str() + pos + strlen(key));
+	};
+
+	std::vector<result> parsed;
+	std::string line;
+	while(std::getline(in, line)) {
+		size_t const start = line.find("\"name\": \"");
+		if(start == std::string::npos) continue;
+		size_t const name_start = start + strlen("\"name\": \"");
+		size_t const name_end   = line.find('"', name_start);
+
+		result r;
+		r.name      = line.substr(name_start, name_end - name_start);
+		r.ops       = (size_t) number(line, "\"ops\": ");
+		r.ns_per_op = number(line, "\"ns_per_op\": ");
+		r.variance  = number(line, "\"variance\": ");
+		parsed.push_back(r);
+	}
+	return parsed;
+}
+
+static
+int compare(std::vector<result> const& baseline, double tolerance) {
+	int regressions = 0;
+	fprintf(stderr, "\n%-40s %12s %12s %9s\n", "compared to baseline", "baseline", "now", "change");
+	for(result const& r : results) {
+		for(result const& b : baseline) {
+			if(b.name != r.name) continue;
+
+			double const change = r.ns_per_op / b.ns_per_op - 1;
+			double const noise  = 3 * std::sqrt(r.variance + b.variance) / b.ns_per_op;
+			bool   const slower = change > tolerance + noise;
+			regressions += slower;
+			fprintf(stderr, "%-40s %12.3f %12.3f %+8.1f%%%s\n", r.name.c_str(), b.ns_per_op, r.ns_per_op, change * 100, slower ? "  REGRESSION" : "");
+		}
+	}
+	return regressions;
+}
+
+bool bench_enabled(const char* name) {
+	return !filter || strstr(name, filter);
+}
+
+int main(int argc, char** argv) {
+	const char* out_path      = nullptr;
+	const char* baseline_path = nullptr;
+	double      tolerance     = 0.1;
+
+	for(int i = 1; i < argc; i++) {
+		if(!strcmp(argv[i], "--out") && i + 1 < argc)            out_path = argv[++i];
+		else if(!strcmp(argv[i], "--baseline") && i + 1 < argc)  baseline_path = argv[++i];
+		else if(!strcmp(argv[i], "--tolerance") && i + 1 < argc) tolerance = atof(argv[++i]);
+		else filter = argv[i];
+	}
+
+	bench_vec();
+	bench_quat();
+	bench_mat();
+	bench_skinning();
+	bench_packing();
+	bench_fast_math();
+	bench_trs();
+	bench_projection();
+
+	if(out_path) {
+		std::ofstream out(out_path);
+		write_json(out);
+	}
+	else {
+		write_json(std::cout);
+	}
+
+	if(baseline_path) {
+		std::ifstream in(baseline_path);
+		if(!in) {
+			fprintf(stderr, "Couldn't open baseline %s\n", baseline_path);
+			return 1;
+		}
+		int const regressions = compare(read_json(in), tolerance);
+		if(regressions) {
+			fprintf(stderr, "%i benchmark(s) got slower\n", regressions);
+			return 1;
+		}
+	}
+
+	return 0;
+}
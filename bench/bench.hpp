@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+/// Keeps the compiler from optimizing away the computation of value
+template<class T> inline
+void do_not_optimize(T const& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+bool bench_enabled(const char* name);
+void _benchmarkResult(const char* name, size_t ops, double ns_per_op, double variance);
+
+/// Elements per batch, small enough to stay in L1/L2 like a typical per frame batch
+constexpr size_t bench_batch = 4096;
+
+/// Samples taken per benchmark, each running for at least sample_ns
+constexpr unsigned bench_samples   = 15;
+constexpr double   bench_sample_ns = 2e6;
+
+/// Times fn(), which does ops operations per call, and reports ns/op with its variance across samples
+template<class Fn>
+void benchmark(const char* name, size_t ops, Fn&& fn) {
+	using clock = std::chrono::steady_clock;
+
+	if(!bench_enabled(name)) return;
+
+	auto time = [&](size_t runs) {
+		auto const start = clock::now();
+		for(size_t i = 0; i < runs; i++) fn();
+		return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+	};
+
+	// Warm up and find how many runs make a sample long enough to time reliably
+	size_t runs = 1;
+	for(double t = time(runs); t < bench_sample_ns; t = time(runs)) {
+		runs *= 2;
+	}
+
+	double sample[bench_samples];
+	double mean = 0;
+	for(double& s : sample) {
+		s = time(runs) / (double(runs) * ops);
+		mean += s;
+	}
+	mean /= bench_samples;
+
+	double variance = 0;
+	for(double s : sample) variance += (s - mean) * (s - mean);
+	variance /= bench_samples - 1;
+
+	_benchmarkResult(name, ops, mean, variance);
+}
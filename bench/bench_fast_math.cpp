@@ -0,0 +1,68 @@
+#include "bench.hpp"
+
+#include <xmath/fast_math>
+#include <xmath/vec3>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_fast_math() {
+	std::mt19937 rng(6);
+	std::uniform_real_distribution<float> dist(-10, 10);
+	std::vector<float> a(bench_batch), b(bench_batch), unit(bench_batch);
+	for(float& f : a) f = dist(rng);
+	for(float& f : b) f = dist(rng);
+	for(float& f : unit) f = dist(rng) / 10;
+
+	std::vector<vec3> v(bench_batch), out(bench_batch);
+	for(vec3& p : v) p = vec3(dist(rng), dist(rng), dist(rng));
+	std::vector<float> s(bench_batch), c(bench_batch);
+
+	benchmark("normalize sqrt", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = v[i] / v[i].length();
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("normalize fast_rsqrt", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = v[i] * fast_rsqrt(v[i].length2());
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("sinf + cosf", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) {
+			s[i] = sinf(a[i]);
+			c[i] = cosf(a[i]);
+		}
+		do_not_optimize(s[0]);
+		do_not_optimize(c[0]);
+	});
+
+	benchmark("fast_sincos", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) fast_sincos(a[i], s[i], c[i]);
+		do_not_optimize(s[0]);
+		do_not_optimize(c[0]);
+	});
+
+	benchmark("atan2f", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) s[i] = atan2f(a[i], b[i]);
+		do_not_optimize(s[0]);
+	});
+
+	benchmark("fast_atan2", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) s[i] = fast_atan2(a[i], b[i]);
+		do_not_optimize(s[0]);
+	});
+
+	benchmark("acosf", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) s[i] = acosf(unit[i]);
+		do_not_optimize(s[0]);
+	});
+
+	benchmark("fast_acos", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) s[i] = fast_acos(unit[i]);
+		do_not_optimize(s[0]);
+	});
+}
@@ -0,0 +1,170 @@
+#include "bench.hpp"
+
+#include <xmath/mat3>
+#include <xmath/mat4>
+#include <xmath/mat>
+#include <xmath/perspective>
+#include <xmath/transform>
+#include <xmath/solve>
+#include <xmath/camera>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_mat() {
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dist(-10, 10);
+	auto random_vec3 = [&]() { return vec3(dist(rng), dist(rng), dist(rng)); };
+	auto random_vec4 = [&]() { return vec4(dist(rng), dist(rng), dist(rng), dist(rng)); };
+
+	std::vector<mat3> a3(bench_batch), b3(bench_batch), out3(bench_batch);
+	for(mat3& m : a3) m = mat3(random_vec3(), random_vec3(), random_vec3());
+	for(mat3& m : b3) m = mat3(random_vec3(), random_vec3(), random_vec3());
+
+	std::vector<mat4> a4(bench_batch), b4(bench_batch), out4(bench_batch);
+	for(mat4& m : a4) m = mat4(random_vec4(), random_vec4(), random_vec4(), random_vec4());
+	for(mat4& m : b4) m = mat4(random_vec4(), random_vec4(), random_vec4(), random_vec4());
+
+	std::vector<vec4> v4(bench_batch), out_v4(bench_batch);
+	for(vec4& v : v4) v = random_vec4();
+
+	std::vector<vec3> v3(bench_batch), out_v3(bench_batch);
+	for(vec3& v : v3) v = random_vec3();
+
+	benchmark("mat3 * mat3", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out3[i] = a3[i] * b3[i];
+		do_not_optimize(out3[0]);
+	});
+
+	benchmark("mat4 * mat4", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out4[i] = a4[i] * b4[i];
+		do_not_optimize(out4[0]);
+	});
+
+	std::vector<dmat4> da4(a4.begin(), a4.end()), db4(b4.begin(), b4.end()), dout4(bench_batch);
+	std::vector<dvec4> dv4(bench_batch), dout_v4(bench_batch);
+	for(size_t i = 0; i < bench_batch; i++) dv4[i] = dvec4(v4[i]);
+
+	benchmark("dmat4 * dmat4", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) dout4[i] = da4[i] * db4[i];
+		do_not_optimize(dout4[0]);
+	});
+
+	benchmark("dmat4 * dvec4", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) dout_v4[i] = da4[i] * dv4[i];
+		do_not_optimize(dout_v4[0]);
+	});
+
+	// Matrices built right before they are used, not loaded from memory
+	std::vector<quat> rotations(bench_batch);
+	for(quat& q : rotations) q = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+
+	benchmark("mat4 * mat4::transform", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out4[i] = a4[i] * mat4::transform(rotations[i], v3[i]);
+		do_not_optimize(out4[0]);
+	});
+
+	benchmark("mat4::transform inverse_rigid", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out4[i] = mat4::transform(rotations[i], v3[i]).inverse_rigid();
+		do_not_optimize(out4[0]);
+	});
+
+	std::vector<affine3> a34(bench_batch), b34(bench_batch), out34(bench_batch);
+	for(size_t i = 0; i < bench_batch; i++) {
+		a34[i] = affine3(a4[i]);
+		b34[i] = affine3(b4[i]);
+	}
+
+	benchmark("affine3 * affine3", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out34[i] = a34[i] * b34[i];
+		do_not_optimize(out34[0]);
+	});
+
+	benchmark("mat4 inverse_affine", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out4[i] = a4[i].inverse_affine();
+		do_not_optimize(out4[0]);
+	});
+
+	benchmark("affine3 inverse", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out34[i] = a34[i].inverse();
+		do_not_optimize(out34[0]);
+	});
+
+	benchmark("mat4 * vec4", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out_v4[i] = a4[i] * v4[i];
+		do_not_optimize(out_v4[0]);
+	});
+
+	// A vec4 built from scalars going straight into an operator, like transforming a point
+	benchmark("mat4 * vec4(p, 1)", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out_v4[i] = a4[i] * vec4(v3[i].x, v3[i].y, v3[i].z, 1);
+		do_not_optimize(out_v4[0]);
+	});
+
+	benchmark("mat3 solveWithCramersRule", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) {
+			mat3 const& m = a3[i];
+			out_v3[i] = mat3::solveWithCramersRule(m[0], m[1], m[2], v3[i]);
+		}
+		do_not_optimize(out_v3[0]);
+	});
+
+	vec3_soa sa(bench_batch), sb(bench_batch), sc(bench_batch), sd(bench_batch), sx;
+	for(size_t i = 0; i < bench_batch; i++) {
+		sa.set(i, a3[i][0]);
+		sb.set(i, a3[i][1]);
+		sc.set(i, a3[i][2]);
+		sd.set(i, v3[i]);
+	}
+	std::vector<uint8_t> singular(bench_batch);
+
+	benchmark("solve3_batch", bench_batch, [&]() {
+		do_not_optimize(solve3_batch(sa, sb, sc, sd, sx, singular.data()));
+	});
+
+	std::uniform_real_distribution<float> fov(.5f, 2.f);
+	std::vector<float> fovs(bench_batch);
+	for(float& f : fovs) f = fov(rng);
+
+	benchmark("perspective", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out4[i] = perspective(fovs[i], 1920, 1080, .1f, 1000.f);
+		do_not_optimize(out4[0]);
+	});
+
+	// One frame: the camera moves, then 4 render passes ask for view_projection(), its inverse and the frustum
+	std::vector<vec3> positions(bench_batch);
+	for(vec3& p : positions) p = random_vec3();
+	quat const orientation = quat::angle_axis(.4f, vec3(1, 2, 3).normalize());
+	unsigned const passes = 4;
+
+	benchmark("camera frame recompute", bench_batch, [&]() {
+		float sum = 0;
+		for(size_t i = 0; i < bench_batch; i++) {
+			vec3 position = positions[i];
+			for(unsigned pass = 0; pass < passes; pass++) {
+				// Opaque every pass, otherwise the compiler merges the identical passes into one
+				do_not_optimize(position);
+				mat4 const view = mat4::transform(orientation, position).inverse_rigid();
+				mat4 const view_projection = perspective(1.2f, 1920, 1080, .1f, 1000.f) * view;
+				frustum const f(view_projection);
+				sum += view_projection.inverse().data[0] + f.planes[0].x;
+			}
+		}
+		do_not_optimize(sum);
+	});
+
+	camera cam(vec3(0), orientation, 1.2f, 1920.f / 1080, .1f, 1000.f);
+	benchmark("camera frame cached", bench_batch, [&]() {
+		float sum = 0;
+		for(size_t i = 0; i < bench_batch; i++) {
+			cam.set_position(positions[i]);
+			for(unsigned pass = 0; pass < passes; pass++) {
+				do_not_optimize(cam);
+				sum += cam.inverse_view_projection().data[0] + cam.frustum().planes[0].x + cam.view_projection().data[0];
+			}
+		}
+		do_not_optimize(sum);
+	});
+}
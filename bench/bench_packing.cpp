@@ -0,0 +1,70 @@
+#include "bench.hpp"
+
+#include <xmath/packing>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_packing() {
+	std::mt19937 rng(6);
+	std::normal_distribution<float> dist;
+
+	std::vector<quat> quats(bench_batch), quats_out(bench_batch);
+	std::vector<vec3> normals(bench_batch), normals_out(bench_batch);
+	std::vector<vec4> colors(bench_batch), colors_out(bench_batch);
+	for(size_t i = 0; i < bench_batch; i++) {
+		quats[i]   = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+		normals[i] = vec3(dist(rng), dist(rng), dist(rng)).normalize();
+		colors[i]  = vec4(dist(rng), dist(rng), dist(rng), 1);
+	}
+
+	std::vector<quat32> q32(bench_batch);
+	std::vector<quat48> q48(bench_batch);
+	std::vector<oct32>  oct(bench_batch);
+	std::vector<half4>  half(bench_batch);
+
+	benchmark("quat32 pack scalar", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) q32[i] = quat32(quats[i]);
+		do_not_optimize(q32[0]);
+	});
+	benchmark("quat32 pack_batch", bench_batch, [&]() {
+		pack_batch(quats.data(), q32.data(), bench_batch);
+		do_not_optimize(q32[0]);
+	});
+	benchmark("quat32 unpack_batch", bench_batch, [&]() {
+		unpack_batch(q32.data(), quats_out.data(), bench_batch);
+		do_not_optimize(quats_out[0]);
+	});
+	benchmark("quat48 pack_batch", bench_batch, [&]() {
+		pack_batch(quats.data(), q48.data(), bench_batch);
+		do_not_optimize(q48[0]);
+	});
+
+	benchmark("oct32 pack scalar", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) oct[i] = oct32(normals[i]);
+		do_not_optimize(oct[0]);
+	});
+	benchmark("oct32 pack_batch", bench_batch, [&]() {
+		pack_batch(normals.data(), oct.data(), bench_batch);
+		do_not_optimize(oct[0]);
+	});
+	benchmark("oct32 unpack_batch", bench_batch, [&]() {
+		unpack_batch(oct.data(), normals_out.data(), bench_batch);
+		do_not_optimize(normals_out[0]);
+	});
+
+	benchmark("half4 pack scalar", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) half[i] = half4(colors[i]);
+		do_not_optimize(half[0]);
+	});
+	benchmark("half4 pack_batch", bench_batch, [&]() {
+		pack_batch(colors.data(), half.data(), bench_batch);
+		do_not_optimize(half[0]);
+	});
+	benchmark("half4 unpack_batch", bench_batch, [&]() {
+		unpack_batch(half.data(), colors_out.data(), bench_batch);
+		do_not_optimize(colors_out[0]);
+	});
+}
@@ -0,0 +1,68 @@
+#include "bench.hpp"
+
+#include <xmath/projection>
+#include <xmath/camera>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_projection() {
+	std::mt19937 rng(24);
+	std::uniform_real_distribution<float> dist(0, 1);
+
+	size_t const width = 640, height = 360, pixels = width * height;
+	std::vector<float> depth(pixels);
+	for(float& d : depth) d = dist(rng);
+	std::vector<vec3> positions(pixels);
+
+	camera const cam(vec3(1, 2, 3), quat::angle_axis(.4f, vec3(0, 1, 0)), 1.2f, float(width) / height, .1f, 100.f, depth_mode::reverse_z);
+	mat4 const& inverse = cam.inverse_view_projection();
+
+	benchmark("unproject depth scalar", pixels, [&]() {
+		for(size_t y = 0; y < height; y++) {
+			for(size_t x = 0; x < width; x++) {
+				size_t const i = y * width + x;
+				vec4 const p = inverse * vec4((x + .5f) / width * 2 - 1, 1 - (y + .5f) / height * 2, depth[i], 1);
+				positions[i] = vec3(p.x, p.y, p.z) / p.w;
+			}
+		}
+		do_not_optimize(positions[0]);
+	});
+
+	benchmark("unproject_depth", pixels, [&]() {
+		unproject_depth(inverse, depth.data(), width, height, positions.data(), 1);
+		do_not_optimize(positions[0]);
+	});
+
+	benchmark("unproject_depth threads", pixels, [&]() {
+		unproject_depth(inverse, depth.data(), width, height, positions.data());
+		do_not_optimize(positions[0]);
+	});
+
+	// Mostly visible points, some off screen and behind the camera
+	std::uniform_real_distribution<float> spread(-50, 50);
+	std::vector<vec3> points(bench_batch);
+	for(vec3& p : points) p = vec3(spread(rng), spread(rng), spread(rng));
+	std::vector<vec2> screen(bench_batch);
+	std::vector<float> depths(bench_batch);
+	std::vector<uint8_t> clip(bench_batch);
+	mat4 const& view_projection = cam.view_projection();
+	rect const viewport(0, 0, 1920, 1080);
+
+	benchmark("project points scalar", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) {
+			vec4 const c = view_projection * vec4(points[i].x, points[i].y, points[i].z, 1);
+			clip[i] = (uint8_t) ((c.x < -c.w) | (c.x > c.w) << 1 | (c.y < -c.w) << 2 | (c.y > c.w) << 3 | (c.z < 0) << 4 | (c.z > c.w) << 5);
+			screen[i] = vec2((c.x / c.w * .5f + .5f) * viewport.size.x, (.5f - c.y / c.w * .5f) * viewport.size.y);
+			depths[i] = c.z / c.w;
+		}
+		do_not_optimize(screen[0]);
+	});
+
+	benchmark("project_to_screen", bench_batch, [&]() {
+		project_to_screen(view_projection, viewport, points.data(), bench_batch, screen.data(), depths.data(), clip.data(), 1);
+		do_not_optimize(screen[0]);
+	});
+}
@@ -0,0 +1,95 @@
+#include "bench.hpp"
+
+#include <xmath/quat>
+#include <xmath/batch>
+#include <xmath/mat3>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+static
+std::vector<quat> random_rotations(size_t n, std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-1, 1);
+	std::vector<quat> result(n);
+	for(quat& q : result) q = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+	return result;
+}
+
+void bench_quat() {
+	std::mt19937 rng(2);
+	std::vector<quat> a = random_rotations(bench_batch, rng);
+	std::vector<quat> b = random_rotations(bench_batch, rng);
+	std::vector<quat> out(bench_batch);
+
+	std::uniform_real_distribution<float> dist(-10, 10);
+	std::vector<vec3> v(bench_batch);
+	for(vec3& p : v) p = vec3(dist(rng), dist(rng), dist(rng));
+	std::vector<vec3> rotated(bench_batch);
+
+	benchmark("quat slerp", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = a[i].slerp(b[i], .3f);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("quat lerp", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = a[i].lerp(b[i], .3f);
+		do_not_optimize(out[0]);
+	});
+
+	std::vector<float> t(bench_batch);
+	for(size_t i = 0; i < bench_batch; i++) t[i] = (i % 100) / 100.f;
+
+	benchmark("slerp_batch", bench_batch, [&]() {
+		slerp_batch(a.data(), b.data(), t.data(), out.data(), bench_batch);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("nlerp_batch", bench_batch, [&]() {
+		nlerp_batch(a.data(), b.data(), t.data(), out.data(), bench_batch);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("quat * quat", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = a[i] * b[i];
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("quat * vec3", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) rotated[i] = a[i] * v[i];
+		do_not_optimize(rotated[0]);
+	});
+
+	benchmark("rotate_batch quat", bench_batch, [&]() {
+		rotate_batch(a[0], v.data(), rotated.data(), bench_batch);
+		do_not_optimize(rotated[0]);
+	});
+
+	benchmark("rotate_batch quats", bench_batch, [&]() {
+		rotate_batch(a.data(), v.data(), rotated.data(), bench_batch);
+		do_not_optimize(rotated[0]);
+	});
+
+	std::vector<mat3> m3(bench_batch);
+	std::vector<mat4> m4(bench_batch);
+	for(size_t i = 0; i < bench_batch; i++) {
+		m3[i] = a[i].to_mat3();
+		m4[i] = mat4(m3[i]);
+	}
+
+	benchmark("quat(mat3)", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = quat(m3[i]);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("to_quat_batch mat3", bench_batch, [&]() {
+		to_quat_batch(m3.data(), out.data(), bench_batch);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("to_quat_batch mat4", bench_batch, [&]() {
+		to_quat_batch(m4.data(), out.data(), bench_batch);
+		do_not_optimize(out[0]);
+	});
+}
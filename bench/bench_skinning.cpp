@@ -0,0 +1,54 @@
+#include "bench.hpp"
+
+#include <xmath/skinning>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_skinning() {
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> dist(-1, 1);
+	std::uniform_int_distribution<uint16_t> bone(0, 63);
+
+	std::vector<skin_matrix> matrices;
+	std::vector<dualquat>    dualquats;
+	for(int i = 0; i < 64; i++) {
+		quat const r = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+		vec3 const t(dist(rng), dist(rng), dist(rng));
+		matrices.push_back(skin_matrix(mat4::transform(r, t)));
+		dualquats.push_back(dualquat(r, t));
+	}
+
+	// A detailed character
+	size_t const n = 50000;
+	std::vector<skin_influences> influences(n);
+	std::vector<vec3> positions(n), normals(n), out_positions(n), out_normals(n);
+	for(size_t i = 0; i < n; i++) {
+		influences[i] = { { bone(rng), bone(rng), bone(rng), bone(rng) }, { .4f, .3f, .2f, .1f } };
+		positions[i]  = vec3(dist(rng), dist(rng), dist(rng));
+		normals[i]    = positions[i].normalize();
+	}
+
+	skin_streams s;
+	s.positions     = positions.data();
+	s.normals       = normals.data();
+	s.out_positions = out_positions.data();
+	s.out_normals   = out_normals.data();
+
+	benchmark("skin linear", n, [&]() {
+		skin_linear(matrices.data(), influences.data(), n, s, 1);
+		do_not_optimize(out_positions[0]);
+	});
+
+	benchmark("skin dual quat", n, [&]() {
+		skin_dual_quat(dualquats.data(), influences.data(), n, s, 1);
+		do_not_optimize(out_positions[0]);
+	});
+
+	benchmark("skin linear threaded", n, [&]() {
+		skin_linear(matrices.data(), influences.data(), n, s);
+		do_not_optimize(out_positions[0]);
+	});
+}
@@ -0,0 +1,45 @@
+#include "bench.hpp"
+
+#include <xmath/trs>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+void bench_trs() {
+	std::mt19937 rng(19);
+	std::uniform_real_distribution<float> dist(-1, 1);
+	auto random_vec3 = [&]() { return vec3(dist(rng), dist(rng), dist(rng)) * 10.f; };
+
+	std::vector<trs> transforms(bench_batch), out(bench_batch);
+	for(trs& t : transforms) {
+		t = trs(random_vec3(), quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize(), vec3(1.5f + dist(rng)));
+	}
+	std::vector<mat4> matrices(bench_batch);
+
+	benchmark("trs to_mat4", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) matrices[i] = transforms[i].to_mat4();
+		do_not_optimize(matrices[0]);
+	});
+
+	benchmark("trs compose_batch", bench_batch, [&]() {
+		compose_batch(transforms.data(), matrices.data(), bench_batch);
+		do_not_optimize(matrices[0]);
+	});
+
+	benchmark("trs(mat4)", bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = trs(matrices[i]);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("trs decompose_batch", bench_batch, [&]() {
+		decompose_batch(matrices.data(), out.data(), bench_batch);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark("trs * trs", bench_batch, [&]() {
+		for(size_t i = 0; i + 1 < bench_batch; i++) out[i] = transforms[i] * transforms[i + 1];
+		do_not_optimize(out[0]);
+	});
+}
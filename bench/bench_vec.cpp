@@ -0,0 +1,68 @@
+#include "bench.hpp"
+
+#include <xmath/vec2>
+#include <xmath/vec3>
+#include <xmath/vec4>
+#include <xmath/vec>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+static std::mt19937                          rng(1);
+static std::uniform_real_distribution<float> dist(-10, 10);
+
+static void randomize(vec2& v) { v = vec2(dist(rng), dist(rng)); }
+static void randomize(vec3& v) { v = vec3(dist(rng), dist(rng), dist(rng)); }
+static void randomize(vec4& v) { v = vec4(dist(rng), dist(rng), dist(rng), dist(rng)); }
+static void randomize(dvec4& v) { v = dvec4(dist(rng), dist(rng), dist(rng), dist(rng)); }
+
+static vec2 normalize(vec2 const& v) { return v.normalized(); }
+static vec3 normalize(vec3 const& v) { return v.normalize(); }
+static vec4 normalize(vec4 const& v) { return v.normalize(); }
+static dvec4 normalize(dvec4 const& v) { return v.normalize(); }
+
+template<class V>
+static
+std::vector<V> random_vectors(size_t n) {
+	std::vector<V> result(n);
+	for(V& v : result) randomize(v);
+	return result;
+}
+
+template<class V>
+static
+void bench_arithmetic(const char* add_name, const char* madd_name, const char* normalize_name, const char* dot_name) {
+	std::vector<V> a = random_vectors<V>(bench_batch);
+	std::vector<V> b = random_vectors<V>(bench_batch);
+	std::vector<V> out(bench_batch);
+
+	benchmark(add_name, bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = a[i] + b[i];
+		do_not_optimize(out[0]);
+	});
+
+	benchmark(madd_name, bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = a[i] * b[i] + out[i] * 0.5f;
+		do_not_optimize(out[0]);
+	});
+
+	benchmark(normalize_name, bench_batch, [&]() {
+		for(size_t i = 0; i < bench_batch; i++) out[i] = normalize(a[i]);
+		do_not_optimize(out[0]);
+	});
+
+	benchmark(dot_name, bench_batch, [&]() {
+		float sum = 0;
+		for(size_t i = 0; i < bench_batch; i++) sum += dot(a[i], b[i]);
+		do_not_optimize(sum);
+	});
+}
+
+void bench_vec() {
+	bench_arithmetic<vec2>("vec2 add", "vec2 mul add", "vec2 normalize", "vec2 dot");
+	bench_arithmetic<vec3>("vec3 add", "vec3 mul add", "vec3 normalize", "vec3 dot");
+	bench_arithmetic<vec4>("vec4 add", "vec4 mul add", "vec4 normalize", "vec4 dot");
+	bench_arithmetic<dvec4>("dvec4 add", "dvec4 mul add", "dvec4 normalize", "dvec4 dot");
+}
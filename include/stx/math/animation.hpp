@@ -0,0 +1,165 @@
+#pragma once
+
+#include "vec3.hpp"
+#include "quat.hpp"
+#include "soa.hpp"
+#include "batch.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stx {
+
+namespace detail {
+
+inline float interpolate_key(float a, float b, float k) noexcept { return a + (b - a) * k; }
+inline vec3 interpolate_key(vec3 const& a, vec3 const& b, float k) noexcept { return a.mix(b, k); }
+inline quat interpolate_key(quat const& a, quat const& b, float k) noexcept { return a.slerp(b, k); }
+
+} // namespace detail
+
+/// Keyframes of one animated value (float, vec3 or quat), interpolated linearly (slerp for quat). @ingroup stxmath
+/// Key times and values are kept in separate arrays, so searching a time only touches the densely packed times.
+/// Sampling before the first or after the last key returns the first or last value.
+template<class T>
+class animation_track {
+public:
+	animation_track() = default;
+
+	/// Appends a key, times have to be ascending
+	void add(float time, T const& value) {
+		m_times.push_back(time);
+		m_values.push_back(value);
+	}
+
+	void reserve(size_t n) {
+		m_times.reserve(n);
+		m_values.reserve(n);
+	}
+
+	size_t size()  const noexcept { return m_times.size(); }
+	bool   empty() const noexcept { return m_times.empty(); }
+	float  start() const noexcept { return m_times.empty() ? 0 : m_times.front(); }
+	float  end()   const noexcept { return m_times.empty() ? 0 : m_times.back(); }
+
+	float const* times()  const noexcept { return m_times.data(); }
+	T const*     values() const noexcept { return m_values.data(); }
+
+	/// Index k of the keys k and k + 1 surrounding t, clamped to [0, size() - 2]. Needs at least two keys.
+	/// cursor holds where the last search of this playback ended: moving forward by a few keys is a short
+	/// linear walk from there, so playback costs amortized O(1). Jumps fall back to a binary search.
+	size_t find(float t, uint32_t& cursor) const noexcept {
+		size_t const last = m_times.size() - 2;
+		size_t k = cursor < last ? cursor : last;
+		if(m_times[k] <= t) {
+			for(unsigned step = 0; step < 4 && k < last && m_times[k + 1] <= t; step++) k++;
+			if(k < last && m_times[k + 1] <= t) k = find(t);
+		}
+		else {
+			k = find(t);
+		}
+		cursor = (uint32_t) k;
+		return k;
+	}
+
+	/// Binary search version of find(t, cursor)
+	size_t find(float t) const noexcept {
+		size_t const k = std::upper_bound(m_times.begin(), m_times.end(), t) - m_times.begin();
+		return std::min(k ? k - 1 : 0, m_times.size() - 2);
+	}
+
+	/// Position of t between keys k and k + 1, clamped to [0, 1]
+	float fraction(size_t k, float t) const noexcept {
+		float const dt = m_times[k + 1] - m_times[k];
+		if(dt <= 0) return t < m_times[k] ? 0.f : 1.f;
+		return std::min(std::max((t - m_times[k]) / dt, 0.f), 1.f);
+	}
+
+	/// Value at time t, continuing from cursor, see find()
+	T sample(float t, uint32_t& cursor) const noexcept {
+		if(m_times.size() < 2) return m_times.empty() ? T() : m_values[0];
+		size_t const k = find(t, cursor);
+		return detail::interpolate_key(m_values[k], m_values[k + 1], fraction(k, t));
+	}
+
+	/// Value at time t
+	T sample(float t) const noexcept {
+		if(m_times.size() < 2) return m_times.empty() ? T() : m_values[0];
+		size_t const k = find(t);
+		return detail::interpolate_key(m_values[k], m_values[k + 1], fraction(k, t));
+	}
+
+private:
+	std::vector<float> m_times;
+	std::vector<T>     m_values;
+};
+
+/// Playback state of one animation_clip instance: the cursor of every track and scratch space for batch sampling. @ingroup stxmath
+struct animation_cursor {
+	std::vector<uint32_t> keys;
+
+	std::vector<vec3>  from3, to3;
+	std::vector<quat>  fromq, toq;
+	std::vector<float> k3, kq;
+};
+
+/// A set of vec3 (e.g. translation, scale) and quat (rotation) tracks played together. @ingroup stxmath
+struct animation_clip {
+	std::vector<animation_track<vec3>> vec3_tracks;
+	std::vector<animation_track<quat>> quat_tracks;
+
+	float duration() const noexcept {
+		float result = 0;
+		for(auto const& track : vec3_tracks) result = std::max(result, track.end());
+		for(auto const& track : quat_tracks) result = std::max(result, track.end());
+		return result;
+	}
+
+	/// Samples every track at time t into out_vec3[track] and out_quat[track].
+	/// Finds the keys per track through the cursor, then interpolates all tracks at once with SIMD:
+	/// vec3 tracks with vec3x4 packets, quat tracks with slerp_batch() (within 2e-6 of quat::slerp()).
+	void sample(float t, animation_cursor& cursor, vec3* out_vec3, quat* out_quat) const {
+		size_t const n3 = vec3_tracks.size();
+		size_t const nq = quat_tracks.size();
+
+		cursor.keys.resize(n3 + nq);
+		cursor.from3.resize(n3); cursor.to3.resize(n3); cursor.k3.resize(n3);
+		cursor.fromq.resize(nq); cursor.toq.resize(nq); cursor.kq.resize(nq);
+
+		gather(vec3_tracks, t, cursor.keys.data(),      cursor.from3.data(), cursor.to3.data(), cursor.k3.data());
+		gather(quat_tracks, t, cursor.keys.data() + n3, cursor.fromq.data(), cursor.toq.data(), cursor.kq.data());
+
+		size_t i = 0;
+		for(; i + vec3x4::width <= n3; i += vec3x4::width) {
+			vec3x4::load(cursor.from3.data() + i)
+				.mix(vec3x4::load(cursor.to3.data() + i), simd::float4::load(cursor.k3.data() + i))
+				.store(out_vec3 + i);
+		}
+		for(; i < n3; i++) out_vec3[i] = cursor.from3[i].mix(cursor.to3[i], cursor.k3[i]);
+
+		slerp_batch(cursor.fromq.data(), cursor.toq.data(), cursor.kq.data(), out_quat, nq);
+	}
+
+private:
+	/// The surrounding keys and fraction of every track
+	template<class T>
+	static void gather(std::vector<animation_track<T>> const& tracks, float t, uint32_t* keys, T* from, T* to, float* k) noexcept {
+		for(size_t i = 0; i < tracks.size(); i++) {
+			animation_track<T> const& track = tracks[i];
+			if(track.size() < 2) {
+				from[i] = to[i] = track.empty() ? T() : track.values()[0];
+				k[i] = 0;
+				continue;
+			}
+			size_t const key = track.find(t, keys[i]);
+			from[i] = track.values()[key];
+			to[i]   = track.values()[key + 1];
+			k[i]    = track.fraction(key, t);
+		}
+	}
+};
+
+} // namespace stx
@@ -0,0 +1,573 @@
+#pragma once
+
+#include "mat4.hpp"
+#include "quat.hpp"
+#include "transform.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace stx {
+
+/// Outputs bigger than this (in bytes) are written with non temporal stores so they don't evict the working set. @ingroup stxmath
+constexpr size_t batch_stream_threshold = 1 << 20;
+
+namespace detail {
+
+inline
+vec3 transform_vector(mat4 const& m, vec3 const& v) noexcept {
+	return vec3(
+		v.x * m[0][0] + v.y * m[1][0] + v.z * m[2][0],
+		v.x * m[0][1] + v.y * m[1][1] + v.z * m[2][1],
+		v.x * m[0][2] + v.y * m[1][2] + v.z * m[2][2]
+	);
+}
+
+#ifdef STX_MATH_HAS_SIMD
+
+inline bool aligned16(void const* p) noexcept { return (reinterpret_cast<uintptr_t>(p) & 15) == 0; }
+
+/// Transforms 4 xyz triples at a time: loads 3 registers, transposes to SoA, multiplies and transposes back.
+/// A whole group is loaded before it is stored, which makes in == out safe.
+template<bool is_point> inline
+void transform_vec3(mat4 const& m, vec3 const* in, vec3* out, size_t n) noexcept {
+	using simd::float4;
+
+	size_t i = 0;
+
+	bool const stream = n * sizeof(vec3) > batch_stream_threshold;
+	if(stream) {
+		// Peel until the output is 16 byte aligned, 4 vec3 are 48 bytes so it stays aligned afterwards
+		for(; i < n && !aligned16(out + i); i++) {
+			out[i] = is_point ? m * in[i] : transform_vector(m, in[i]);
+		}
+	}
+
+	float4 const m00(m[0][0]), m01(m[0][1]), m02(m[0][2]);
+	float4 const m10(m[1][0]), m11(m[1][1]), m12(m[1][2]);
+	float4 const m20(m[2][0]), m21(m[2][1]), m22(m[2][2]);
+	float4 const m30(m[3][0]), m31(m[3][1]), m32(m[3][2]);
+
+	// Whole groups of 4 after the peeled part, a fixed bound keeps GCC from misjudging the trip count of the tail
+	size_t const groups_end = i + (n - i) / 4 * 4;
+	for(; i < groups_end; i += 4) {
+		float const* src = in[i].xyz;
+		float4 x, y, z;
+		simd::deinterleave3(float4::load(src), float4::load(src + 4), float4::load(src + 8), x, y, z);
+
+		float4 rx = simd::madd(z, m20, simd::madd(y, m10, x * m00));
+		float4 ry = simd::madd(z, m21, simd::madd(y, m11, x * m01));
+		float4 rz = simd::madd(z, m22, simd::madd(y, m12, x * m02));
+		if(is_point) {
+			rx += m30;
+			ry += m31;
+			rz += m32;
+		}
+
+		float4 a, b, c;
+		simd::interleave3(rx, ry, rz, a, b, c);
+
+		float* dst = out[i].xyz;
+		if(stream) {
+			a.stream(dst);
+			b.stream(dst + 4);
+			c.stream(dst + 8);
+		}
+		else {
+			a.store(dst);
+			b.store(dst + 4);
+			c.store(dst + 8);
+		}
+	}
+
+	if(stream) simd::fence();
+
+	for(; i < n; i++) {
+		out[i] = is_point ? m * in[i] : transform_vector(m, in[i]);
+	}
+}
+
+#endif // defined(STX_MATH_HAS_SIMD)
+
+} // namespace detail
+
+/// Transforms n points (w = 1) by m, same as out[i] = m * in[i]. @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void transform_points(mat4 const& m, vec3 const* in, vec3* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::transform_vec3<true>(m, in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = m * in[i];
+#endif
+}
+
+/// Transforms n directions (w = 0) by m, i.e. ignores the translation. @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void transform_vectors(mat4 const& m, vec3 const* in, vec3* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::transform_vec3<false>(m, in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = detail::transform_vector(m, in[i]);
+#endif
+}
+
+/// Transforms n points by an affine3, same as out[i] = m.transform_point(in[i]). @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void transform_points(affine3 const& m, vec3 const* in, vec3* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::transform_vec3<true>(m.to_mat4(), in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = m.transform_point(in[i]);
+#endif
+}
+
+/// Transforms n directions by an affine3, same as out[i] = m.transform_vector(in[i]). @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void transform_vectors(affine3 const& m, vec3 const* in, vec3* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::transform_vec3<false>(m.to_mat4(), in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = m.transform_vector(in[i]);
+#endif
+}
+
+/// Transforms n vec4 by m, same as out[i] = m * in[i]. @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void transform_vec4(mat4 const& m, vec4 const* in, vec4* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	using simd::float4;
+
+	float4 const c0 = m[0].to_simd();
+	float4 const c1 = m[1].to_simd();
+	float4 const c2 = m[2].to_simd();
+	float4 const c3 = m[3].to_simd();
+
+	auto mul = [&](float4 v) {
+		float4 r = c0 * simd::splat<0>(v);
+		r = simd::madd(c1, simd::splat<1>(v), r);
+		r = simd::madd(c2, simd::splat<2>(v), r);
+		return simd::madd(c3, simd::splat<3>(v), r);
+	};
+
+	// vec4 is 16 byte aligned in SIMD builds
+	if(n * sizeof(vec4) > batch_stream_threshold) {
+		for(size_t i = 0; i < n; i++) mul(in[i].to_simd()).stream(out[i].xyzw);
+		simd::fence();
+	}
+	else {
+		for(size_t i = 0; i < n; i++) mul(in[i].to_simd()).store_aligned(out[i].xyzw);
+	}
+#else
+	for(size_t i = 0; i < n; i++) out[i] = m * in[i];
+#endif
+}
+
+namespace detail {
+
+inline void load_quats(quat const* q, simd::float4& w, simd::float4& x, simd::float4& y, simd::float4& z) noexcept {
+	w = simd::float4::load(q[0].wxyz);
+	x = simd::float4::load(q[1].wxyz);
+	y = simd::float4::load(q[2].wxyz);
+	z = simd::float4::load(q[3].wxyz);
+	simd::transpose(w, x, y, z);
+}
+inline void load_quats(quat const* q, simd::float8& w, simd::float8& x, simd::float8& y, simd::float8& z) noexcept {
+	simd::float4 w0, x0, y0, z0, w1, x1, y1, z1;
+	load_quats(q,     w0, x0, y0, z0);
+	load_quats(q + 4, w1, x1, y1, z1);
+	w = simd::float8(w0, w1);
+	x = simd::float8(x0, x1);
+	y = simd::float8(y0, y1);
+	z = simd::float8(z0, z1);
+}
+
+inline void store_quats(quat* q, simd::float4 w, simd::float4 x, simd::float4 y, simd::float4 z) noexcept {
+	simd::transpose(w, x, y, z);
+	w.store(q[0].wxyz);
+	x.store(q[1].wxyz);
+	y.store(q[2].wxyz);
+	z.store(q[3].wxyz);
+}
+inline void store_quats(quat* q, simd::float8 const& w, simd::float8 const& x, simd::float8 const& y, simd::float8 const& z) noexcept {
+	store_quats(q,     w.lo(), x.lo(), y.lo(), z.lo());
+	store_quats(q + 4, w.hi(), x.hi(), y.hi(), z.hi());
+}
+
+#ifdef STX_MATH_AVX
+using quat_batch_float = simd::float8;
+#else
+using quat_batch_float = simd::float4;
+#endif
+
+/// sin(t * theta) / sin(theta) for x = cos(theta) in [0, 1], after Eberly, "A Fast and Accurate Algorithm for Computing SLERP":
+/// the series t * sum(c_i * (x - 1)^i) with c_i = c_(i-1) * (t^2 - i^2) / (i * (2i + 1)), cut after 12 terms and evaluated in
+/// Horner form. Scaling the last term by mu (fitted numerically) compensates most of the cut off rest,
+/// leaving an error below 7.2e-7 for theta up to 90 degrees, i.e. quaternions up to 180 degrees apart.
+template<class F> inline
+F slerp_weight(F const& t, F const& x_minus_1) noexcept {
+	constexpr int   terms = 12;
+	constexpr float mu    = 1.89372327f;
+
+	F const t2 = t * t;
+	F result = F(1.f);
+	for(int i = terms; i >= 1; i--) {
+		float const scale = i == terms ? mu : 1.f;
+		float const u = scale / (i * (2 * i + 1));
+		float const v = scale * i / (2 * i + 1);
+		result = simd::madd(simd::madd(F(u), t2, F(-v)) * x_minus_1, result, F(1.f));
+	}
+	return t * result;
+}
+
+/// Shared loop of the quaternion interpolations: loads a, b (flipped onto a's hemisphere) and t lane wise,
+/// calls kernel(aw, ax, ay, az, bw, bx, by, bz, dot, t, ...outputs) and pads the tail so it runs the same kernel.
+/// A t_stride of 0 uses t[0] for every element.
+template<class F, class Kernel> inline
+void interpolate_quats(quat const* a, quat const* b, float const* t, size_t t_stride, quat* out, size_t n, Kernel&& kernel) noexcept {
+	constexpr size_t width = simd::lanes<F>::value;
+
+	auto step = [&](quat const* pa, quat const* pb, F const& pt, quat* po) {
+		F aw, ax, ay, az, bw, bx, by, bz;
+		load_quats(pa, aw, ax, ay, az);
+		load_quats(pb, bw, bx, by, bz);
+
+		// Take the shorter path by flipping b where the dot product is negative, without branches
+		F const d    = simd::madd(az, bz, simd::madd(ay, by, simd::madd(ax, bx, aw * bw)));
+		F const sign = d & F(-0.f);
+		bw = bw ^ sign; bx = bx ^ sign; by = by ^ sign; bz = bz ^ sign;
+
+		F rw, rx, ry, rz;
+		kernel(aw, ax, ay, az, bw, bx, by, bz, d ^ sign, pt, rw, rx, ry, rz);
+		store_quats(po, rw, rx, ry, rz);
+	};
+
+	size_t i = 0;
+	for(; i + width <= n; i += width) {
+		step(a + i, b + i, t_stride ? F::load(t + i) : F(t[0]), out + i);
+	}
+
+	if(i < n) {
+		quat  ta[width], tb[width], to[width];
+		float tt[width];
+		for(size_t k = 0; k < width; k++) {
+			bool const valid = i + k < n;
+			ta[k] = valid ? a[i + k] : quat();
+			tb[k] = valid ? b[i + k] : quat();
+			tt[k] = valid ? t[t_stride * (i + k)] : 0.f;
+		}
+		step(ta, tb, F::load(tt), to);
+		for(size_t k = 0; i + k < n; k++) out[i + k] = to[k];
+	}
+}
+
+template<class F> inline
+void nlerp_kernel(F const& aw, F const& ax, F const& ay, F const& az, F const& bw, F const& bx, F const& by, F const& bz, F const&, F const& t, F& rw, F& rx, F& ry, F& rz) noexcept {
+	F const s = F(1.f) - t;
+	rw = simd::madd(bw, t, aw * s);
+	rx = simd::madd(bx, t, ax * s);
+	ry = simd::madd(by, t, ay * s);
+	rz = simd::madd(bz, t, az * s);
+	F const inv_length = F(1.f) / simd::sqrt(simd::madd(rz, rz, simd::madd(ry, ry, simd::madd(rx, rx, rw * rw))));
+	rw = rw * inv_length;
+	rx = rx * inv_length;
+	ry = ry * inv_length;
+	rz = rz * inv_length;
+}
+
+template<class F> inline
+void slerp_kernel(F const& aw, F const& ax, F const& ay, F const& az, F const& bw, F const& bx, F const& by, F const& bz, F const& d, F const& t, F& rw, F& rx, F& ry, F& rz) noexcept {
+	F const x_minus_1 = simd::min(d, F(1.f)) - F(1.f);
+	F const wa = slerp_weight(F(1.f) - t, x_minus_1);
+	F const wb = slerp_weight(t, x_minus_1);
+	rw = simd::madd(bw, wb, aw * wa);
+	rx = simd::madd(bx, wb, ax * wa);
+	ry = simd::madd(by, wb, ay * wa);
+	rz = simd::madd(bz, wb, az * wa);
+}
+
+/// slerp_kernel() one quaternion at a time, for the plain build where the emulated lanes only add overhead
+inline
+void slerp_quats(quat const* a, quat const* b, float const* t, size_t t_stride, quat* out, size_t n) noexcept {
+	for(size_t i = 0; i < n; i++) {
+		quat const qa = a[i];
+		quat qb = b[i];
+		float d = qa.dot(qb);
+		if(d < 0) {
+			qb = -qb;
+			d  = -d;
+		}
+		float const k = t[t_stride * i];
+		float const x_minus_1 = (d < 1.f ? d : 1.f) - 1.f;
+		out[i] = qa * slerp_weight(1.f - k, x_minus_1) + qb * slerp_weight(k, x_minus_1);
+	}
+}
+
+/// v + w * t + q.xyz x t with t = 2 * q.xyz x v, see quat::operator*(vec3)
+template<class F> inline
+vec3_packet<F> rotate_kernel(F const& qw, F const& qx, F const& qy, F const& qz, vec3_packet<F> const& v) noexcept {
+	vec3_packet<F> const u(qx, qy, qz);
+	vec3_packet<F> const t = u.cross(v) * F(2.f);
+	return v + t * qw + u.cross(t);
+}
+
+/// (row 0, row 1, row 2) * v, the rows as broadcasts of the matrix elements
+template<class F> inline
+vec3_packet<F> mul_rows(mat3 const& m, vec3_packet<F> const& v) noexcept {
+	// m[column][row]
+	return vec3_packet<F>(
+		simd::madd(F(m[2][0]), v.z, simd::madd(F(m[1][0]), v.y, F(m[0][0]) * v.x)),
+		simd::madd(F(m[2][1]), v.z, simd::madd(F(m[1][1]), v.y, F(m[0][1]) * v.x)),
+		simd::madd(F(m[2][2]), v.z, simd::madd(F(m[1][2]), v.y, F(m[0][2]) * v.x))
+	);
+}
+
+/// rotation_to_quat() (mat3.hpp) on packets of columns, the candidate index becomes selects
+template<class F> inline
+void rotation_to_quat(vec3_packet<F> const& c0, vec3_packet<F> const& c1, vec3_packet<F> const& c2, F& w, F& x, F& y, F& z) noexcept {
+	using simd::select;
+
+	F const one(1.f);
+	F const t0 = one + c0.x + c1.y + c2.z;
+	F const t1 = one + c0.x - c1.y - c2.z;
+	F const t2 = one - c0.x + c1.y - c2.z;
+	F const t3 = one - c0.x - c1.y + c2.z;
+
+	F const dx  = c1.z - c2.y, dy  = c2.x - c0.z, dz  = c0.y - c1.x;
+	F const sxy = c0.y + c1.x, sxz = c2.x + c0.z, syz = c1.z + c2.y;
+
+	F const is_w = (t0 >= t1) & (t0 >= t2) & (t0 >= t3);
+	F const is_x = simd::andnot((t1 >= t2) & (t1 >= t3), is_w);
+	F const is_y = simd::andnot(t2 >= t3, is_w | is_x);
+
+	F const t  = select(is_w, t0, select(is_x, t1,  select(is_y, t2,  t3)));
+	F const qw = select(is_w, t0, select(is_x, dx,  select(is_y, dy,  dz)));
+	F const qx = select(is_w, dx, select(is_x, t1,  select(is_y, sxy, sxz)));
+	F const qy = select(is_w, dy, select(is_x, sxy, select(is_y, t2,  syz)));
+	F const qz = select(is_w, dz, select(is_x, sxz, select(is_y, syz, t3)));
+
+	F const scale = simd::xorsign(F(.5f) / simd::sqrt(t), qw);
+	w = qw * scale;
+	x = qx * scale;
+	y = qy * scale;
+	z = qz * scale;
+}
+
+/// Column k of 4 matrices, one component per register. Column k starts at data + stride * k (stride 3 for mat3, 4 for mat4).
+template<size_t stride, size_t k, class M> inline
+vec3x4 load_column(M const* m) noexcept {
+	using simd::float4;
+
+	// The last mat3 column is loaded one float early, so it doesn't read past the matrix
+	constexpr size_t offset = stride == 3 && k == 2 ? 5 : stride * k;
+	float4 x = float4::load(m[0].data + offset);
+	float4 y = float4::load(m[1].data + offset);
+	float4 z = float4::load(m[2].data + offset);
+	float4 w = float4::load(m[3].data + offset);
+	if(offset == 5) {
+		x = simd::shuffle<1, 2, 3, 3>(x);
+		y = simd::shuffle<1, 2, 3, 3>(y);
+		z = simd::shuffle<1, 2, 3, 3>(z);
+		w = simd::shuffle<1, 2, 3, 3>(w);
+	}
+	simd::transpose(x, y, z, w);
+	return vec3x4(x, y, z);
+}
+template<size_t stride, class M> inline
+void load_rotations(M const* m, vec3x4& c0, vec3x4& c1, vec3x4& c2) noexcept {
+	c0 = load_column<stride, 0>(m);
+	c1 = load_column<stride, 1>(m);
+	c2 = load_column<stride, 2>(m);
+}
+template<size_t stride, class M> inline
+void load_rotations(M const* m, vec3x8& c0, vec3x8& c1, vec3x8& c2) noexcept {
+	vec3x4 lo[3], hi[3];
+	load_rotations<stride>(m,     lo[0], lo[1], lo[2]);
+	load_rotations<stride>(m + 4, hi[0], hi[1], hi[2]);
+	vec3x8* c[3] = { &c0, &c1, &c2 };
+	for(unsigned k = 0; k < 3; k++) {
+		*c[k] = vec3x8(simd::float8(lo[k].x, hi[k].x), simd::float8(lo[k].y, hi[k].y), simd::float8(lo[k].z, hi[k].z));
+	}
+}
+
+/// Converts the rotation parts of matrices with columns stride floats apart (3 for mat3, 4 for mat4), one packet at a time
+template<class F, size_t stride, class M> inline
+void matrices_to_quats(M const* m, quat* out, size_t n) noexcept {
+	constexpr size_t width = simd::lanes<F>::value;
+
+	auto step = [](M const* pm, quat* pout) {
+		vec3_packet<F> c0, c1, c2;
+		load_rotations<stride>(pm, c0, c1, c2);
+
+		F w, x, y, z;
+		rotation_to_quat(c0, c1, c2, w, x, y, z);
+		store_quats(pout, w, x, y, z);
+	};
+
+	size_t i = 0;
+	for(; i + width <= n; i += width) step(m + i, out + i);
+
+	if(i < n) {
+		// Pads with identities
+		M tm[width];
+		quat tout[width];
+		std::copy(m + i, m + n, tm);
+		step(tm, tout);
+		std::copy(tout, tout + (n - i), out + i);
+	}
+}
+
+} // namespace detail
+
+/// Normalized linear interpolation out[i] = normalize(a[i] * (1 - t[i]) + b[i] * t[i]) along the shorter path, like quat::lerp(). @ingroup stxmath
+/// Interpolates 4 (8 with AVX) quaternions at a time. out may be the same array as a or b.
+/// Faster than slerp_batch, but the angular velocity isn't constant across t.
+/// Without STX_MATH_SIMD it is a plain loop over quat::lerp().
+inline
+void nlerp_batch(quat const* a, quat const* b, float const* t, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	using F = detail::quat_batch_float;
+	detail::interpolate_quats<F>(a, b, t, 1, out, n, detail::nlerp_kernel<F>);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = a[i].lerp(b[i], t[i]);
+#endif
+}
+
+/// nlerp_batch() with the same t for all quaternions @ingroup stxmath
+inline
+void nlerp_batch(quat const* a, quat const* b, float t, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	using F = detail::quat_batch_float;
+	detail::interpolate_quats<F>(a, b, &t, 0, out, n, detail::nlerp_kernel<F>);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = a[i].lerp(b[i], t);
+#endif
+}
+
+/// Spherical linear interpolation along the shorter path, like quat::slerp() but without acos, sin or cos. @ingroup stxmath
+/// Uses a polynomial approximation of sin(t * theta) / sin(theta) after Eberly, which for unit quaternions stays within
+/// 2e-6 of the exact slerp per component (7.2e-7 approximation error plus float rounding), with no special case for tiny angles.
+/// Interpolates 4 (8 with AVX) quaternions at a time, one at a time without STX_MATH_SIMD. out may be the same array as a or b.
+inline
+void slerp_batch(quat const* a, quat const* b, float const* t, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	using F = detail::quat_batch_float;
+	detail::interpolate_quats<F>(a, b, t, 1, out, n, detail::slerp_kernel<F>);
+#else
+	detail::slerp_quats(a, b, t, 1, out, n);
+#endif
+}
+
+/// slerp_batch() with the same t for all quaternions @ingroup stxmath
+inline
+void slerp_batch(quat const* a, quat const* b, float t, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	using F = detail::quat_batch_float;
+	detail::interpolate_quats<F>(a, b, &t, 0, out, n, detail::slerp_kernel<F>);
+#else
+	detail::slerp_quats(a, b, &t, 0, out, n);
+#endif
+}
+
+/// Rotates n vectors by one unit quaternion, same as out[i] = q * in[i]. @ingroup stxmath
+/// Converts q to a matrix once, which then takes 9 multiply-adds per vector instead of 15 plus the cross products.
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void rotate_batch(quat const& q, vec3 const* in, vec3* out, size_t n) noexcept {
+	transform_vectors(mat4(q.to_mat3()), in, out, n);
+}
+
+/// rotate_batch() on SoA arrays, 4 (8 with AVX) vectors at a time. out is resized to in.size() and may be in. @ingroup stxmath
+inline
+void rotate_batch(quat const& q, vec3_soa const& in, vec3_soa& out) {
+	using F = detail::quat_batch_float;
+	using packet = vec3_packet<F>;
+
+	mat3 const m = q.to_mat3();
+	size_t const n = in.size();
+	out.resize(n);
+
+	size_t i = 0;
+	for(; i + packet::width <= n; i += packet::width) out.store(i, detail::mul_rows(m, in.packet<packet>(i)));
+	for(; i < n; i++) out.set(i, m * in[i]);
+}
+
+/// Rotates each vector by its own unit quaternion, same as out[i] = q[i] * in[i], 4 (8 with AVX) at a time. @ingroup stxmath
+/// in and out may be the same array, but must not overlap otherwise.
+inline
+void rotate_batch(quat const* q, vec3 const* in, vec3* out, size_t n) noexcept {
+	using F = detail::quat_batch_float;
+	using packet = vec3_packet<F>;
+	constexpr size_t width = packet::width;
+
+	auto step = [](quat const* pq, vec3 const* pin, vec3* pout) {
+		F w, x, y, z;
+		detail::load_quats(pq, w, x, y, z);
+		detail::rotate_kernel(w, x, y, z, packet::load(pin)).store(pout);
+	};
+
+	size_t i = 0;
+	for(; i + width <= n; i += width) step(q + i, in + i, out + i);
+
+	if(i < n) {
+		quat tq[width];
+		vec3 tin[width], tout[width];
+		std::copy(q + i, q + n, tq);
+		std::copy(in + i, in + n, tin);
+		step(tq, tin, tout);
+		std::copy(tout, tout + (n - i), out + i);
+	}
+}
+
+/// rotate_batch() with per element quaternions on SoA vectors. out is resized to in.size() and may be in. @ingroup stxmath
+inline
+void rotate_batch(quat const* q, vec3_soa const& in, vec3_soa& out) {
+	using F = detail::quat_batch_float;
+	using packet = vec3_packet<F>;
+
+	size_t const n = in.size();
+	out.resize(n);
+
+	size_t i = 0;
+	for(; i + packet::width <= n; i += packet::width) {
+		F w, x, y, z;
+		detail::load_quats(q + i, w, x, y, z);
+		out.store(i, detail::rotate_kernel(w, x, y, z, in.packet<packet>(i)));
+	}
+	for(; i < n; i++) out.set(i, q[i] * in[i]);
+}
+
+/// Converts n rotation matrices to quaternions, same as out[i] = quat(in[i]), 4 (8 with AVX) at a time. @ingroup stxmath
+/// Uses Shepperd's method with selects instead of branches, so it is accurate near 180 degrees as well.
+/// The matrices have to be rotations (orthonormal with determinant 1), see decompose_batch() in trs.hpp for scaled ones.
+/// Without STX_MATH_SIMD it is a plain loop over quat(mat3), which beats the emulated lanes.
+inline
+void to_quat_batch(mat3 const* in, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::matrices_to_quats<detail::quat_batch_float, 3>(in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = quat(in[i]);
+#endif
+}
+
+/// to_quat_batch() on the upper 3x3 part of mat4s, the translation is ignored @ingroup stxmath
+inline
+void to_quat_batch(mat4 const* in, quat* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::matrices_to_quats<detail::quat_batch_float, 4>(in, out, n);
+#else
+	for(size_t i = 0; i < n; i++) {
+		mat4 const& m = in[i];
+		out[i] = detail::rotation_to_quat(vec3(m[0].x, m[0].y, m[0].z), vec3(m[1].x, m[1].y, m[1].z), vec3(m[2].x, m[2].y, m[2].z));
+	}
+#endif
+}
+
+} // namespace stx
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "math.hpp"
+#include "vec3.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace stx {
+
+/// A half line starting at origin. Keeps the reciprocal direction for slab tests. @ingroup stxmath
+struct ray3 {
+	vec3 origin;
+	vec3 direction;
+	vec3 inv_direction;
+
+	ray3() :
+		ray3(vec3(), vec3::forward())
+	{}
+
+	ray3(vec3 const& origin, vec3 const& direction) :
+		origin(origin), direction(direction), inv_direction(1.f / direction)
+	{}
+
+	constexpr
+	vec3 at(float t) const noexcept { return origin + direction * t; }
+};
+
+/// A axis aligned box defined by minimum and maximum @ingroup stxmath
+struct box3 {
+	vec3 min;
+	vec3 max;
+
+	constexpr
+	box3() : box3(vec3(), vec3()) {}
+
+	constexpr
+	box3(vec3 const& mn, vec3 const& mx) : min(mn), max(mx) {}
+
+	/// A box with min > max, which any expand() or unite() replaces. Contains and intersects nothing.
+	static box3 inverted() noexcept {
+		float const inf = std::numeric_limits<float>::infinity();
+		return box3(vec3(inf), vec3(-inf));
+	}
+
+	constexpr static
+	box3 from_center(vec3 const& center, vec3 const& half_extent) noexcept {
+		return box3(center - half_extent, center + half_extent);
+	}
+
+	constexpr vec3 size()        const noexcept { return max - min; }
+	constexpr vec3 center()      const noexcept { return (min + max) * .5f; }
+	constexpr vec3 half_extent() const noexcept { return (max - min) * .5f; }
+
+	constexpr
+	float volume() const noexcept { return valid() ? size().x * size().y * size().z : 0; }
+
+	constexpr
+	float surface_area() const noexcept {
+		return valid() ? 2 * (size().x * size().y + size().y * size().z + size().z * size().x) : 0;
+	}
+
+	/// False for inverted boxes (min > max on any axis)
+	constexpr
+	bool valid() const noexcept { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+	constexpr
+	bool empty() const noexcept { return min.x == max.x && min.y == max.y && min.z == max.z; }
+
+	/// The smallest box containing both
+	constexpr
+	box3 unite(box3 const& other) const noexcept { return box3(min.min(other.min), max.max(other.max)); }
+
+	/// The overlap of both, inverted if they don't overlap
+	constexpr
+	box3 intersect(box3 const& other) const noexcept { return box3(min.max(other.min), max.min(other.max)); }
+
+	/// The smallest box containing this and p
+	constexpr
+	box3 expand(vec3 const& p) const noexcept { return box3(min.min(p), max.max(p)); }
+
+	/// Grows the box by margin on every side
+	constexpr
+	box3 expand(float margin) const noexcept { return box3(min - vec3(margin), max + vec3(margin)); }
+
+	constexpr
+	bool contains(vec3 const& p) const noexcept {
+		return
+			p.x >= min.x && p.x <= max.x &&
+			p.y >= min.y && p.y <= max.y &&
+			p.z >= min.z && p.z <= max.z;
+	}
+
+	constexpr
+	bool contains(box3 const& b) const noexcept { return contains(b.min) && contains(b.max); }
+
+	constexpr
+	bool intersects(box3 const& b) const noexcept {
+		return
+			b.min.x <= max.x && b.max.x >= min.x &&
+			b.min.y <= max.y && b.max.y >= min.y &&
+			b.min.z <= max.z && b.max.z >= min.z;
+	}
+
+	/// Slab test. Returns whether the ray hits the box within [t_min, t_max] and where it enters it in t_near.
+	/// Rays starting inside the box report t_near <= 0, rays running inside one of its faces hit it.
+	bool intersect(ray3 const& r, float t_min, float t_max, float& t_near) const noexcept {
+		vec3 const t0 = (min - r.origin) * r.inv_direction;
+		vec3 const t1 = (max - r.origin) * r.inv_direction;
+		vec3 const near = t0.min(t1);
+		vec3 const far  = t0.max(t1);
+		t_near = stx::max(stx::max(near.x, near.y), near.z);
+		float t_far = stx::min(stx::min(far.x, far.y), far.z);
+
+		// A ray parallel to an axis that starts on one of its planes gives 0 * inf = nan there: it runs inside that face,
+		// which doesn't constrain it. No ordering of min and max drops the nan for both signs, so look for one and redo
+		// the test without those axes. Rare, so the branch predicts well.
+		vec3 const sum = t0 + t1;
+		float const any_nan = sum.x + sum.y + sum.z;
+		if(any_nan != any_nan) {
+			t_near = -std::numeric_limits<float>::infinity();
+			t_far  =  std::numeric_limits<float>::infinity();
+			auto const slab = [&](float a, float b) {
+				if(a != a || b != b) return;
+				t_near = stx::max(stx::min(a, b), t_near);
+				t_far  = stx::min(stx::max(a, b), t_far);
+			};
+			slab(t0.x, t1.x);
+			slab(t0.y, t1.y);
+			slab(t0.z, t1.z);
+		}
+		return (t_near <= t_far) & (t_far >= t_min) & (t_near <= t_max);
+	}
+
+	bool intersect(ray3 const& r, float t_max = std::numeric_limits<float>::infinity()) const noexcept {
+		float t_near;
+		return intersect(r, 0, t_max, t_near);
+	}
+};
+
+/// 4 or 8 boxes with one SIMD lane per box, see box3x4 and box3x8 @ingroup stxmath
+template<typename F>
+struct box3_packet {
+	constexpr static unsigned width = simd::lanes<F>::value;
+
+	vec3_packet<F> min, max;
+
+	box3_packet() = default;
+
+	box3_packet(vec3_packet<F> const& mn, vec3_packet<F> const& mx) :
+		min(mn), max(mx)
+	{}
+
+	explicit
+	box3_packet(box3 const& b) :
+		min(b.min), max(b.max)
+	{}
+
+	/// Loads `width` consecutive boxes
+	static box3_packet load(box3 const* boxes) noexcept {
+		float tmp[6][width];
+		for(unsigned i = 0; i < width; i++) {
+			for(unsigned k = 0; k < 3; k++) {
+				tmp[k][i]     = boxes[i].min[k];
+				tmp[k + 3][i] = boxes[i].max[k];
+			}
+		}
+		return box3_packet(
+			vec3_packet<F>::load(tmp[0], tmp[1], tmp[2]),
+			vec3_packet<F>::load(tmp[3], tmp[4], tmp[5])
+		);
+	}
+
+	box3 lane(unsigned i) const noexcept { return box3(min.lane(i), max.lane(i)); }
+
+	/// Slab test of one ray against all boxes. Returns the lane mask of hits within [t_min, t_max], entry distances in t_near.
+	F intersect(ray3 const& r, F const& t_min, F const& t_max, F& t_near) const noexcept {
+		// The planes a ray enters and leaves through by its direction's sign instead of min and max per axis. That leaves
+		// nan (see box3::intersect) only where the ray starts on the plane it runs in, and only as the first operand of
+		// simd::max and simd::min, which return the second one for nan.
+		vec3_packet<F> const origin(r.origin);
+		vec3_packet<F> const inv(r.inv_direction);
+		F const zero(0.f);
+		vec3_packet<F> const flip(inv.x < zero, inv.y < zero, inv.z < zero);
+		F const xn = (simd::select(flip.x, max.x, min.x) - origin.x) * inv.x, xf = (simd::select(flip.x, min.x, max.x) - origin.x) * inv.x;
+		F const yn = (simd::select(flip.y, max.y, min.y) - origin.y) * inv.y, yf = (simd::select(flip.y, min.y, max.y) - origin.y) * inv.y;
+		F const zn = (simd::select(flip.z, max.z, min.z) - origin.z) * inv.z, zf = (simd::select(flip.z, min.z, max.z) - origin.z) * inv.z;
+		t_near = simd::max(simd::max(xn, yn), simd::max(zn, F(-std::numeric_limits<float>::infinity())));
+		F const t_far = simd::min(simd::min(xf, yf), simd::min(zf, F(std::numeric_limits<float>::infinity())));
+		return (t_near <= t_far) & (t_far >= t_min) & (t_near <= t_max);
+	}
+};
+
+/// 4 or 8 rays with one SIMD lane per ray, see ray3x4 and ray3x8 @ingroup stxmath
+template<typename F>
+struct ray3_packet {
+	constexpr static unsigned width = simd::lanes<F>::value;
+
+	vec3_packet<F> origin;
+	vec3_packet<F> inv_direction;
+
+	ray3_packet() = default;
+
+	ray3_packet(vec3_packet<F> const& origin, vec3_packet<F> const& direction) :
+		origin(origin), inv_direction(vec3_packet<F>(1.f) / direction)
+	{}
+
+	/// Loads `width` consecutive rays
+	static ray3_packet load(ray3 const* rays) noexcept {
+		float tmp[6][width];
+		for(unsigned i = 0; i < width; i++) {
+			for(unsigned k = 0; k < 3; k++) {
+				tmp[k][i]     = rays[i].origin[k];
+				tmp[k + 3][i] = rays[i].inv_direction[k];
+			}
+		}
+		ray3_packet result;
+		result.origin        = vec3_packet<F>::load(tmp[0], tmp[1], tmp[2]);
+		result.inv_direction = vec3_packet<F>::load(tmp[3], tmp[4], tmp[5]);
+		return result;
+	}
+
+	/// Slab test of all rays against one box. Returns the lane mask of hits within [t_min, t_max], entry distances in t_near.
+	F intersect(box3 const& b, F const& t_min, F const& t_max, F& t_near) const noexcept {
+		// Planes picked by the sign per lane, see box3_packet::intersect
+		F const zero(0.f);
+		vec3_packet<F> const lo(b.min), hi(b.max);
+		vec3_packet<F> const flip(inv_direction.x < zero, inv_direction.y < zero, inv_direction.z < zero);
+		F const xn = (simd::select(flip.x, hi.x, lo.x) - origin.x) * inv_direction.x, xf = (simd::select(flip.x, lo.x, hi.x) - origin.x) * inv_direction.x;
+		F const yn = (simd::select(flip.y, hi.y, lo.y) - origin.y) * inv_direction.y, yf = (simd::select(flip.y, lo.y, hi.y) - origin.y) * inv_direction.y;
+		F const zn = (simd::select(flip.z, hi.z, lo.z) - origin.z) * inv_direction.z, zf = (simd::select(flip.z, lo.z, hi.z) - origin.z) * inv_direction.z;
+		t_near = simd::max(simd::max(xn, yn), simd::max(zn, F(-std::numeric_limits<float>::infinity())));
+		F const t_far = simd::min(simd::min(xf, yf), simd::min(zf, F(std::numeric_limits<float>::infinity())));
+		return (t_near <= t_far) & (t_far >= t_min) & (t_near <= t_max);
+	}
+};
+
+using box3x4 = box3_packet<simd::float4>;
+using box3x8 = box3_packet<simd::float8>;
+using ray3x4 = ray3_packet<simd::float4>;
+using ray3x8 = ray3_packet<simd::float8>;
+
+} // namespace stx
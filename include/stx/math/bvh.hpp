@@ -0,0 +1,495 @@
+#pragma once
+
+#include "box3.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace stx {
+
+namespace detail {
+
+/// Minimal allocator handing out Align byte aligned memory, std::vector doesn't respect alignas before C++17
+template<class T, size_t Align>
+struct aligned_allocator {
+	using value_type = T;
+
+	template<class U>
+	struct rebind { using other = aligned_allocator<U, Align>; };
+
+	aligned_allocator() = default;
+
+	template<class U>
+	aligned_allocator(aligned_allocator<U, Align> const&) noexcept {}
+
+	T* allocate(size_t n) {
+		// Over allocate and remember the original pointer right in front of the aligned block
+		char* raw = static_cast<char*>(::operator new(n * sizeof(T) + Align + sizeof(void*)));
+		uintptr_t const aligned = (reinterpret_cast<uintptr_t>(raw + sizeof(void*)) + Align - 1) & ~uintptr_t(Align - 1);
+		reinterpret_cast<void**>(aligned)[-1] = raw;
+		return reinterpret_cast<T*>(aligned);
+	}
+
+	void deallocate(T* p, size_t) noexcept {
+		::operator delete(reinterpret_cast<void**>(p)[-1]);
+	}
+
+	template<class U> bool operator==(aligned_allocator<U, Align> const&) const noexcept { return true; }
+	template<class U> bool operator!=(aligned_allocator<U, Align> const&) const noexcept { return false; }
+};
+
+/// Binary node used while building, collapsed into the 4 wide layout afterwards
+struct bvh_build_node {
+	box3 bounds;
+	std::unique_ptr<bvh_build_node> child[2];
+	uint32_t first = 0, count = 0;
+
+	bool leaf() const noexcept { return !child[0]; }
+};
+
+} // namespace detail
+
+/// Options for bvh::build() @ingroup stxmath
+struct bvh_build_options {
+	/// Leaves hold at most this many primitives (at most 65535)
+	unsigned max_leaf_size = 4;
+	/// Threads the build may use, 0 means thread_count()
+	unsigned threads = 0;
+};
+
+/// Result of bvh::closest_hit() @ingroup stxmath
+struct bvh_hit {
+	uint32_t primitive;
+	float    t;
+
+	explicit operator bool() const noexcept { return primitive != UINT32_MAX; }
+};
+
+/// A bounding volume hierarchy over primitives given by their bounding boxes. @ingroup stxmath
+/// Built with a binned surface area heuristic, large subtrees are built on separate threads.
+/// The nodes are 4 wide with the child bounds stored as SoA, so one ray or box is tested against all four children at once,
+/// and stored depth first in 128 byte (two cache line) aligned blocks.
+/// The primitives themselves are only known through the callbacks passed to the queries.
+class bvh {
+public:
+	struct alignas(64) node {
+		float min_x[4], min_y[4], min_z[4];
+		float max_x[4], max_y[4], max_z[4];
+		/// Node index for inner children, first entry in the primitive order for leaves
+		uint32_t child[4];
+		/// Number of primitives for leaves, 0 for inner children
+		uint16_t count[4];
+		/// Number of used child slots, the rest is garbage
+		uint8_t  slots;
+
+		box3 bounds(unsigned i) const noexcept {
+			return box3(vec3(min_x[i], min_y[i], min_z[i]), vec3(max_x[i], max_y[i], max_z[i]));
+		}
+
+		void set_bounds(unsigned i, box3 const& b) noexcept {
+			min_x[i] = b.min.x; min_y[i] = b.min.y; min_z[i] = b.min.z;
+			max_x[i] = b.max.x; max_y[i] = b.max.y; max_z[i] = b.max.z;
+		}
+
+		box3 bounds() const noexcept {
+			box3 result = box3::inverted();
+			for(unsigned i = 0; i < slots; i++) result = result.unite(bounds(i));
+			return result;
+		}
+	};
+	static_assert(sizeof(node) == 128, "bvh::node should fill exactly two cache lines");
+
+	bvh() = default;
+
+	explicit
+	bvh(box3 const* bounds, size_t n, bvh_build_options const& options = bvh_build_options()) {
+		build(bounds, n, options);
+	}
+
+	/// (Re)builds the tree over n primitives with the given bounds, primitive i is reported to the query callbacks as i.
+	void build(box3 const* bounds, size_t n, bvh_build_options const& options = bvh_build_options()) {
+		m_nodes.clear();
+		m_order.resize(n);
+		for(size_t i = 0; i < n; i++) m_order[i] = (uint32_t) i;
+		if(n == 0) return;
+
+		builder b;
+		b.bounds   = bounds;
+		b.order    = m_order.data();
+		b.max_leaf = std::max(1u, std::min(options.max_leaf_size, 65535u));
+		b.centroids.resize(n);
+		for(size_t i = 0; i < n; i++) b.centroids[i] = bounds[i].center();
+
+		std::unique_ptr<detail::bvh_build_node> root = b.build(0, (uint32_t) n, 0, options.threads ? options.threads : thread_count());
+
+		// The SAH stops splitting early, so the node count can't be estimated well from n and max_leaf
+		m_nodes.reserve(root->leaf() ? 1 : count_nodes(*root));
+		if(root->leaf()) {
+			m_nodes.emplace_back();
+			m_nodes[0].slots = 1;
+			m_nodes[0].set_bounds(0, root->bounds);
+			m_nodes[0].child[0] = root->first;
+			m_nodes[0].count[0] = (uint16_t) root->count;
+		}
+		else {
+			flatten(*root);
+		}
+	}
+
+	/// Updates the bounds after the primitives moved, keeping the tree structure.
+	/// Much cheaper than build(), but the tree degrades when primitives move a lot relative to each other.
+	/// bounds must hold the same primitives as on build().
+	void refit(box3 const* bounds) noexcept {
+		// Depth first order puts children after their parents, so going backwards sees children first
+		for(size_t i = m_nodes.size(); i-- > 0;) {
+			node& n = m_nodes[i];
+			for(unsigned k = 0; k < n.slots; k++) {
+				box3 b = box3::inverted();
+				if(n.count[k]) {
+					for(uint32_t j = n.child[k]; j < n.child[k] + n.count[k]; j++) b = b.unite(bounds[m_order[j]]);
+				}
+				else {
+					b = m_nodes[n.child[k]].bounds();
+				}
+				n.set_bounds(k, b);
+			}
+		}
+	}
+
+	/// Finds the nearest primitive hit by r within [0, t_max].
+	/// intersect(primitive, r, t_max) returns the distance to the primitive or anything >= t_max if it misses.
+	template<class Intersect>
+	bvh_hit closest_hit(ray3 const& r, Intersect&& intersect, float t_max = std::numeric_limits<float>::infinity()) const {
+		bvh_hit result = { UINT32_MAX, t_max };
+		if(m_nodes.empty()) return result;
+
+		ray_lanes const ray(r);
+
+		stack_entry stack[stack_size];
+		unsigned    top = 0;
+		stack[top++] = { 0, 0, 0 };
+
+		while(top) {
+			stack_entry const e = stack[--top];
+			if(e.t > result.t) continue;
+
+			if(e.count) {
+				for(uint32_t j = e.child; j < e.child + e.count; j++) {
+					float const t = intersect(m_order[j], r, result.t);
+					if(t < result.t) {
+						result.t = t;
+						result.primitive = m_order[j];
+					}
+				}
+				continue;
+			}
+
+			node const& n = m_nodes[e.child];
+			simd::float4 t_near;
+			int mask = ray.slabs(n, result.t, t_near);
+
+			// Push far to near so the nearest child is visited first
+			stack_entry hits[4];
+			unsigned    num_hits = 0;
+			for(unsigned k = 0; k < 4; k++) {
+				if(!(mask & (1 << k))) continue;
+				stack_entry const h = { n.child[k], n.count[k], t_near[k] };
+				unsigned i = num_hits++;
+				for(; i > 0 && hits[i - 1].t < h.t; i--) hits[i] = hits[i - 1];
+				hits[i] = h;
+			}
+			for(unsigned k = 0; k < num_hits; k++) stack[top++] = hits[k];
+		}
+
+		return result;
+	}
+
+	/// Returns whether any primitive is hit by r within [0, t_max], stops at the first one found.
+	/// intersect(primitive, r, t_max) returns whether the primitive is hit.
+	template<class Intersect>
+	bool any_hit(ray3 const& r, Intersect&& intersect, float t_max = std::numeric_limits<float>::infinity()) const {
+		if(m_nodes.empty()) return false;
+
+		ray_lanes const ray(r);
+
+		uint32_t stack[stack_size];
+		unsigned top = 0;
+		stack[top++] = 0;
+
+		while(top) {
+			node const& n = m_nodes[stack[--top]];
+			simd::float4 t_near;
+			int const mask = ray.slabs(n, t_max, t_near);
+			for(unsigned k = 0; k < 4; k++) {
+				if(!(mask & (1 << k))) continue;
+				if(!n.count[k]) {
+					stack[top++] = n.child[k];
+					continue;
+				}
+				for(uint32_t j = n.child[k]; j < n.child[k] + n.count[k]; j++) {
+					if(intersect(m_order[j], r, t_max)) return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/// Calls callback(primitive) for every primitive in a leaf overlapping b, i.e. every primitive that may overlap b.
+	/// The tree doesn't keep per primitive bounds, so the callback does the exact test.
+	template<class Callback>
+	void overlap(box3 const& b, Callback&& callback) const {
+		using simd::float4;
+
+		if(m_nodes.empty()) return;
+
+		float4 const bmin_x(b.min.x), bmin_y(b.min.y), bmin_z(b.min.z);
+		float4 const bmax_x(b.max.x), bmax_y(b.max.y), bmax_z(b.max.z);
+
+		uint32_t stack[stack_size];
+		unsigned top = 0;
+		stack[top++] = 0;
+
+		while(top) {
+			node const& n = m_nodes[stack[--top]];
+			float4 const overlaps =
+				(float4::load_aligned(n.min_x) <= bmax_x) & (float4::load_aligned(n.max_x) >= bmin_x) &
+				(float4::load_aligned(n.min_y) <= bmax_y) & (float4::load_aligned(n.max_y) >= bmin_y) &
+				(float4::load_aligned(n.min_z) <= bmax_z) & (float4::load_aligned(n.max_z) >= bmin_z);
+			int const mask = simd::movemask(overlaps) & ((1 << n.slots) - 1);
+			for(unsigned k = 0; k < 4; k++) {
+				if(!(mask & (1 << k))) continue;
+				if(!n.count[k]) {
+					stack[top++] = n.child[k];
+					continue;
+				}
+				for(uint32_t j = n.child[k]; j < n.child[k] + n.count[k]; j++) callback(m_order[j]);
+			}
+		}
+	}
+
+	bool   empty()      const noexcept { return m_nodes.empty(); }
+	size_t size()       const noexcept { return m_order.size(); }
+	size_t node_count() const noexcept { return m_nodes.size(); }
+	node const* nodes() const noexcept { return m_nodes.data(); }
+
+	/// Bounds of all primitives
+	box3 bounds() const noexcept { return m_nodes.empty() ? box3::inverted() : m_nodes[0].bounds(); }
+
+private:
+	/// Subtrees with fewer primitives are built on the thread that reached them
+	constexpr static uint32_t parallel_threshold = 4096;
+	/// Below this depth the builder falls back to median splits, which bounds the tree depth (and traversal stack) to sah_depth + 32
+	constexpr static unsigned sah_depth  = 48;
+	constexpr static unsigned stack_size = 3 * (sah_depth + 32) + 1;
+	constexpr static unsigned bins       = 16;
+
+	std::vector<node, detail::aligned_allocator<node, 64>> m_nodes;
+	/// Primitive indices in leaf order, leaves reference ranges of it
+	std::vector<uint32_t> m_order;
+
+	struct stack_entry {
+		uint32_t child;
+		uint32_t count;
+		float    t;
+	};
+
+	/// The ray splatted across lanes to test it against the 4 children of a node
+	struct ray_lanes {
+		simd::float4 ox, oy, oz, ix, iy, iz;
+		/// Whether the direction is negative, the ray then enters through the max planes
+		bool fx, fy, fz;
+
+		explicit
+		ray_lanes(ray3 const& r) noexcept :
+			ox(r.origin.x), oy(r.origin.y), oz(r.origin.z),
+			ix(r.inv_direction.x), iy(r.inv_direction.y), iz(r.inv_direction.z),
+			fx(r.inv_direction.x < 0), fy(r.inv_direction.y < 0), fz(r.inv_direction.z < 0)
+		{}
+
+		/// Slab test against all children, returns the bit mask of children hit within [0, t_max]
+		int slabs(node const& n, float t_max, simd::float4& t_near) const noexcept {
+			using simd::float4;
+			// Entry and exit planes by the direction's sign, see box3_packet::intersect
+			float4 const xn = (float4::load_aligned(fx ? n.max_x : n.min_x) - ox) * ix, xf = (float4::load_aligned(fx ? n.min_x : n.max_x) - ox) * ix;
+			float4 const yn = (float4::load_aligned(fy ? n.max_y : n.min_y) - oy) * iy, yf = (float4::load_aligned(fy ? n.min_y : n.max_y) - oy) * iy;
+			float4 const zn = (float4::load_aligned(fz ? n.max_z : n.min_z) - oz) * iz, zf = (float4::load_aligned(fz ? n.min_z : n.max_z) - oz) * iz;
+			t_near = simd::max(simd::max(xn, yn), simd::max(zn, float4::zero()));
+			float4 const t_far = simd::min(simd::min(xf, yf), simd::min(zf, float4(t_max)));
+			return simd::movemask(t_near <= t_far) & ((1 << n.slots) - 1);
+		}
+	};
+
+	struct builder {
+		box3 const*       bounds;
+		uint32_t*         order;
+		unsigned          max_leaf;
+		std::vector<vec3> centroids;
+
+		std::unique_ptr<detail::bvh_build_node> build(uint32_t first, uint32_t count, unsigned depth, unsigned threads) {
+			std::unique_ptr<detail::bvh_build_node> n(new detail::bvh_build_node);
+			n->first = first;
+			n->count = count;
+
+			box3 centroid_bounds = box3::inverted();
+			n->bounds = box3::inverted();
+			for(uint32_t i = first; i < first + count; i++) {
+				n->bounds       = n->bounds.unite(bounds[order[i]]);
+				centroid_bounds = centroid_bounds.expand(centroids[order[i]]);
+			}
+
+			if(count <= 1) return n;
+
+			vec3 const extent = centroid_bounds.size();
+			unsigned const axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+			uint32_t mid = 0;
+			if(depth < sah_depth && extent[axis] > 0) {
+				float const offset = centroid_bounds.min[axis];
+				float const scale  = bins * (1 - 1e-5f) / extent[axis];
+				auto const bin_of = [&](uint32_t prim) {
+					return std::min(bins - 1, (unsigned) ((centroids[prim][axis] - offset) * scale));
+				};
+
+				box3     bin_bounds[bins];
+				uint32_t bin_count[bins] = {};
+				for(box3& b : bin_bounds) b = box3::inverted();
+				for(uint32_t i = first; i < first + count; i++) {
+					unsigned const b = bin_of(order[i]);
+					bin_bounds[b] = bin_bounds[b].unite(bounds[order[i]]);
+					bin_count[b]++;
+				}
+
+				// Sweep from the right to get the cost of everything right of each split, then from the left to find the best split
+				float right_cost[bins];
+				box3 acc = box3::inverted();
+				uint32_t acc_count = 0;
+				for(unsigned b = bins - 1; b > 0; b--) {
+					acc = acc.unite(bin_bounds[b]);
+					acc_count += bin_count[b];
+					right_cost[b] = acc.surface_area() * acc_count;
+				}
+
+				float    best_cost  = std::numeric_limits<float>::infinity();
+				unsigned best_split = 0;
+				acc = box3::inverted();
+				acc_count = 0;
+				for(unsigned b = 0; b + 1 < bins; b++) {
+					acc = acc.unite(bin_bounds[b]);
+					acc_count += bin_count[b];
+					float const cost = acc.surface_area() * acc_count + right_cost[b + 1];
+					if(acc_count && acc_count < count && cost < best_cost) {
+						best_cost  = cost;
+						best_split = b;
+					}
+				}
+
+				// Cost relative to testing every primitive, with traversing a node costing as much as one primitive
+				float const area = n->bounds.surface_area();
+				float const split_cost = 1 + (area > 0 ? best_cost / area : count);
+				if(count <= max_leaf && split_cost >= count) return n;
+
+				if(best_cost < std::numeric_limits<float>::infinity()) {
+					mid = (uint32_t) (std::partition(order + first, order + first + count, [&](uint32_t prim) { return bin_of(prim) <= best_split; }) - order);
+				}
+			}
+			else if(count <= max_leaf) {
+				return n;
+			}
+
+			if(mid <= first || mid >= first + count) {
+				mid = first + count / 2;
+				std::nth_element(order + first, order + mid, order + first + count, [&](uint32_t a, uint32_t b) {
+					return centroids[a][axis] < centroids[b][axis];
+				});
+			}
+
+			if(threads > 1 && count >= parallel_threshold) {
+				unsigned const left_threads = threads / 2;
+				parallel_invoke(
+					[&]() { n->child[0] = build(first, mid - first, depth + 1, left_threads); },
+					[&]() { n->child[1] = build(mid, first + count - mid, depth + 1, threads - left_threads); }
+				);
+			}
+			else {
+				n->child[0] = build(first, mid - first, depth + 1, 1);
+				n->child[1] = build(mid, first + count - mid, depth + 1, 1);
+			}
+
+			return n;
+		}
+	};
+
+	/// The up to 4 children of the node n turns into, pulling up grandchildren from the inner child with the largest surface area
+	static unsigned collect_children(detail::bvh_build_node const& n, detail::bvh_build_node const* (&children)[4]) noexcept {
+		children[0] = n.child[0].get();
+		children[1] = n.child[1].get();
+		unsigned num_children = 2;
+		while(num_children < 4) {
+			// Open the inner child with the largest surface area
+			int   widest = -1;
+			float widest_area = -1;
+			for(unsigned i = 0; i < num_children; i++) {
+				if(!children[i]->leaf() && children[i]->bounds.surface_area() > widest_area) {
+					widest      = (int) i;
+					widest_area = children[i]->bounds.surface_area();
+				}
+			}
+			if(widest < 0) break;
+
+			detail::bvh_build_node const* opened = children[widest];
+			children[widest] = opened->child[0].get();
+			children[num_children++] = opened->child[1].get();
+		}
+		return num_children;
+	}
+
+	/// Number of nodes flatten(n) appends
+	static size_t count_nodes(detail::bvh_build_node const& n) noexcept {
+		detail::bvh_build_node const* children[4];
+		unsigned const num_children = collect_children(n, children);
+		size_t count = 1;
+		for(unsigned k = 0; k < num_children; k++) {
+			if(!children[k]->leaf()) count += count_nodes(*children[k]);
+		}
+		return count;
+	}
+
+	/// Appends n and its subtree in depth first order, pulling up grandchildren until the node has 4 children
+	uint32_t flatten(detail::bvh_build_node const& n) {
+		detail::bvh_build_node const* children[4];
+		unsigned const num_children = collect_children(n, children);
+
+		uint32_t const index = (uint32_t) m_nodes.size();
+		m_nodes.emplace_back();
+		m_nodes[index].slots = (uint8_t) num_children;
+		for(unsigned k = 0; k < num_children; k++) {
+			m_nodes[index].set_bounds(k, children[k]->bounds);
+			if(children[k]->leaf()) {
+				m_nodes[index].child[k] = children[k]->first;
+				m_nodes[index].count[k] = (uint16_t) children[k]->count;
+			}
+			else {
+				// No reference into m_nodes across this call, it may reallocate
+				uint32_t const child = flatten(*children[k]);
+				m_nodes[index].child[k] = child;
+				m_nodes[index].count[k] = 0;
+			}
+		}
+		for(unsigned k = num_children; k < 4; k++) {
+			m_nodes[index].set_bounds(k, box3());
+			m_nodes[index].child[k] = 0;
+			m_nodes[index].count[k] = 0;
+		}
+		return index;
+	}
+};
+
+} // namespace stx
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "mat4.hpp"
+#include "quat.hpp"
+#include "vec3.hpp"
+#include "frustum.hpp"
+#include "perspective.hpp"
+
+#include <cstdint>
+
+namespace stx {
+
+/// A perspective camera: position, orientation and the parameters of perspective(). @ingroup stxmath
+/// The matrices derived from them and the frustum are computed lazily on first use and cached until
+/// a setter changes their inputs, so render passes and picking can ask for them as often as they like.
+/// The camera looks along -z (vec3::forward()) of its orientation with y up, depth is mapped according to depth().
+/// The getters fill the caches, so concurrent reads from several threads need an update() first.
+class camera {
+public:
+	camera() = default;
+
+	camera(vec3 const& position, quat const& orientation, float fovy, float aspect, float z_near, float z_far, depth_mode depth = depth_mode::zero_to_one) :
+		m_position(position), m_orientation(orientation),
+		m_fovy(fovy), m_aspect(aspect), m_near(z_near), m_far(z_far), m_depth(depth)
+	{}
+
+	vec3 const& position()    const noexcept { return m_position; }
+	quat const& orientation() const noexcept { return m_orientation; }
+	/// Vertical field of view in radians
+	float fovy()   const noexcept { return m_fovy; }
+	/// Width divided by height
+	float aspect() const noexcept { return m_aspect; }
+	float z_near() const noexcept { return m_near; }
+	/// Ignored by the infinite depth modes
+	float z_far()  const noexcept { return m_far; }
+	depth_mode depth() const noexcept { return m_depth; }
+
+	void set_position(vec3 const& position) noexcept {
+		m_position = position;
+		m_dirty |= pose_dependent;
+	}
+
+	void set_orientation(quat const& orientation) noexcept {
+		m_orientation = orientation;
+		m_dirty |= pose_dependent;
+	}
+
+	void set_pose(vec3 const& position, quat const& orientation) noexcept {
+		m_position    = position;
+		m_orientation = orientation;
+		m_dirty |= pose_dependent;
+	}
+
+	/// Turns the camera towards target, see quat::look_at()
+	void look_at(vec3 const& target) noexcept {
+		set_orientation(quat::look_at(m_position, target));
+	}
+
+	void set_perspective(float fovy, float aspect, float z_near, float z_far) noexcept {
+		m_fovy   = fovy;
+		m_aspect = aspect;
+		m_near   = z_near;
+		m_far    = z_far;
+		m_dirty |= projection_dependent;
+	}
+
+	void set_fovy(float fovy) noexcept {
+		m_fovy = fovy;
+		m_dirty |= projection_dependent;
+	}
+
+	/// E.g. after the window was resized
+	void set_aspect(float aspect) noexcept {
+		m_aspect = aspect;
+		m_dirty |= projection_dependent;
+	}
+
+	void set_clip(float z_near, float z_far) noexcept {
+		m_near = z_near;
+		m_far  = z_far;
+		m_dirty |= projection_dependent;
+	}
+
+	void set_depth(depth_mode depth) noexcept {
+		m_depth = depth;
+		m_dirty |= projection_dependent;
+	}
+
+	/// World to view space, the inverse of the camera's pose
+	mat4 const& view() const noexcept {
+		if(m_dirty & dirty_view) {
+			m_view = inverse_view().inverse_rigid();
+			m_dirty &= ~dirty_view;
+		}
+		return m_view;
+	}
+
+	/// View to world space, i.e. the camera's pose
+	mat4 const& inverse_view() const noexcept {
+		if(m_dirty & dirty_inverse_view) {
+			m_inverse_view = mat4::transform(m_orientation, m_position);
+			m_dirty &= ~dirty_inverse_view;
+		}
+		return m_inverse_view;
+	}
+
+	/// perspective(fovy(), aspect(), 1, z_near(), z_far(), depth())
+	mat4 const& projection() const noexcept {
+		if(m_dirty & dirty_projection) {
+			m_projection = perspective(m_fovy, m_aspect, 1.f, m_near, m_far, m_depth);
+			m_dirty &= ~dirty_projection;
+		}
+		return m_projection;
+	}
+
+	/// The inverse of projection() in closed form instead of a general inverse, for all depth modes
+	mat4 const& inverse_projection() const noexcept {
+		if(m_dirty & dirty_inverse_projection) {
+			mat4 const& p = projection();
+			// p[column][row], see perspective()
+			float const inverse_offset = 1.f / p[3][2];
+			m_inverse_projection = mat4(
+				1.f / p[0][0],             0,              0,                          0,
+				            0, 1.f / p[1][1],              0,                          0,
+				            0,             0,              0,                       -1.f,
+				            0,             0, inverse_offset, p[2][2] * inverse_offset
+			);
+			m_dirty &= ~dirty_inverse_projection;
+		}
+		return m_inverse_projection;
+	}
+
+	/// projection() * view(), world to clip space
+	mat4 const& view_projection() const noexcept {
+		if(m_dirty & dirty_view_projection) {
+			m_view_projection = projection() * view();
+			m_dirty &= ~dirty_view_projection;
+		}
+		return m_view_projection;
+	}
+
+	/// inverse_view() * inverse_projection(), clip to world space, e.g. for picking
+	mat4 const& inverse_view_projection() const noexcept {
+		if(m_dirty & dirty_inverse_view_projection) {
+			m_inverse_view_projection = inverse_view() * inverse_projection();
+			m_dirty &= ~dirty_inverse_view_projection;
+		}
+		return m_inverse_view_projection;
+	}
+
+	/// The world space frustum of view_projection()
+	stx::frustum const& frustum() const noexcept {
+		if(m_dirty & dirty_frustum) {
+			m_frustum = stx::frustum(view_projection());
+			m_dirty &= ~dirty_frustum;
+		}
+		return m_frustum;
+	}
+
+	/// Whether any cached value is out of date
+	bool dirty() const noexcept { return m_dirty != 0; }
+
+	/// Computes everything that is out of date, after that the getters only read
+	void update() const noexcept {
+		view();
+		inverse_projection();
+		inverse_view_projection();
+		frustum();
+	}
+
+private:
+	enum : uint32_t {
+		dirty_view                    = 1 << 0,
+		dirty_inverse_view            = 1 << 1,
+		dirty_projection              = 1 << 2,
+		dirty_inverse_projection      = 1 << 3,
+		dirty_view_projection         = 1 << 4,
+		dirty_inverse_view_projection = 1 << 5,
+		dirty_frustum                 = 1 << 6,
+
+		combined_dirty       = dirty_view_projection | dirty_inverse_view_projection | dirty_frustum,
+		pose_dependent       = dirty_view | dirty_inverse_view | combined_dirty,
+		projection_dependent = dirty_projection | dirty_inverse_projection | combined_dirty,
+	};
+
+	vec3  m_position    = vec3(0);
+	quat  m_orientation = quat();
+	float m_fovy        = 1.f;
+	float m_aspect      = 1.f;
+	float m_near        = .1f;
+	float m_far         = 1000.f;
+	depth_mode m_depth  = depth_mode::zero_to_one;
+
+	mutable uint32_t     m_dirty = pose_dependent | projection_dependent;
+	mutable mat4         m_view;
+	mutable mat4         m_inverse_view;
+	mutable mat4         m_projection;
+	mutable mat4         m_inverse_projection;
+	mutable mat4         m_view_projection;
+	mutable mat4         m_inverse_view_projection;
+	mutable stx::frustum m_frustum;
+};
+
+} // namespace stx
@@ -0,0 +1,206 @@
+#pragma once
+
+/* Compile time math.
+ * constexpr_sqrt(), constexpr_sin() etc. below evaluate in double precision and round once to float,
+ * which matches a correctly rounded libm on all but a few halfway cases. They can build constant
+ * tables, e.g. `constexpr quat rotations[] = { quat::angle_axis(...), ... };`.
+ * Members like vec3::length(), vec3::normalize() or quat::angle_axis() go through detail::math_sqrt()
+ * and friends, which use these while constant evaluated and std:: (or the SIMD and STX_MATH_FAST code) at runtime.
+ * That needs __builtin_is_constant_evaluated (GCC 9, clang 9, MSVC 16.5), without it those members
+ * stay non-constexpr: STX_MATH_CONSTEXPR is empty and STX_MATH_HAS_CONSTEXPR_MATH undefined.
+ */
+
+#include "fast_math.hpp"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__has_builtin)
+#	if __has_builtin(__builtin_is_constant_evaluated)
+#		define STX_MATH_HAS_CONSTEXPR_MATH 1
+#	endif
+#endif
+#if !defined(STX_MATH_HAS_CONSTEXPR_MATH) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#	define STX_MATH_HAS_CONSTEXPR_MATH 1
+#endif
+
+#if defined(STX_MATH_HAS_CONSTEXPR_MATH)
+	/// True while the compiler evaluates a constant expression
+#	define STX_MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+	/// Functions that are constexpr when the compiler can tell compile time and runtime evaluation apart
+#	define STX_MATH_CONSTEXPR constexpr
+#else
+#	define STX_MATH_CONSTANT_EVALUATED() false
+#	define STX_MATH_CONSTEXPR
+#endif
+
+namespace stx {
+
+namespace detail {
+
+constexpr double cx_pi   = 3.14159265358979323846;
+constexpr double cx_pio2 = 1.57079632679489661923;
+
+constexpr inline double cx_nan() noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+constexpr inline bool   cx_isfinite(double x) noexcept { return x == x && x - x == 0; }
+
+/// Newton's method on x scaled to [0.25, 1), correct to the last bit of a double
+constexpr inline
+double cx_sqrt(double x) noexcept {
+	if(x != x || x < 0) return cx_nan();
+	if(x == 0 || !cx_isfinite(x)) return x;
+
+	double scale = 1;
+	while(x >= 1)   { x *= .25; scale *= 2; }
+	while(x < .25)  { x *= 4;   scale *= .5; }
+
+	double r = .5 + .5 * x; // within 12% of sqrt(x) on [0.25, 1)
+	for(unsigned i = 0; i < 6; i++) r = .5 * (r + x / r);
+	return r * scale;
+}
+
+/// x - k * pi/2 with pi/2 split in three parts (fdlibm's pio2_1, pio2_2, pio2_2t), exact while |k| < 2^20.
+/// nan for |k| >= 2^52, where k would overflow (long is 32 bit on Windows) and no bit of the reduction is left.
+constexpr inline
+double cx_reduce_pio2(double x, long long& k) noexcept {
+	double const q = x * (1 / cx_pio2);
+	if(!(q > -4503599627370496. && q < 4503599627370496.)) {
+		k = 0;
+		return cx_nan();
+	}
+	k = (long long) (q < 0 ? q - .5 : q + .5);
+	double const kd = (double) k;
+	return ((x - kd * 1.57079632673412561417e+00) - kd * 6.07710050630396597660e-11) - kd * 2.02226624879595063154e-21;
+}
+
+/// Taylor series, |r| <= pi/4
+constexpr inline
+double cx_sin_kernel(double r) noexcept {
+	double const r2 = r * r;
+	double term = r, sum = r;
+	for(unsigned n = 1; n < 12; n++) {
+		term *= -r2 / ((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return sum;
+}
+constexpr inline
+double cx_cos_kernel(double r) noexcept {
+	double const r2 = r * r;
+	double term = 1, sum = 1;
+	for(unsigned n = 1; n < 12; n++) {
+		term *= -r2 / ((2 * n - 1) * (2 * n));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr inline
+double cx_sin(double x) noexcept {
+	if(!cx_isfinite(x)) return cx_nan();
+	long long k = 0;
+	double const r = cx_reduce_pio2(x, k);
+	switch(k & 3) {
+		case 0:  return  cx_sin_kernel(r);
+		case 1:  return  cx_cos_kernel(r);
+		case 2:  return -cx_sin_kernel(r);
+		default: return -cx_cos_kernel(r);
+	}
+}
+
+constexpr inline
+double cx_cos(double x) noexcept {
+	if(!cx_isfinite(x)) return cx_nan();
+	long long k = 0;
+	double const r = cx_reduce_pio2(x, k);
+	switch(k & 3) {
+		case 0:  return  cx_cos_kernel(r);
+		case 1:  return -cx_sin_kernel(r);
+		case 2:  return -cx_cos_kernel(r);
+		default: return  cx_sin_kernel(r);
+	}
+}
+
+/// atan(t) = pi/6 + atan((t * sqrt(3) - 1) / (sqrt(3) + t)) brings t below tan(pi/12) for the series
+constexpr inline
+double cx_atan(double x) noexcept {
+	if(x != x) return x;
+	if(x < 0) return -cx_atan(-x);
+	if(x > 1) return cx_isfinite(x) ? cx_pio2 - cx_atan(1 / x) : cx_pio2;
+
+	double offset = 0;
+	if(x > 0.26794919243112270) {
+		double const sqrt3 = 1.73205080756887729;
+		x = (x * sqrt3 - 1) / (sqrt3 + x);
+		offset = cx_pi / 6;
+	}
+
+	double const x2 = x * x;
+	double power = x, sum = x;
+	for(unsigned n = 1; n < 16; n++) {
+		power *= -x2;
+		sum += power / (2 * n + 1);
+	}
+	return offset + sum;
+}
+
+/// Quadrants like std::atan2, except that signed zeros are treated as positive
+constexpr inline
+double cx_atan2(double y, double x) noexcept {
+	if(x != x || y != y) return cx_nan();
+	if(x > 0)  return cx_atan(y / x);
+	if(x < 0)  return y < 0 ? cx_atan(y / x) - cx_pi : cx_atan(y / x) + cx_pi;
+	if(y > 0)  return  cx_pio2;
+	if(y < 0)  return -cx_pio2;
+	return 0;
+}
+
+constexpr inline
+double cx_acos(double x) noexcept {
+	if(x != x || x < -1 || x > 1) return cx_nan();
+	return cx_atan2(cx_sqrt((1 - x) * (1 + x)), x);
+}
+
+} // namespace detail
+
+/// sqrt(x), usable in constant expressions. Correctly rounded. @ingroup stxmath
+constexpr inline float constexpr_sqrt(float x) noexcept { return (float) detail::cx_sqrt(x); }
+/// sin(x), usable in constant expressions. Within 1 ulp of the correctly rounded result for |x| < 1e6, nan above 7e15. @ingroup stxmath
+constexpr inline float constexpr_sin(float x) noexcept { return (float) detail::cx_sin(x); }
+/// cos(x), usable in constant expressions. Within 1 ulp of the correctly rounded result for |x| < 1e6, nan above 7e15. @ingroup stxmath
+constexpr inline float constexpr_cos(float x) noexcept { return (float) detail::cx_cos(x); }
+/// tan(x), usable in constant expressions. Within 1 ulp of the correctly rounded result for |x| < 1e6, nan above 7e15. @ingroup stxmath
+constexpr inline float constexpr_tan(float x) noexcept { return (float) (detail::cx_sin(x) / detail::cx_cos(x)); }
+/// atan(x), usable in constant expressions. Within 1 ulp of the correctly rounded result. @ingroup stxmath
+constexpr inline float constexpr_atan(float x) noexcept { return (float) detail::cx_atan(x); }
+/// atan2(y, x), usable in constant expressions. Within 1 ulp of the correctly rounded result, signed zeros count as positive. @ingroup stxmath
+constexpr inline float constexpr_atan2(float y, float x) noexcept { return (float) detail::cx_atan2(y, x); }
+/// acos(x), usable in constant expressions. Within 1 ulp of the correctly rounded result, nan outside [-1, 1]. @ingroup stxmath
+constexpr inline float constexpr_acos(float x) noexcept { return (float) detail::cx_acos(x); }
+
+namespace detail {
+
+// The constexpr versions while constant evaluated, at runtime std:: or with STX_MATH_FAST the fast_ versions
+
+STX_MATH_CONSTEXPR inline float  math_sqrt(float x)  noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_sqrt(x) : std::sqrt(x); }
+STX_MATH_CONSTEXPR inline double math_sqrt(double x) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? cx_sqrt(x) : std::sqrt(x); }
+STX_MATH_CONSTEXPR inline float  math_tan(float x)   noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_tan(x) : std::tan(x); }
+STX_MATH_CONSTEXPR inline float  math_atan(float x)  noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_atan(x) : std::atan(x); }
+
+#if defined(STX_MATH_FAST)
+STX_MATH_CONSTEXPR inline float math_atan2(float y, float x) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_atan2(y, x) : fast_atan2(y, x); }
+STX_MATH_CONSTEXPR inline float math_acos(float x)  noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_acos(x) : fast_acos(x); }
+#else
+STX_MATH_CONSTEXPR inline float math_atan2(float y, float x) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_atan2(y, x) : std::atan2(y, x); }
+STX_MATH_CONSTEXPR inline float math_acos(float x)  noexcept { return STX_MATH_CONSTANT_EVALUATED() ? constexpr_acos(x) : std::acos(x); }
+#endif
+
+// std:: with STX_MATH_FAST as well: GCC merges the two calls into sincosf, which is as fast as fast_sincos()
+STX_MATH_CONSTEXPR inline void  math_sincos(float x, float& s, float& c) noexcept {
+	s = STX_MATH_CONSTANT_EVALUATED() ? constexpr_sin(x) : std::sin(x);
+	c = STX_MATH_CONSTANT_EVALUATED() ? constexpr_cos(x) : std::cos(x);
+}
+
+} // namespace detail
+
+} // namespace stx
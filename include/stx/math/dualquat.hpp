@@ -0,0 +1,91 @@
+#pragma once
+
+#include "quat.hpp"
+#include "vec3.hpp"
+#include "mat3.hpp"
+#include "mat4.hpp"
+
+#include <cmath>
+
+namespace stx {
+
+/// A dual quaternion real + e * dual, used as a rigid transform (rotation then translation).
+/// Unlike matrices, blended unit dual quaternions stay rigid, which is what dual quaternion skinning relies on.
+/// @ingroup stxmath
+class dualquat {
+public:
+	quat real;
+	quat dual;
+
+	/// The identity transform
+	dualquat() :
+		real(), dual(0, 0, 0, 0)
+	{}
+
+	dualquat(quat const& real, quat const& dual) :
+		real(real), dual(dual)
+	{}
+
+	/// Rotates by rotation, then translates by translation
+	dualquat(quat const& rotation, vec3 const& translation) :
+		real(rotation),
+		dual(quat(0, translation.x, translation.y, translation.z) * rotation * .5f)
+	{}
+
+	/// Takes the rotation and translation of a rigid transform, scale and shear are lost
+	explicit
+	dualquat(mat4 const& m) :
+		dualquat(
+			quat(mat3(
+				m[0][0], m[1][0], m[2][0],
+				m[0][1], m[1][1], m[2][1],
+				m[0][2], m[1][2], m[2][2]
+			)).normalize(),
+			m.translation()
+		)
+	{}
+
+	dualquat operator+(dualquat const& other) const noexcept { return dualquat(real + other.real, dual + other.dual); }
+	dualquat operator-(dualquat const& other) const noexcept { return dualquat(real - other.real, dual - other.dual); }
+	dualquat operator*(float f)               const noexcept { return dualquat(real * f, dual * f); }
+
+	/// Composition, applies other first
+	dualquat operator*(dualquat const& other) const noexcept {
+		return dualquat(real * other.real, real * other.dual + dual * other.real);
+	}
+
+	dualquat& operator*=(dualquat const& other) noexcept { return *this = *this * other; }
+	dualquat& operator+=(dualquat const& other) noexcept { return *this = *this + other; }
+
+	bool operator==(dualquat const& other) const noexcept { return real == other.real && dual == other.dual; }
+	bool operator!=(dualquat const& other) const noexcept { return !(*this == other); }
+
+	/// The inverse transform of a unit dual quaternion
+	dualquat conjugate() const noexcept { return dualquat(real.conjugate(), dual.conjugate()); }
+
+	/// Divides by the length of the real part, making it a unit dual quaternion again after blending
+	dualquat normalize() const noexcept {
+		float const inv = 1.f / real.length();
+		return dualquat(real * inv, dual * inv);
+	}
+
+	quat rotation() const noexcept { return real; }
+
+	vec3 translation() const noexcept {
+		quat const t = dual * real.conjugate();
+		return vec3(t.x, t.y, t.z) * 2.f;
+	}
+
+	vec3 transform_point(vec3 const& p)  const noexcept { return real * p + translation(); }
+	vec3 transform_vector(vec3 const& v) const noexcept { return real * v; }
+
+	mat4 to_mat4() const noexcept { return mat4::transform(real, translation()); }
+
+	/// Linear blend with the shorter path, renormalized
+	dualquat blend(dualquat const& other, float k) const noexcept {
+		float const sign = real.dot(other.real) < 0 ? -1.f : 1.f;
+		return ((*this) * (1 - k) + other * (k * sign)).normalize();
+	}
+};
+
+} // namespace stx
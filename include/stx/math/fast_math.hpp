@@ -0,0 +1,93 @@
+#pragma once
+
+/* Opt-in approximate math.
+ * The fast_ functions below can be called directly. Defining STX_MATH_FAST (e.g. -DSTX_MATH_FAST)
+ * before including any stxmath header also switches the members that normalize or evaluate trig
+ * functions to them: vec2::normalized(), vec3::normalize(), vec4::normalize(), quat::normalize()
+ * and quat::slerp(). Sines and cosines stay std::, fast_sincos() doesn't beat glibc's sincosf.
+ * fast_rsqrt() uses the hardware estimate only with STX_MATH_SIMD, the polynomials are plain float code.
+ */
+
+#include "simd.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace stx {
+
+/// 1 / sqrt(x), relative error below 5e-7 (rsqrt estimate plus a Newton step with STX_MATH_SIMD, exact otherwise). @ingroup stxmath
+inline float fast_rsqrt(float x) noexcept {
+#if defined(STX_MATH_SSE)
+	__m128 const v = _mm_set_ss(x);
+	__m128 const r = _mm_rsqrt_ss(v);
+	__m128 const e = _mm_mul_ss(_mm_mul_ss(v, r), r);
+	return _mm_cvtss_f32(_mm_mul_ss(_mm_mul_ss(_mm_set_ss(.5f), r), _mm_sub_ss(_mm_set_ss(3.f), e)));
+#elif defined(STX_MATH_HAS_SIMD)
+	return simd::first(simd::rsqrt(simd::float4(x)));
+#else
+	return 1.f / std::sqrt(x);
+#endif
+}
+
+/// sin(x) and cos(x) at once, absolute error below 2e-7 for |x| <= 8192 (the range reduction loses precision beyond). @ingroup stxmath
+/// Reduces x to [-pi/4, pi/4] around the nearest multiple of pi/2 and evaluates the minimax polynomials of Cephes' sinf/cosf.
+/// |x| above 2^23, where floats are whole numbers anyway, is clamped to it so the quadrant fits an int32_t; inf included. nan gives nan.
+inline void fast_sincos(float x, float& s, float& c) noexcept {
+	float const limit = 8388608.f;
+	x = x > limit ? limit : (x < -limit ? -limit : x);
+	int32_t const quadrant = x == x ? (int32_t) (x * 0.636619772f + std::copysign(.5f, x)) : 0;
+	float const q = (float) quadrant;
+
+	// x - q * pi/2 with pi/2 split into three parts, the first two multiply exactly
+	float const r  = ((x - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+	float const r2 = r * r;
+
+	float const ps = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+	float const pc = 1.f - .5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+	// Rotate by the quadrant: (s, c), (c, -s), (-s, -c), (-c, s). The quadrant of random inputs is unpredictable,
+	// so the swap is a bit select and the signs are xors into the sign bit instead of branches
+	uint32_t sin_bits, cos_bits;
+	std::memcpy(&sin_bits, &ps, sizeof(float));
+	std::memcpy(&cos_bits, &pc, sizeof(float));
+	uint32_t const swap = (sin_bits ^ cos_bits) & (0u - (uint32_t) (quadrant & 1));
+	sin_bits ^= swap ^ ((uint32_t) (quadrant & 2) << 30);
+	cos_bits ^= swap ^ ((uint32_t) ((quadrant + 1) & 2) << 30);
+	std::memcpy(&s, &sin_bits, sizeof(float));
+	std::memcpy(&c, &cos_bits, sizeof(float));
+}
+
+/// sin(x), see fast_sincos(). @ingroup stxmath
+inline float fast_sin(float x) noexcept { float s, c; fast_sincos(x, s, c); return s; }
+/// cos(x), see fast_sincos(). @ingroup stxmath
+inline float fast_cos(float x) noexcept { float s, c; fast_sincos(x, s, c); return c; }
+
+/// atan2(y, x), absolute error below 3e-6 radians. @ingroup stxmath
+/// Evaluates atan on [0, 1] with a degree 11 minimax polynomial and mirrors the result into the right octant.
+/// fast_atan2(0, 0) is 0 (or pi for a negative x) like std::atan2, inf inputs are not handled.
+inline float fast_atan2(float y, float x) noexcept {
+	float const ax = std::abs(x);
+	float const ay = std::abs(y);
+	float const mx = ax > ay ? ax : ay;
+	float const mn = ax > ay ? ay : ax;
+	float const t  = mx > 0 ? mn / mx : 0.f;
+	float const t2 = t * t;
+
+	float r = t * (0.99997726f + t2 * (-0.33262347f + t2 * (0.19354346f + t2 * (-0.11643287f + t2 * (0.05265332f + t2 * -0.01172120f)))));
+	if(ay > ax)         r = 1.57079637f - r;
+	if(std::signbit(x)) r = 3.14159274f - r;
+	return std::copysign(r, y);
+}
+
+/// acos(x), absolute error below 5e-7 radians. @ingroup stxmath
+/// x is clamped to [-1, 1], so rounding errors in e.g. dot products don't turn into nan.
+/// Uses the degree 7 polynomial of Abramowitz and Stegun 4.4.46, acos(x) = sqrt(1 - x) * p(x) on [0, 1].
+inline float fast_acos(float x) noexcept {
+	float const a = std::abs(x) < 1.f ? std::abs(x) : 1.f;
+	float const p = 1.5707963050f + a * (-0.2145988016f + a * (0.0889789874f + a * (-0.0501743046f + a * (0.0308918810f + a * (-0.0170881256f + a * (0.0066700901f + a * -0.0012624911f))))));
+	float const r = std::sqrt(1.f - a) * p;
+	return x < 0 ? 3.14159274f - r : r;
+}
+
+} // namespace stx
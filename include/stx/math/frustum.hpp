@@ -0,0 +1,244 @@
+#pragma once
+
+#include "mat4.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace stx {
+
+/// The six planes of a view frustum, extracted from a view-projection matrix with depth zero to one like perspective() creates.
+/// With depth_mode::reverse_z plane_near and plane_far trade places, the infinite modes get a far plane that contains everything.
+/// Each plane is a vec4 (normal, distance) with a normalized normal pointing into the frustum,
+/// i.e. a point p is on the inside when dot(normal, p) + distance >= 0.
+/// The batch tests write one bit per object (bit i % 32 of word i / 32), set for visible objects. @ingroup stxmath
+class frustum {
+public:
+	enum plane_index : unsigned {
+		plane_left, plane_right, plane_bottom, plane_top, plane_near, plane_far,
+		plane_count
+	};
+
+	vec4 planes[plane_count];
+
+	frustum() = default;
+
+	explicit
+	frustum(mat4 const& view_projection) noexcept {
+		mat4 const& m = view_projection;
+		vec4 const row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		vec4 const row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		vec4 const row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		vec4 const row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+		planes[plane_left]   = row3 + row0;
+		planes[plane_right]  = row3 - row0;
+		planes[plane_bottom] = row3 + row1;
+		planes[plane_top]    = row3 - row1;
+		planes[plane_near]   = row2;
+		planes[plane_far]    = row3 - row2;
+
+		for(vec4& p : planes) {
+			// The far plane of an infinite projection has a zero normal and a positive distance, everything is inside
+			float const length = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+			p = length > 0 ? p / length : vec4(0, 0, 0, 1);
+		}
+	}
+
+	/// Signed distance of p to plane i, negative outside
+	float distance(unsigned i, vec3 const& p) const noexcept {
+		return planes[i].x * p.x + planes[i].y * p.y + planes[i].z * p.z + planes[i].w;
+	}
+
+	bool contains(vec3 const& p) const noexcept {
+		for(unsigned i = 0; i < plane_count; i++) {
+			if(distance(i, p) < 0) return false;
+		}
+		return true;
+	}
+
+	/// Conservative: spheres slightly outside near a corner may pass
+	bool intersects_sphere(vec3 const& center, float radius) const noexcept {
+		for(unsigned i = 0; i < plane_count; i++) {
+			if(distance(i, center) < -radius) return false;
+		}
+		return true;
+	}
+
+	/// Conservative: boxes slightly outside near a corner may pass
+	bool intersects_box(vec3 const& min, vec3 const& max) const noexcept {
+		vec3 const center = (min + max) * .5f;
+		vec3 const extent = (max - min) * .5f;
+		for(unsigned i = 0; i < plane_count; i++) {
+			if(distance(i, center) < -radius(i, extent)) return false;
+		}
+		return true;
+	}
+
+	/// Tests n spheres (xyz center, w radius), visible must hold (n + 31) / 32 words
+	void cull_spheres(vec4 const* spheres, size_t n, uint32_t* visible) const noexcept {
+		using simd::float4;
+
+		std::memset(visible, 0, ((n + 31) / 32) * sizeof(uint32_t));
+
+		float4 px[plane_count], py[plane_count], pz[plane_count], pw[plane_count];
+		splat_planes(px, py, pz, pw);
+
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4) {
+			float4 x = float4::load(spheres[i + 0].xyzw);
+			float4 y = float4::load(spheres[i + 1].xyzw);
+			float4 z = float4::load(spheres[i + 2].xyzw);
+			float4 r = float4::load(spheres[i + 3].xyzw);
+			simd::transpose(x, y, z, r);
+
+			float4 outside = float4::zero();
+			for(unsigned p = 0; p < plane_count; p++) {
+				float4 const d = simd::madd(z, pz[p], simd::madd(y, py[p], simd::madd(x, px[p], pw[p])));
+				outside = outside | (d < -r);
+			}
+			visible[i / 32] |= (uint32_t)(~simd::movemask(outside) & 0xF) << (i % 32);
+		}
+		for(; i < n; i++) {
+			if(intersects_sphere(vec3(spheres[i].x, spheres[i].y, spheres[i].z), spheres[i].w))
+				visible[i / 32] |= 1u << (i % 32);
+		}
+	}
+
+	/// Tests n axis aligned boxes given by their corners, visible must hold (n + 31) / 32 words
+	void cull_boxes(vec3 const* min, vec3 const* max, size_t n, uint32_t* visible) const noexcept {
+		using simd::float4;
+
+		std::memset(visible, 0, ((n + 31) / 32) * sizeof(uint32_t));
+
+		float4 px[plane_count], py[plane_count], pz[plane_count], pw[plane_count];
+		splat_planes(px, py, pz, pw);
+
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4) {
+			vec3x4 const mn = vec3x4::load(min + i);
+			vec3x4 const mx = vec3x4::load(max + i);
+			vec3x4 const c  = (mn + mx) * float4(.5f);
+			vec3x4 const e  = (mx - mn) * float4(.5f);
+
+			float4 outside = float4::zero();
+			for(unsigned p = 0; p < plane_count; p++) {
+				float4 const d = simd::madd(c.z, pz[p], simd::madd(c.y, py[p], simd::madd(c.x, px[p], pw[p])));
+				float4 const r = simd::madd(e.z, simd::abs(pz[p]), simd::madd(e.y, simd::abs(py[p]), e.x * simd::abs(px[p])));
+				outside = outside | (d < -r);
+			}
+			visible[i / 32] |= (uint32_t)(~simd::movemask(outside) & 0xF) << (i % 32);
+		}
+		for(; i < n; i++) {
+			if(intersects_box(min[i], max[i]))
+				visible[i / 32] |= 1u << (i % 32);
+		}
+	}
+
+	/// Like cull_spheres(), but first tests the plane that rejected an object the last time.
+	/// plane_cache holds one entry per object and is updated, initialize it with zeros.
+	/// Pays off when most objects stay culled between frames.
+	void cull_spheres(vec4 const* spheres, size_t n, uint32_t* visible, uint8_t* plane_cache) const noexcept {
+		std::memset(visible, 0, ((n + 31) / 32) * sizeof(uint32_t));
+
+		plane_lanes lanes(*this);
+		for(size_t i = 0; i < n; i++) {
+			vec3 const  c(spheres[i].x, spheres[i].y, spheres[i].z);
+			float const r = spheres[i].w;
+
+			unsigned const cached = plane_cache[i] < plane_count ? plane_cache[i] : 0;
+			if(distance(cached, c) < -r) continue;
+
+			int const rejecting = lanes.outside(c, r, vec3(0));
+			if(rejecting) {
+				plane_cache[i] = (uint8_t) lowest_bit(rejecting);
+			}
+			else {
+				visible[i / 32] |= 1u << (i % 32);
+			}
+		}
+	}
+
+	/// Like cull_boxes(), but first tests the plane that rejected an object the last time.
+	/// plane_cache holds one entry per object and is updated, initialize it with zeros.
+	void cull_boxes(vec3 const* min, vec3 const* max, size_t n, uint32_t* visible, uint8_t* plane_cache) const noexcept {
+		std::memset(visible, 0, ((n + 31) / 32) * sizeof(uint32_t));
+
+		plane_lanes lanes(*this);
+		for(size_t i = 0; i < n; i++) {
+			vec3 const c = (min[i] + max[i]) * .5f;
+			vec3 const e = (max[i] - min[i]) * .5f;
+
+			unsigned const cached = plane_cache[i] < plane_count ? plane_cache[i] : 0;
+			if(distance(cached, c) < -radius(cached, e)) continue;
+
+			int const rejecting = lanes.outside(c, 0, e);
+			if(rejecting) {
+				plane_cache[i] = (uint8_t) lowest_bit(rejecting);
+			}
+			else {
+				visible[i / 32] |= 1u << (i % 32);
+			}
+		}
+	}
+
+private:
+	/// Projected half size of a box with the given extent onto plane i's normal
+	float radius(unsigned i, vec3 const& extent) const noexcept {
+		return fabsf(planes[i].x) * extent.x + fabsf(planes[i].y) * extent.y + fabsf(planes[i].z) * extent.z;
+	}
+
+	void splat_planes(simd::float4* px, simd::float4* py, simd::float4* pz, simd::float4* pw) const noexcept {
+		for(unsigned p = 0; p < plane_count; p++) {
+			px[p] = simd::float4(planes[p].x);
+			py[p] = simd::float4(planes[p].y);
+			pz[p] = simd::float4(planes[p].z);
+			pw[p] = simd::float4(planes[p].w);
+		}
+	}
+
+	static unsigned lowest_bit(int mask) noexcept {
+		unsigned i = 0;
+		while(!(mask & (1 << i))) i++;
+		return i;
+	}
+
+	/// The planes transposed so one object is tested against 4 planes at once
+	struct plane_lanes {
+		simd::float4 x[2], y[2], z[2], w[2];
+
+		explicit
+		plane_lanes(frustum const& f) noexcept {
+			// The two unused lanes get an enormous distance so they never reject anything
+			vec4 const pad(0, 0, 0, 3.4e38f);
+			vec4 const p[8] = {
+				f.planes[0], f.planes[1], f.planes[2], f.planes[3],
+				f.planes[4], f.planes[5], pad, pad
+			};
+			for(unsigned g = 0; g < 2; g++) {
+				vec4 const* q = p + g * 4;
+				x[g] = simd::float4(q[0].x, q[1].x, q[2].x, q[3].x);
+				y[g] = simd::float4(q[0].y, q[1].y, q[2].y, q[3].y);
+				z[g] = simd::float4(q[0].z, q[1].z, q[2].z, q[3].z);
+				w[g] = simd::float4(q[0].w, q[1].w, q[2].w, q[3].w);
+			}
+		}
+
+		/// Bit i set if plane i rejects the sphere / box. Spheres pass their radius in r, boxes their half size in e.
+		int outside(vec3 const& c, float r, vec3 const& e) const noexcept {
+			using simd::float4;
+			int result = 0;
+			for(unsigned g = 0; g < 2; g++) {
+				float4 const d = simd::madd(float4(c.z), z[g], simd::madd(float4(c.y), y[g], simd::madd(float4(c.x), x[g], w[g])));
+				float4 const extent = simd::madd(float4(e.z), simd::abs(z[g]), simd::madd(float4(e.y), simd::abs(y[g]), float4(e.x) * simd::abs(x[g])));
+				result |= simd::movemask(d + extent < float4(-r)) << (g * 4);
+			}
+			return result;
+		}
+	};
+};
+
+} // namespace stx
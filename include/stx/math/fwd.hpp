@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+namespace stx {
+
+/// An N dimensional vector of T. @ingroup stxmath
+/// vec<2..4, float> are the hand tuned vec2, vec3 and vec4 (vec4 with SIMD storage),
+/// every other combination is the generic template from vec.hpp.
+template<unsigned N, class T = float> class vec;
+
+/// A column-major R x C matrix of T. @ingroup stxmath
+/// mat<3, 3, float> and mat<4, 4, float> are the hand tuned mat3 and mat4, every other combination is the generic template from mat.hpp.
+template<unsigned R, unsigned C, class T = float> class mat;
+
+using vec2 = vec<2, float>;
+using vec3 = vec<3, float>;
+using vec4 = vec<4, float>;
+
+using mat2 = mat<2, 2, float>;
+using mat3 = mat<3, 3, float>;
+using mat4 = mat<4, 4, float>;
+
+using dvec2 = vec<2, double>;
+using dvec3 = vec<3, double>;
+using dvec4 = vec<4, double>;
+
+using ivec2 = vec<2, int32_t>;
+using ivec3 = vec<3, int32_t>;
+using ivec4 = vec<4, int32_t>;
+
+using uvec2 = vec<2, uint32_t>;
+using uvec3 = vec<3, uint32_t>;
+using uvec4 = vec<4, uint32_t>;
+
+using dmat2 = mat<2, 2, double>;
+using dmat3 = mat<3, 3, double>;
+using dmat4 = mat<4, 4, double>;
+
+} // namespace stx
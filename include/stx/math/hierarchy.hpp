@@ -0,0 +1,185 @@
+#pragma once
+
+#include "mat4.hpp"
+#include "quat.hpp"
+#include "vec3.hpp"
+#include "parallel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stx {
+
+/// A scene graph of transforms stored as flat arrays, parents always before their children. @ingroup stxmath
+/// Setting a local transform marks the node dirty, update() then recomputes the world matrices of
+/// dirty nodes and their descendants only, in parallel for big hierarchies.
+/// Nodes are only ever appended, the index returned by add() identifies them.
+class transform_hierarchy {
+public:
+	/// Parent of root nodes
+	enum : uint32_t { none = UINT32_MAX };
+
+	/// Hierarchies smaller than this are always updated on the calling thread
+	constexpr static size_t parallel_threshold = 8192;
+
+	transform_hierarchy() = default;
+
+	/// Adds a node below parent (or a root for none), returns its index
+	uint32_t add(uint32_t parent = none, mat4 const& local = mat4()) {
+		uint32_t const index = (uint32_t) m_parent.size();
+		m_parent.push_back(parent);
+		m_first_child.push_back(none);
+		m_next_sibling.push_back(parent == none ? none : m_first_child[parent]);
+		if(parent != none) m_first_child[parent] = index;
+		m_local.push_back(local);
+		m_world.push_back(local);
+		m_dirty.push_back(0);
+		mark_dirty(index);
+		return index;
+	}
+
+	/// Adds a node with the local transform translation * rotation * scale, the order of trs
+	uint32_t add(uint32_t parent, vec3 const& translation, quat const& rotation, vec3 const& scale = vec3(1)) {
+		return add(parent, compose(translation, rotation, scale));
+	}
+
+	void set_local(uint32_t node, mat4 const& local) {
+		m_local[node] = local;
+		mark_dirty(node);
+	}
+
+	/// Sets the local transform to translation * rotation * scale, the order of trs
+	void set_local(uint32_t node, vec3 const& translation, quat const& rotation, vec3 const& scale = vec3(1)) {
+		set_local(node, compose(translation, rotation, scale));
+	}
+
+	mat4 const& local(uint32_t node) const noexcept { return m_local[node]; }
+	/// Only up to date after update()
+	mat4 const& world(uint32_t node) const noexcept { return m_world[node]; }
+	mat4 const* world_matrices() const noexcept { return m_world.data(); }
+
+	uint32_t parent(uint32_t node) const noexcept { return m_parent[node]; }
+	bool     dirty(uint32_t node)  const noexcept { return m_dirty[node] != 0; }
+	size_t   size()                const noexcept { return m_parent.size(); }
+
+	void clear() noexcept {
+		m_parent.clear(); m_first_child.clear(); m_next_sibling.clear();
+		m_local.clear(); m_world.clear(); m_dirty.clear(); m_dirty_nodes.clear();
+	}
+
+	/// Recomputes the world matrices of all dirty nodes and their descendants.
+	/// Costs O(changed nodes), plus the depth of each changed node to find the topmost ones.
+	void update(unsigned threads = thread_count()) {
+		if(m_dirty_nodes.empty()) return;
+
+		bool const parallel = threads > 1 && size() >= parallel_threshold;
+		if(!parallel && m_dirty_nodes.size() >= size() / 8) {
+			update_linear();
+			return;
+		}
+
+		// Only the topmost dirty nodes start a subtree update, the others are part of one
+		std::vector<uint32_t> tasks;
+		for(uint32_t node : m_dirty_nodes) {
+			if(!has_dirty_ancestor(node)) tasks.push_back(node);
+		}
+		m_dirty_nodes.clear();
+
+		if(parallel) {
+			// A few big subtrees (say one dirty root) don't spread over threads, so split them into their
+			// children level by level until there are enough independent subtrees
+			size_t const enough = threads * 8;
+			std::vector<uint32_t> next;
+			while(tasks.size() < enough && !tasks.empty()) {
+				next.clear();
+				for(uint32_t node : tasks) {
+					update_node(node);
+					for(uint32_t c = m_first_child[node]; c != none; c = m_next_sibling[c]) next.push_back(c);
+				}
+				tasks.swap(next);
+			}
+
+			parallel_for(0, tasks.size(), 1, [this, &tasks](size_t first, size_t last) {
+				for(size_t i = first; i < last; i++) update_subtree(tasks[i]);
+			}, threads);
+		}
+		else {
+			for(uint32_t node : tasks) update_subtree(node);
+		}
+	}
+
+private:
+	std::vector<uint32_t> m_parent;
+	std::vector<uint32_t> m_first_child;
+	std::vector<uint32_t> m_next_sibling;
+	std::vector<mat4>     m_local;
+	std::vector<mat4>     m_world;
+	std::vector<uint8_t>  m_dirty;
+	/// Every node with m_dirty set, each once
+	std::vector<uint32_t> m_dirty_nodes;
+
+	/// translation * rotation * scale. Not mat4::transform(), which scales after rotating.
+	static
+	mat4 compose(vec3 const& translation, quat const& rotation, vec3 const& scale) noexcept {
+		mat3 const r = rotation.to_mat3();
+		return mat4(
+			vec4(r[0].x * scale.x, r[0].y * scale.x, r[0].z * scale.x, 0),
+			vec4(r[1].x * scale.y, r[1].y * scale.y, r[1].z * scale.y, 0),
+			vec4(r[2].x * scale.z, r[2].y * scale.z, r[2].z * scale.z, 0),
+			vec4(translation.x, translation.y, translation.z, 1)
+		);
+	}
+
+	void mark_dirty(uint32_t node) {
+		if(m_dirty[node]) return;
+		m_dirty[node] = 1;
+		m_dirty_nodes.push_back(node);
+	}
+
+	bool has_dirty_ancestor(uint32_t node) const noexcept {
+		for(uint32_t p = m_parent[node]; p != none; p = m_parent[p]) {
+			if(m_dirty[p]) return true;
+		}
+		return false;
+	}
+
+	void update_node(uint32_t node) noexcept {
+		uint32_t const p = m_parent[node];
+		m_world[node] = p == none ? m_local[node] : m_world[p] * m_local[node];
+		m_dirty[node] = 0;
+	}
+
+	/// Walks all nodes in order, which visits parents before children. Cheaper than walking subtrees when much changed.
+	void update_linear() noexcept {
+		// 1 = dirty, 2 = updated in this pass
+		for(size_t i = 0; i < size(); i++) {
+			uint32_t const p = m_parent[i];
+			if(m_dirty[i] || (p != none && m_dirty[p] == 2)) {
+				m_world[i] = p == none ? m_local[i] : m_world[p] * m_local[i];
+				m_dirty[i] = 2;
+			}
+		}
+		for(uint8_t& d : m_dirty) d = 0;
+		m_dirty_nodes.clear();
+	}
+
+	/// Updates node and everything below it, depth first without recursion
+	void update_subtree(uint32_t root) noexcept {
+		update_node(root);
+		uint32_t node = m_first_child[root];
+		while(node != none) {
+			update_node(node);
+			if(m_first_child[node] != none) {
+				node = m_first_child[node];
+				continue;
+			}
+			// Climb up until there is a sibling to continue with, stopping at the subtree root
+			while(node != root && m_next_sibling[node] == none) node = m_parent[node];
+			if(node == root) break;
+			node = m_next_sibling[node];
+		}
+	}
+};
+
+} // namespace stx
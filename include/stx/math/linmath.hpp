@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "fast_math.hpp"
+
 #include "vec2.hpp"
 #include "vec3.hpp"
 #include "vec4.hpp"
@@ -10,3 +12,7 @@
 
 #include "mat3.hpp"
 #include "mat4.hpp"
+#include "transform.hpp"
+
+#include "vec.hpp"
+#include "mat.hpp"
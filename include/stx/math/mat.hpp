@@ -0,0 +1,268 @@
+#pragma once
+
+#include "fwd.hpp"
+#include "vec.hpp"
+#include "mat3.hpp"
+#include "mat4.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace stx {
+
+namespace detail {
+
+/// Laplace expansion along the first column, exact for integer matrices
+template<unsigned N, class T>
+struct determinant_impl {
+	constexpr static
+	T get(T const* m) noexcept { // m[column * N + row]
+		T result = T();
+		T sign   = T(1);
+		for(unsigned skip = 0; skip < N; skip++) {
+			T sub[(N - 1) * (N - 1)] = {};
+			for(unsigned c = 1; c < N; c++) {
+				for(unsigned r = 0, mr = 0; r < N; r++) {
+					if(r == skip) continue;
+					sub[(c - 1) * (N - 1) + mr++] = m[c * N + r];
+				}
+			}
+			result += sign * m[skip] * determinant_impl<N - 1, T>::get(sub);
+			sign = -sign;
+		}
+		return result;
+	}
+};
+
+template<class T>
+struct determinant_impl<1, T> {
+	constexpr static T get(T const* m) noexcept { return m[0]; }
+};
+
+/// The products of the generic mat, plain loops left to the compiler's auto vectorizer
+struct mat_loops {
+	template<class Result, class A, class B>
+	constexpr static Result mul(A const& a, B const& b) noexcept { // a is R x C, b is C x K
+		constexpr unsigned R = A::rows(), C = A::columns(), K = B::columns();
+		Result result;
+		for(unsigned i = 0; i < R * K; i++) result.data[i] = typename A::value_type();
+		for(unsigned k = 0; k < K; k++) {
+			for(unsigned c = 0; c < C; c++) {
+				auto const f = b.data[k * C + c];
+				for(unsigned r = 0; r < R; r++) result.data[k * R + r] += a.data[c * R + r] * f;
+			}
+		}
+		return result;
+	}
+
+	template<class V, class M, class W>
+	constexpr static V transform(M const& m, W const& v) noexcept {
+		constexpr unsigned R = M::rows(), C = M::columns();
+		V result;
+		for(unsigned c = 0; c < C; c++) {
+			for(unsigned r = 0; r < R; r++) result[r] += m.data[c * R + r] * v[c];
+		}
+		return result;
+	}
+};
+
+/// Picks the kernels of mat<R, C, T>, the plain loops unless specialized below
+template<unsigned R, unsigned C, class T>
+struct mat_kernels : mat_loops {};
+
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+/// dmat4 times dmat4 or dvec4 on simd::double4 columns, except while constant evaluated
+template<>
+struct mat_kernels<4, 4, double> : mat_loops {
+	/// m * (v[0], v[1], v[2], v[3]), column wise
+	static simd::double4 column(double const* m, double const* v) noexcept {
+		using simd::double4;
+		double4 r = double4::load(m) * double4(v[0]);
+		r = simd::madd(double4::load(m +  4), double4(v[1]), r);
+		r = simd::madd(double4::load(m +  8), double4(v[2]), r);
+		return simd::madd(double4::load(m + 12), double4(v[3]), r);
+	}
+
+	template<class Result, class A, class B>
+	constexpr static typename std::enable_if<B::columns() == 4, Result>::type mul(A const& a, B const& b) noexcept {
+		if(STX_MATH_CONSTANT_EVALUATED()) return mat_loops::mul<Result>(a, b);
+		Result result;
+		for(unsigned k = 0; k < 4; k++) column(a.data, b.data + 4 * k).store(result.data + 4 * k);
+		return result;
+	}
+	template<class Result, class A, class B>
+	constexpr static typename std::enable_if<B::columns() != 4, Result>::type mul(A const& a, B const& b) noexcept { return mat_loops::mul<Result>(a, b); }
+
+	template<class V, class M, class W>
+	constexpr static V transform(M const& m, W const& v) noexcept {
+		if(STX_MATH_CONSTANT_EVALUATED()) return mat_loops::transform<V>(m, v);
+		V result;
+		column(m.data, v.data).store(result.data);
+		return result;
+	}
+};
+#endif
+
+template<class T, class... Ts>
+struct all_same : std::true_type {};
+
+template<class T, class U, class... Ts>
+struct all_same<T, U, Ts...> : std::integral_constant<bool, std::is_same<T, U>::value && all_same<T, Ts...>::value> {};
+
+} // namespace detail
+
+/// The generic column-major R x C matrix, e.g. dmat4 for large worlds. @ingroup stxmath
+/// Like vec<N, T>, the implementation is picked at compile time: mat3 and mat4 are the hand written
+/// float specializations (mat4 with SIMD kernels), every other shape or element type uses this template.
+/// With STX_MATH_SIMD, dmat4 * dmat4 and dmat4 * dvec4 run on simd::double4 columns (see detail::mat_kernels).
+/// Accessors are column-major, the element constructor takes rows like the one of mat3 and mat4.
+template<unsigned R, unsigned C, class T>
+class mat {
+	static_assert(R > 0 && C > 0, "mat needs at least one row and column");
+public:
+	using value_type  = T;
+	using column_type = vec<R, T>;
+
+	union {
+		T           data[R * C];
+		column_type vectors[C];
+	};
+
+	/// Scales the diagonal, i.e. the identity by default
+	constexpr explicit
+	mat(T diagonal = T(1)) :
+		data{}
+	{
+		for(unsigned i = 0; i < R && i < C; i++) data[i * R + i] = diagonal;
+	}
+
+	/// Row major element constructor (ACCESS IS COLUMN MAJOR)
+	template<class... Args, class = typename std::enable_if<(R * C > 1) && sizeof...(Args) == R * C>::type>
+	constexpr
+	mat(Args... elements) :
+		data{}
+	{
+		T const values[] = { T(elements)... };
+		for(unsigned r = 0; r < R; r++) {
+			for(unsigned c = 0; c < C; c++) data[c * R + r] = values[r * C + c];
+		}
+	}
+
+	/// Column constructor
+	template<class... Columns, class = typename std::enable_if<(R > 1) && sizeof...(Columns) == C && detail::all_same<column_type, Columns...>::value>::type>
+	constexpr
+	mat(Columns const&... columns) :
+		data{}
+	{
+		column_type const values[] = { columns... };
+		for(unsigned c = 0; c < C; c++) {
+			for(unsigned r = 0; r < R; r++) data[c * R + r] = values[c][r];
+		}
+	}
+
+	/// Converts the element type, e.g. dmat4(mat4(...))
+	template<class U>
+	constexpr explicit
+	mat(mat<R, C, U> const& other) :
+		data{}
+	{
+		for(unsigned c = 0; c < C; c++) {
+			for(unsigned r = 0; r < R; r++) data[c * R + r] = T(other[c][r]);
+		}
+	}
+
+	/// Converts to the float matrices, e.g. mat4(dmat4(...))
+	template<class U, class = typename std::enable_if<std::is_same<U, float>::value && !std::is_same<T, float>::value>::type>
+	explicit operator mat<R, C, U>() const noexcept {
+		mat<R, C, U> result;
+		for(unsigned c = 0; c < C; c++) {
+			for(unsigned r = 0; r < R; r++) result[c][r] = U(data[c * R + r]);
+		}
+		return result;
+	}
+
+	constexpr static mat identity() noexcept { return mat(); }
+	constexpr static mat zero()     noexcept { return mat(T()); }
+
+	constexpr static unsigned rows()    noexcept { return R; }
+	constexpr static unsigned columns() noexcept { return C; }
+
+	constexpr T const& operator()(unsigned row, unsigned column) const noexcept { return data[column * R + row]; }
+	constexpr T&       operator()(unsigned row, unsigned column)       noexcept { return data[column * R + row]; }
+
+	column_type const& operator[](size_t column) const noexcept { return vectors[column]; }
+	column_type&       operator[](size_t column)       noexcept { return vectors[column]; }
+
+	constexpr mat operator+(mat const& other) const noexcept { mat r = zero(); for(unsigned i = 0; i < R * C; i++) r.data[i] = data[i] + other.data[i]; return r; }
+	constexpr mat operator-(mat const& other) const noexcept { mat r = zero(); for(unsigned i = 0; i < R * C; i++) r.data[i] = data[i] - other.data[i]; return r; }
+	constexpr mat operator*(T f)              const noexcept { mat r = zero(); for(unsigned i = 0; i < R * C; i++) r.data[i] = data[i] * f; return r; }
+	constexpr mat operator-()                 const noexcept { mat r = zero(); for(unsigned i = 0; i < R * C; i++) r.data[i] = -data[i]; return r; }
+
+	template<unsigned K>
+	constexpr mat<R, K, T> operator*(mat<C, K, T> const& other) const noexcept { return detail::mat_kernels<R, C, T>::template mul<mat<R, K, T>>(*this, other); }
+
+	constexpr vec<R, T> operator*(vec<C, T> const& v) const noexcept { return detail::mat_kernels<R, C, T>::template transform<vec<R, T>>(*this, v); }
+
+	constexpr bool operator==(mat const& other) const noexcept {
+		for(unsigned i = 0; i < R * C; i++) {
+			if(data[i] != other.data[i]) return false;
+		}
+		return true;
+	}
+	constexpr bool operator!=(mat const& other) const noexcept { return !(*this == other); }
+
+	constexpr mat<C, R, T> transpose() const noexcept {
+		mat<C, R, T> result;
+		for(unsigned c = 0; c < C; c++) {
+			for(unsigned r = 0; r < R; r++) result.data[r * C + c] = data[c * R + r];
+		}
+		return result;
+	}
+
+	constexpr T determinant() const noexcept {
+		static_assert(R == C, "determinant() needs a square matrix");
+		return detail::determinant_impl<R, T>::get(data);
+	}
+
+	/// Gauss-Jordan elimination with partial pivoting, needs a floating point T.
+	/// The result is undefined (inf/nan) for singular matrices.
+	mat inverse() const noexcept {
+		static_assert(R == C, "inverse() needs a square matrix");
+		mat a = *this;
+		mat result;
+		for(unsigned c = 0; c < C; c++) {
+			unsigned pivot = c;
+			for(unsigned r = c + 1; r < R; r++) {
+				if(std::abs(a(r, c)) > std::abs(a(pivot, c))) pivot = r;
+			}
+			if(pivot != c) {
+				for(unsigned k = 0; k < C; k++) {
+					T t = a(c, k);      a(c, k)      = a(pivot, k);      a(pivot, k)      = t;
+					t   = result(c, k); result(c, k) = result(pivot, k); result(pivot, k) = t;
+				}
+			}
+
+			T const inv = T(1) / a(c, c);
+			for(unsigned k = 0; k < C; k++) {
+				a(c, k)      *= inv;
+				result(c, k) *= inv;
+			}
+			for(unsigned r = 0; r < R; r++) {
+				if(r == c) continue;
+				T const f = a(r, c);
+				for(unsigned k = 0; k < C; k++) {
+					a(r, k)      -= f * a(c, k);
+					result(r, k) -= f * result(c, k);
+				}
+			}
+		}
+		return result;
+	}
+};
+
+template<unsigned R, unsigned C, class T>
+constexpr inline
+mat<R, C, T> operator*(typename mat<R, C, T>::value_type f, mat<R, C, T> const& m) noexcept { return m * f; }
+
+} // namespace stx
@@ -3,13 +3,15 @@
 #include "vec3.hpp"
 #include "quat.hpp"
 
+#include <cmath>
 #include <initializer_list>
 #include <cstring>
 
 namespace stx {
 
-/// A 3x3 matrix. All accessors are column-major. @ingroup stxmath
-class mat3 {
+/// A 3x3 matrix, the float specialization of mat<3, 3, T> aliased as mat3. All accessors are column-major. @ingroup stxmath
+template<>
+class mat<3, 3, float> {
 public:
 	union {
 		float data[9];
@@ -17,12 +19,12 @@ public:
 	};
 
 	constexpr
-	mat3(std::nullptr_t) :
+	mat(std::nullptr_t) :
 		vectors{vec3(), vec3(), vec3()}
 	{}
 
 	constexpr
-	mat3(float scale = 1.f) :
+	mat(float scale = 1.f) :
 		mat3(
 			scale,     0,     0,
 			    0, scale,     0,
@@ -30,7 +32,7 @@ public:
 		)
 	{}
 
-	mat3(vec3 const& scale) :
+	mat(vec3 const& scale) :
 		mat3(
 			scale.x,       0,       0,
 			      0, scale.y,       0,
@@ -39,12 +41,12 @@ public:
 	{}
 
 	constexpr /// Column constructor
-	mat3(const vec3& a, const vec3& b, const vec3& c) :
+	mat(const vec3& a, const vec3& b, const vec3& c) :
 		vectors{ a, b, c }
 	{}
 
 	constexpr // Row major constructor (ACCESS IS COLUMN MAJOR)
-	mat3(
+	mat(
 		float aa, float ab, float ac,
 		float ba, float bb, float bc,
 		float ca, float cb, float cc) :
@@ -56,10 +58,11 @@ public:
 	{}
 
 	mat3 transpose() const noexcept {
+		// The row major constructor takes our columns as rows
 		return mat3(
-			data[0], data[3], data[6],
-			data[1], data[4], data[7],
-			data[2], data[5], data[8]
+			data[0], data[1], data[2],
+			data[3], data[4], data[5],
+			data[6], data[7], data[8]
 		);
 	}
 
@@ -74,6 +77,22 @@ public:
 			vectors[0][0] * vectors[1][2] * vectors[2][1];
 	}
 
+	/// The inverse via the adjugate. The result is undefined (inf/nan) for singular matrices.
+	constexpr
+	mat3 inverse() const {
+		vec3 const r0 = vectors[1].cross(vectors[2]);
+		vec3 const r1 = vectors[2].cross(vectors[0]);
+		vec3 const r2 = vectors[0].cross(vectors[1]);
+
+		float const inverse_det = 1 / vectors[0].dot(r0);
+
+		return mat3(
+			r0.x * inverse_det, r0.y * inverse_det, r0.z * inverse_det,
+			r1.x * inverse_det, r1.y * inverse_det, r1.z * inverse_det,
+			r2.x * inverse_det, r2.y * inverse_det, r2.z * inverse_det
+		);
+	}
+
 	constexpr operator const float*() const noexcept { return data; }
 	constexpr operator       float*()                { return data; }
 
@@ -106,28 +125,59 @@ public:
 		return true;
 	}
 
+	/// Solves a * x.x + b * x.y + c * x.z = d. The cross products are the rows of the adjugate, so the four
+	/// determinants of Cramer's rule become triple products. Undefined (inf/nan) for singular systems,
+	/// see solve3() in solve.hpp for a batched version that flags them.
 	constexpr static
 	vec3 solveWithCramersRule(vec3 const& a, vec3 const& b, vec3 const& c, vec3 const& d) {
-		float inverse_d0 = 1 / mat3(a, b, c).determinant();
+		vec3 const bc = b.cross(c);
+		float const inverse_det = 1 / a.dot(bc);
 		return vec3(
-			mat3(d, b, c).determinant() * inverse_d0,
-			mat3(a, d, c).determinant() * inverse_d0,
-			mat3(a, b, d).determinant() * inverse_d0
+			d.dot(bc)         * inverse_det,
+			d.dot(c.cross(a)) * inverse_det,
+			d.dot(a.cross(b)) * inverse_det
 		);
 	}
 };
 
+namespace detail {
+
+/// Shepperd's method: the largest of 4w², 4x², 4y², 4z² (from the trace and the diagonal) gives one component
+/// with a single sqrt, the off diagonal sums and differences the other three. Accurate for any rotation,
+/// unlike the trace alone, which breaks down near 180 degrees. The result has w >= 0.
+/// c0, c1, c2 are the columns of an orthonormal matrix with determinant 1.
 inline
-quat::quat(mat3 const& m) :
-	quat()
-{
-	this->w = sqrtf(1 + m[0][0] + m[1][1] + m[2][2]);
-	float w4 = w * 4;
-	this->x = (m[2][1] - m[1][2]) / w4;
-	this->y = (m[0][2] - m[2][0]) / w4;
-	this->z = (m[1][0] - m[0][1]) / w4;
+quat rotation_to_quat(vec3 const& c0, vec3 const& c1, vec3 const& c2) noexcept {
+	float const t0 = 1 + c0.x + c1.y + c2.z; // 4w²
+	float const t1 = 1 + c0.x - c1.y - c2.z; // 4x²
+	float const t2 = 1 - c0.x + c1.y - c2.z; // 4y²
+	float const t3 = 1 - c0.x - c1.y + c2.z; // 4z²
+
+	// All four candidates and an index instead of branches, which mispredict for random rotations
+	float const t[4] = { t0, t1, t2, t3 };
+	quat const candidates[4] = {
+		quat(t0, c1.z - c2.y, c2.x - c0.z, c0.y - c1.x),
+		quat(c1.z - c2.y, t1, c0.y + c1.x, c2.x + c0.z),
+		quat(c2.x - c0.z, c0.y + c1.x, t2, c1.z + c2.y),
+		quat(c0.y - c1.x, c2.x + c0.z, c1.z + c2.y, t3),
+	};
+	unsigned k = t1 > t0 ? 1 : 0;
+	k = t2 > t[k] ? 2 : k;
+	k = t3 > t[k] ? 3 : k;
+	quat const& q = candidates[k];
+
+	float const scale = .5f / std::sqrt(t[k]);
+	return q * std::copysign(scale, q.w);
 }
 
+} // namespace detail
+
+/// Shepperd's method, see detail::rotation_to_quat(). m has to be a rotation (orthonormal with determinant 1).
+inline
+quat::quat(mat3 const& m) :
+	quat(detail::rotation_to_quat(m[0], m[1], m[2]))
+{}
+
 inline
 mat3 quat::to_mat3() const noexcept {
 	mat3 result;
@@ -9,8 +9,9 @@
 
 namespace stx {
 
-/// A 4x4 matrix. @ingroup stxmath
-class mat4 {
+/// A 4x4 matrix, the float specialization of mat<4, 4, T> aliased as mat4. @ingroup stxmath
+template<>
+class mat<4, 4, float> {
 public:
 	union {
 		float data[16];
@@ -18,7 +19,7 @@ public:
 	};
 
 	constexpr explicit
-	mat4(const mat3& m3) :
+	mat(const mat3& m3) :
 		mat4(
 			m3.data[0], m3.data[3], m3.data[6], 0,
 			m3.data[1], m3.data[4], m3.data[7], 0,
@@ -28,7 +29,7 @@ public:
 	{}
 
 	constexpr explicit
-	mat4(float scale = 1.f) :
+	mat(float scale = 1.f) :
 		mat4(
 			scale,     0,     0,     0,
 			    0, scale,     0,     0,
@@ -38,7 +39,7 @@ public:
 	{}
 
 	constexpr explicit
-	mat4(const vec4& scale) :
+	mat(const vec4& scale) :
 		mat4(
 			scale.x,       0,       0,       0,
 				  0, scale.y,       0,       0,
@@ -48,12 +49,12 @@ public:
 	{}
 
 	constexpr
-	mat4(const vec4& a, const vec4& b, const vec4& c, const vec4& d) :
+	mat(const vec4& a, const vec4& b, const vec4& c, const vec4& d) :
 		vectors{ a, b, c, d }
 	{}
 
 	constexpr
-	mat4(
+	mat(
 		float aa, float ab, float ac, float ad,
 		float ba, float bb, float bc, float bd,
 		float ca, float cb, float cc, float cd,
@@ -64,7 +65,17 @@ public:
 			ac, bc, cc, dc,
 			ad, bd, cd, dd
 		}
-	{}
+	{
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+		// Whole columns in registers, like vec4's constructor, so the SIMD kernels don't stall on loading them
+		if(!STX_MATH_CONSTANT_EVALUATED()) {
+			vectors[0] = vec4(aa, ba, ca, da);
+			vectors[1] = vec4(ab, bb, cb, db);
+			vectors[2] = vec4(ac, bc, cc, dc);
+			vectors[3] = vec4(ad, bd, cd, dd);
+		}
+#endif
+	}
 
 	constexpr operator const float*() const noexcept { return data; }
 	constexpr operator       float*()       noexcept { return data; }
@@ -74,12 +85,12 @@ public:
 	template<typename Idx>
 	constexpr inline       vec4& operator[](Idx idx)       noexcept { return vectors[idx]; }
 
-	constexpr
+	STX_SIMD_CONSTEXPR
 	mat4 scale(const vec3& scale) const noexcept {
 		return (*this) * scaling(scale);
 	}
 
-	constexpr
+	STX_SIMD_CONSTEXPR
 	mat4 translate(const vec3& off) const noexcept {
 		return (*this) * translation(off);
 	}
@@ -95,21 +106,247 @@ public:
 		return copy;
 	}
 
+	float determinant() const noexcept {
+		float const* a = data;
+
+		float const s0 = a[0] * a[5] - a[4] * a[1];
+		float const s1 = a[0] * a[6] - a[4] * a[2];
+		float const s2 = a[0] * a[7] - a[4] * a[3];
+		float const s3 = a[1] * a[6] - a[5] * a[2];
+		float const s4 = a[1] * a[7] - a[5] * a[3];
+		float const s5 = a[2] * a[7] - a[6] * a[3];
+
+		float const c5 = a[10] * a[15] - a[14] * a[11];
+		float const c4 = a[ 9] * a[15] - a[13] * a[11];
+		float const c3 = a[ 9] * a[14] - a[13] * a[10];
+		float const c2 = a[ 8] * a[15] - a[12] * a[11];
+		float const c1 = a[ 8] * a[14] - a[12] * a[10];
+		float const c0 = a[ 8] * a[13] - a[12] * a[ 9];
+
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
+
+	/// The general inverse. The result is undefined (inf/nan) for singular matrices.
+	/// Prefer inverse_affine() or inverse_rigid() for matrices built by transform().
+	mat4 inverse() const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		// Blockwise inversion over the 2x2 sub matrices A B / C D, each held in one register.
+		// Works on columns just as on rows since inverse(transpose(M)) == transpose(inverse(M)).
+		using simd::float4;
+		using simd::shuffle;
+
+		// 2x2 matrix products, adj() is the adjugate
+		auto mul     = [](float4 a, float4 b) { return a * shuffle<0, 3, 0, 3>(b) + shuffle<1, 0, 3, 2>(a) * shuffle<2, 1, 2, 1>(b); };
+		auto adj_mul = [](float4 a, float4 b) { return shuffle<3, 3, 0, 0>(a) * b - shuffle<1, 1, 2, 2>(a) * shuffle<2, 3, 0, 1>(b); };
+		auto mul_adj = [](float4 a, float4 b) { return a * shuffle<3, 0, 3, 0>(b) - shuffle<1, 0, 3, 2>(a) * shuffle<2, 1, 2, 1>(b); };
+
+		float4 const c0 = vectors[0].to_simd();
+		float4 const c1 = vectors[1].to_simd();
+		float4 const c2 = vectors[2].to_simd();
+		float4 const c3 = vectors[3].to_simd();
+
+		float4 const A = shuffle<0, 1, 0, 1>(c0, c1);
+		float4 const B = shuffle<2, 3, 2, 3>(c0, c1);
+		float4 const C = shuffle<0, 1, 0, 1>(c2, c3);
+		float4 const D = shuffle<2, 3, 2, 3>(c2, c3);
+
+		// (|A|, |B|, |C|, |D|)
+		float4 const det_sub =
+			shuffle<0, 2, 0, 2>(c0, c2) * shuffle<1, 3, 1, 3>(c1, c3) -
+			shuffle<1, 3, 1, 3>(c0, c2) * shuffle<0, 2, 0, 2>(c1, c3);
+		float4 const det_A = simd::splat<0>(det_sub);
+		float4 const det_B = simd::splat<1>(det_sub);
+		float4 const det_C = simd::splat<2>(det_sub);
+		float4 const det_D = simd::splat<3>(det_sub);
+
+		float4 const D_C = adj_mul(D, C);
+		float4 const A_B = adj_mul(A, B);
+
+		float4 X = det_D * A - mul(B, D_C);
+		float4 W = det_A * D - mul(C, A_B);
+		float4 Y = det_B * C - mul_adj(D, A_B);
+		float4 Z = det_C * B - mul_adj(A, D_C);
+
+		float4 const det = det_A * det_D + det_B * det_C - simd::hsum(A_B * shuffle<0, 2, 1, 3>(D_C));
+		float4 const inverse_det = float4(1.f, -1.f, -1.f, 1.f) / det;
+
+		X *= inverse_det;
+		Y *= inverse_det;
+		Z *= inverse_det;
+		W *= inverse_det;
+
+		mat4 result;
+		result.vectors[0] = vec4(shuffle<3, 1, 3, 1>(X, Y));
+		result.vectors[1] = vec4(shuffle<2, 0, 2, 0>(X, Y));
+		result.vectors[2] = vec4(shuffle<3, 1, 3, 1>(Z, W));
+		result.vectors[3] = vec4(shuffle<2, 0, 2, 0>(Z, W));
+		return result;
+#else
+		// Cofactors from 2x2 sub determinants, layout agnostic for the same reason as above
+		float const* a = data;
+
+		float const s0 = a[0] * a[5] - a[4] * a[1];
+		float const s1 = a[0] * a[6] - a[4] * a[2];
+		float const s2 = a[0] * a[7] - a[4] * a[3];
+		float const s3 = a[1] * a[6] - a[5] * a[2];
+		float const s4 = a[1] * a[7] - a[5] * a[3];
+		float const s5 = a[2] * a[7] - a[6] * a[3];
+
+		float const c5 = a[10] * a[15] - a[14] * a[11];
+		float const c4 = a[ 9] * a[15] - a[13] * a[11];
+		float const c3 = a[ 9] * a[14] - a[13] * a[10];
+		float const c2 = a[ 8] * a[15] - a[12] * a[11];
+		float const c1 = a[ 8] * a[14] - a[12] * a[10];
+		float const c0 = a[ 8] * a[13] - a[12] * a[ 9];
+
+		float const inverse_det = 1 / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+		mat4 result;
+		float* b = result.data;
+		b[ 0] = ( a[ 5] * c5 - a[ 6] * c4 + a[ 7] * c3) * inverse_det;
+		b[ 1] = (-a[ 1] * c5 + a[ 2] * c4 - a[ 3] * c3) * inverse_det;
+		b[ 2] = ( a[13] * s5 - a[14] * s4 + a[15] * s3) * inverse_det;
+		b[ 3] = (-a[ 9] * s5 + a[10] * s4 - a[11] * s3) * inverse_det;
+		b[ 4] = (-a[ 4] * c5 + a[ 6] * c2 - a[ 7] * c1) * inverse_det;
+		b[ 5] = ( a[ 0] * c5 - a[ 2] * c2 + a[ 3] * c1) * inverse_det;
+		b[ 6] = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inverse_det;
+		b[ 7] = ( a[ 8] * s5 - a[10] * s2 + a[11] * s1) * inverse_det;
+		b[ 8] = ( a[ 4] * c4 - a[ 5] * c2 + a[ 7] * c0) * inverse_det;
+		b[ 9] = (-a[ 0] * c4 + a[ 1] * c2 - a[ 3] * c0) * inverse_det;
+		b[10] = ( a[12] * s4 - a[13] * s2 + a[15] * s0) * inverse_det;
+		b[11] = (-a[ 8] * s4 + a[ 9] * s2 - a[11] * s0) * inverse_det;
+		b[12] = (-a[ 4] * c3 + a[ 5] * c1 - a[ 6] * c0) * inverse_det;
+		b[13] = ( a[ 0] * c3 - a[ 1] * c1 + a[ 2] * c0) * inverse_det;
+		b[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inverse_det;
+		b[15] = ( a[ 8] * s3 - a[ 9] * s1 + a[10] * s0) * inverse_det;
+		return result;
+#endif
+	}
+
+	/// The inverse of an affine matrix (last row 0, 0, 0, 1) like the ones transform() creates.
+	/// Only inverts the upper 3x3 part and the translation.
+	mat4 inverse_affine() const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		using simd::float4;
+
+		auto cross = [](float4 a, float4 b) {
+			return
+				simd::shuffle<1, 2, 0, 3>(a) * simd::shuffle<2, 0, 1, 3>(b) -
+				simd::shuffle<2, 0, 1, 3>(a) * simd::shuffle<1, 2, 0, 3>(b);
+		};
+
+		float4 const c0 = vectors[0].to_simd();
+		float4 const c1 = vectors[1].to_simd();
+		float4 const c2 = vectors[2].to_simd();
+
+		// Rows of the inverse 3x3 part
+		float4 r0 = cross(c1, c2);
+		float4 r1 = cross(c2, c0);
+		float4 r2 = cross(c0, c1);
+		float4 r3 = float4::zero();
+
+		float4 const inverse_det = float4(1.f) / simd::dot4(c0, r0);
+		r0 *= inverse_det;
+		r1 *= inverse_det;
+		r2 *= inverse_det;
+		simd::transpose(r0, r1, r2, r3);
+
+		float4 const t = vectors[3].to_simd();
+		float4 const inv_t = float4(0.f, 0.f, 0.f, 1.f) - (r0 * simd::splat<0>(t) + r1 * simd::splat<1>(t) + r2 * simd::splat<2>(t));
+		return mat4(vec4(r0), vec4(r1), vec4(r2), vec4(inv_t));
+#else
+		mat3 const inverse3 = mat3(
+			vec3(vectors[0].x, vectors[0].y, vectors[0].z),
+			vec3(vectors[1].x, vectors[1].y, vectors[1].z),
+			vec3(vectors[2].x, vectors[2].y, vectors[2].z)
+		).inverse();
+		vec3 const t = -(inverse3 * translation());
+
+		return mat4(
+			vec4(inverse3[0].x, inverse3[0].y, inverse3[0].z, 0),
+			vec4(inverse3[1].x, inverse3[1].y, inverse3[1].z, 0),
+			vec4(inverse3[2].x, inverse3[2].y, inverse3[2].z, 0),
+			vec4(t.x, t.y, t.z, 1)
+		);
+#endif
+	}
+
+	/// The inverse of a rotation and translation without scale, i.e. transform() with the default scale.
+	/// The rotation part is simply transposed.
+	mat4 inverse_rigid() const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		using simd::float4;
+
+		float4 r0 = vectors[0].to_simd();
+		float4 r1 = vectors[1].to_simd();
+		float4 r2 = vectors[2].to_simd();
+		float4 r3 = float4::zero();
+		simd::transpose(r0, r1, r2, r3);
+
+		float4 const t = vectors[3].to_simd();
+		float4 const inv_t = float4(0.f, 0.f, 0.f, 1.f) - (r0 * simd::splat<0>(t) + r1 * simd::splat<1>(t) + r2 * simd::splat<2>(t));
+		return mat4(vec4(r0), vec4(r1), vec4(r2), vec4(inv_t));
+#else
+		vec3 const t = translation();
+		vec3 const c0(vectors[0].x, vectors[0].y, vectors[0].z);
+		vec3 const c1(vectors[1].x, vectors[1].y, vectors[1].z);
+		vec3 const c2(vectors[2].x, vectors[2].y, vectors[2].z);
+
+		return mat4(
+			c0.x, c0.y, c0.z, -c0.dot(t),
+			c1.x, c1.y, c1.z, -c1.dot(t),
+			c2.x, c2.y, c2.z, -c2.dot(t),
+			   0,    0,    0,          1
+		);
+#endif
+	}
+
 	mat4 rotate(quat const& q) const noexcept {
 		return (*this) * rotation(q);
 	}
 
-	constexpr
+	/// Matrix product. With STX_MATH_SIMD this and the mat4 * vec4 product below run as SSE/AVX/NEON kernels.
+	/// Without FMA the kernels multiply and sum in the same order as the scalar code and the results are bit identical.
+	/// With FMA (STX_MATH_FMA) every multiply-add rounds once instead of twice, each component then differs from
+	/// the scalar result by at most 4 * FLT_EPSILON * sum(|a_ik * b_kj|), a few ulp of the largest product.
+	STX_SIMD_CONSTEXPR
 	mat4 operator*(const mat4& other) const noexcept {
+#if defined(STX_MATH_AVX)
+		// Two columns of the result per iteration: this matrix' columns broadcast to both 128 bit halves,
+		// the in-lane shuffles broadcast the components of two columns of other at once.
+		__m256 const c0 = _mm256_broadcast_ps(&vectors[0].packed);
+		__m256 const c1 = _mm256_broadcast_ps(&vectors[1].packed);
+		__m256 const c2 = _mm256_broadcast_ps(&vectors[2].packed);
+		__m256 const c3 = _mm256_broadcast_ps(&vectors[3].packed);
+
+		mat4 result;
+		for(size_t i = 0; i < 16; i += 8) {
+			__m256 const b = _mm256_loadu_ps(other.data + i);
+#if defined(STX_MATH_FMA)
+			__m256 r = _mm256_mul_ps(c0, _mm256_shuffle_ps(b, b, 0x00));
+			r = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(b, b, 0x55), r);
+			r = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(b, b, 0xAA), r);
+			r = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(b, b, 0xFF), r);
+#else
+			__m256 r = _mm256_mul_ps(c0, _mm256_shuffle_ps(b, b, 0x00));
+			r = _mm256_add_ps(_mm256_mul_ps(c1, _mm256_shuffle_ps(b, b, 0x55)), r);
+			r = _mm256_add_ps(_mm256_mul_ps(c2, _mm256_shuffle_ps(b, b, 0xAA)), r);
+			r = _mm256_add_ps(_mm256_mul_ps(c3, _mm256_shuffle_ps(b, b, 0xFF)), r);
+#endif
+			_mm256_storeu_ps(result.data + i, r);
+		}
+		return result;
+#else
 		return mat4(
 			*this * other[0],
 			*this * other[1],
 			*this * other[2],
 			*this * other[3]
 		);
+#endif
 	}
 
-	constexpr
+	STX_SIMD_CONSTEXPR
 	mat4 operator*(const mat3& other) const noexcept {
 		return (*this) * mat4(other);
 	}
@@ -123,14 +360,23 @@ public:
 		);
 	}
 
-	constexpr
+	STX_SIMD_CONSTEXPR
 	vec4 operator*(const vec4& v) const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		simd::float4 const f = v.to_simd();
+		simd::float4 r = vectors[0].to_simd() * simd::splat<0>(f);
+		r = simd::madd(vectors[1].to_simd(), simd::splat<1>(f), r);
+		r = simd::madd(vectors[2].to_simd(), simd::splat<2>(f), r);
+		r = simd::madd(vectors[3].to_simd(), simd::splat<3>(f), r);
+		return vec4(r);
+#else
 		return vec4(
 			v.x * vectors[0][0] + v.y * vectors[1][0] + v.z * vectors[2][0] + v.w * vectors[3][0],
 			v.x * vectors[0][1] + v.y * vectors[1][1] + v.z * vectors[2][1] + v.w * vectors[3][1],
 			v.x * vectors[0][2] + v.y * vectors[1][2] + v.z * vectors[2][2] + v.w * vectors[3][2],
 			v.x * vectors[0][3] + v.y * vectors[1][3] + v.z * vectors[2][3] + v.w * vectors[3][3]
 		);
+#endif
 	}
 
 	static
@@ -140,11 +386,12 @@ public:
 
 	constexpr static
 	mat4 translation(vec3 const& v) noexcept {
-		mat4 result;
-		result[3].x = v.x;
-		result[3].y = v.y;
-		result[3].z = v.z;
-		return result;
+		return mat4(
+			1, 0, 0, v.x,
+			0, 1, 0, v.y,
+			0, 0, 1, v.z,
+			0, 0, 0, 1
+		);
 	}
 
 	constexpr
@@ -152,22 +399,25 @@ public:
 		return vec3(vectors[3][0], vectors[3][1], vectors[3][2]);
 	}
 
+	/// translation * scale * rotation: rotates, then scales along the parent's axes, then translates.
+	/// trs, affine3::compose() and transform_hierarchy use translation * rotation * scale instead,
+	/// the two only differ for non uniform scales.
 	static
 	mat4 transform(quat const& rotation, vec3 const& translation, vec3 const& scale = vec3(1)) {
-		mat4 result = mat4(mat3(scale) * rotation.to_mat3());
-		result[3].x = translation.x;
-		result[3].y = translation.y;
-		result[3].z = translation.z;
-		return result;
+		// Whole columns instead of patching the translation into mat4(mat3) element by element,
+		// scale * rotation scales the rows of the rotation
+		mat3 const r = rotation.to_mat3();
+		return mat4(
+			vec4(r[0].x * scale.x, r[0].y * scale.y, r[0].z * scale.z, 0),
+			vec4(r[1].x * scale.x, r[1].y * scale.y, r[1].z * scale.z, 0),
+			vec4(r[2].x * scale.x, r[2].y * scale.y, r[2].z * scale.z, 0),
+			vec4(translation.x, translation.y, translation.z, 1)
+		);
 	}
 
 	constexpr static
 	mat4 scaling(vec3 const& v) noexcept {
-		mat4 result;
-		result[0][0] = v.x;
-		result[1][1] = v.y;
-		result[2][2] = v.z;
-		return result;
+		return mat4(vec4(v.x, v.y, v.z, 1));
 	}
 
 	constexpr static
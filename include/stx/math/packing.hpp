@@ -0,0 +1,622 @@
+#pragma once
+
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "quat.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* Compact encodings for network snapshots and vertex buffers.
+ * Every type packs one value through its constructor and unpacks it with unpack(),
+ * pack_batch() / unpack_batch() convert whole arrays four values at a time with simd::float4.
+ * The batch functions give the same results as the single value ones up to float rounding
+ * (the last bit of a quantized value can differ where FMA contraction changes an intermediate).
+ * The documented error bounds are per component, for inputs in the encoding's range.
+ */
+
+namespace stx {
+
+// -- Half floats ---------------------------------------------------------------------------
+
+/// Converts to an IEEE 754 binary16 half float, rounding to nearest even. @ingroup stxmath
+/// Relative error at most 2^-11 (4.9e-4) for |f| in [6.1e-5, 65504], absolute error at most 2^-25 below that.
+/// Larger values become inf, nan stays nan.
+inline
+uint16_t float_to_half(float f) noexcept {
+	uint32_t u;
+	std::memcpy(&u, &f, 4);
+	uint16_t const sign = (uint16_t) ((u >> 16) & 0x8000u);
+	u &= 0x7FFFFFFFu;
+
+	uint16_t result;
+	if(u >= (127u + 16u) << 23) {
+		result = u > 0x7F800000u ? 0x7E00 : 0x7C00; // nan or overflow to inf
+	}
+	else if(u < 113u << 23) {
+		// Subnormal or zero: adding 0.5 aligns the mantissa so the float adder does the rounding
+		float const magic = 0.5f;
+		float g;
+		std::memcpy(&g, &u, 4);
+		g += magic;
+		uint32_t v;
+		std::memcpy(&v, &g, 4);
+		result = (uint16_t) (v - 0x3F000000u);
+	}
+	else {
+		// Rebias the exponent and round the 13 dropped mantissa bits to nearest even
+		uint32_t const odd = (u >> 13) & 1;
+		u += ((uint32_t) (15 - 127) << 23) + 0xFFF + odd;
+		result = (uint16_t) (u >> 13);
+	}
+	return result | sign;
+}
+
+/// Converts an IEEE 754 binary16 half float to float, exactly. @ingroup stxmath
+inline
+float half_to_float(uint16_t h) noexcept {
+	uint32_t u = (uint32_t) (h & 0x7FFF) << 13;
+	uint32_t const exponent = u & (0x7C00u << 13);
+	u += (uint32_t) (127 - 15) << 23;
+
+	float f;
+	if(exponent == 0x7C00u << 13) {
+		u += (uint32_t) (128 - 16) << 23; // inf, nan
+		std::memcpy(&f, &u, 4);
+	}
+	else if(exponent == 0) {
+		// Subnormal or zero: renormalize through the float unit
+		u += 1u << 23;
+		std::memcpy(&f, &u, 4);
+		f -= 6.103515625e-05f; // 2^-14
+	}
+	else {
+		std::memcpy(&f, &u, 4);
+	}
+	return (h & 0x8000) ? -f : f;
+}
+
+/// A vec2 as two half floats (4 bytes). Error see float_to_half(). @ingroup stxmath
+struct half2 {
+	uint16_t v[2];
+
+	half2() = default;
+	explicit half2(vec2 const& f) noexcept : v{ float_to_half(f.x), float_to_half(f.y) } {}
+
+	vec2 unpack() const noexcept { return vec2(half_to_float(v[0]), half_to_float(v[1])); }
+};
+
+/// A vec3 as three half floats (6 bytes). Error see float_to_half(). @ingroup stxmath
+struct half3 {
+	uint16_t v[3];
+
+	half3() = default;
+	explicit half3(vec3 const& f) noexcept : v{ float_to_half(f.x), float_to_half(f.y), float_to_half(f.z) } {}
+
+	vec3 unpack() const noexcept { return vec3(half_to_float(v[0]), half_to_float(v[1]), half_to_float(v[2])); }
+};
+
+/// A vec4 as four half floats (8 bytes). Error see float_to_half(). @ingroup stxmath
+struct half4 {
+	uint16_t v[4];
+
+	half4() = default;
+	explicit half4(vec4 const& f) noexcept : v{ float_to_half(f.x), float_to_half(f.y), float_to_half(f.z), float_to_half(f.w) } {}
+
+	vec4 unpack() const noexcept { return vec4(half_to_float(v[0]), half_to_float(v[1]), half_to_float(v[2]), half_to_float(v[3])); }
+};
+
+// -- Normalized integers -------------------------------------------------------------------
+
+namespace detail {
+
+inline float clamp_unit(float f, float lo) noexcept { return f < lo ? lo : (f > 1.f ? 1.f : f); }
+
+inline int16_t to_snorm16(float f) noexcept { return (int16_t) std::nearbyint(clamp_unit(f, -1.f) * 32767.f); }
+inline float from_snorm16(int16_t i) noexcept { float const f = i * (1.f / 32767.f); return f < -1.f ? -1.f : f; }
+
+inline uint8_t to_unorm8(float f) noexcept { return (uint8_t) std::nearbyint(clamp_unit(f, 0.f) * 255.f); }
+inline float from_unorm8(uint8_t i) noexcept { return i * (1.f / 255.f); }
+
+} // namespace detail
+
+/// A vec3 in [-1, 1] as three 16 bit signed normalized integers (6 bytes). @ingroup stxmath
+/// Error at most 1 / 65534 (1.53e-5), values outside [-1, 1] are clamped.
+struct snorm16x3 {
+	int16_t v[3];
+
+	snorm16x3() = default;
+	explicit snorm16x3(vec3 const& f) noexcept : v{ detail::to_snorm16(f.x), detail::to_snorm16(f.y), detail::to_snorm16(f.z) } {}
+
+	vec3 unpack() const noexcept { return vec3(detail::from_snorm16(v[0]), detail::from_snorm16(v[1]), detail::from_snorm16(v[2])); }
+};
+
+/// A vec4 in [-1, 1] as four 16 bit signed normalized integers (8 bytes), e.g. tangents with handedness. @ingroup stxmath
+/// Error at most 1 / 65534 (1.53e-5), values outside [-1, 1] are clamped.
+struct snorm16x4 {
+	int16_t v[4];
+
+	snorm16x4() = default;
+	explicit snorm16x4(vec4 const& f) noexcept :
+		v{ detail::to_snorm16(f.x), detail::to_snorm16(f.y), detail::to_snorm16(f.z), detail::to_snorm16(f.w) }
+	{}
+
+	vec4 unpack() const noexcept {
+		return vec4(detail::from_snorm16(v[0]), detail::from_snorm16(v[1]), detail::from_snorm16(v[2]), detail::from_snorm16(v[3]));
+	}
+};
+
+/// A vec4 in [0, 1] as four 8 bit unsigned normalized integers (4 bytes), e.g. an rgba color. @ingroup stxmath
+/// Error at most 1 / 510 (1.96e-3), values outside [0, 1] are clamped.
+struct unorm8x4 {
+	uint8_t v[4];
+
+	unorm8x4() = default;
+	explicit unorm8x4(vec4 const& f) noexcept :
+		v{ detail::to_unorm8(f.x), detail::to_unorm8(f.y), detail::to_unorm8(f.z), detail::to_unorm8(f.w) }
+	{}
+
+	vec4 unpack() const noexcept {
+		return vec4(detail::from_unorm8(v[0]), detail::from_unorm8(v[1]), detail::from_unorm8(v[2]), detail::from_unorm8(v[3]));
+	}
+};
+
+// -- Octahedral normals --------------------------------------------------------------------
+
+namespace detail {
+
+/// Projects a unit vector onto the octahedron and unfolds the lower half, the result is in [-1, 1]^2
+inline vec2 oct_encode(vec3 const& n) noexcept {
+	float const inv = 1.f / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+	float const u = n.x * inv;
+	float const v = n.y * inv;
+	if(n.z >= 0) return vec2(u, v);
+	return vec2(
+		(1.f - std::abs(v)) * (u >= 0 ? 1.f : -1.f),
+		(1.f - std::abs(u)) * (v >= 0 ? 1.f : -1.f)
+	);
+}
+
+inline vec3 oct_decode(float u, float v) noexcept {
+	float const z = 1.f - std::abs(u) - std::abs(v);
+	float const t = z < 0 ? -z : 0.f;
+	float const x = u >= 0 ? u - t : u + t;
+	float const y = v >= 0 ? v - t : v + t;
+	float const inv = 1.f / std::sqrt(x * x + y * y + z * z);
+	return vec3(x * inv, y * inv, z * inv);
+}
+
+} // namespace detail
+
+/// A unit vec3 (e.g. a normal) octahedral encoded in two 8 bit signed normalized integers (2 bytes). @ingroup stxmath
+/// The decoded vector is unit length and within 0.017 radians (about 1 degree) of the original.
+struct oct16 {
+	int8_t x, y;
+
+	oct16() = default;
+	explicit oct16(vec3 const& unit) noexcept {
+		vec2 const p = detail::oct_encode(unit);
+		x = (int8_t) std::nearbyint(detail::clamp_unit(p.x, -1.f) * 127.f);
+		y = (int8_t) std::nearbyint(detail::clamp_unit(p.y, -1.f) * 127.f);
+	}
+
+	vec3 unpack() const noexcept { return detail::oct_decode(x * (1.f / 127.f), y * (1.f / 127.f)); }
+};
+
+/// A unit vec3 (e.g. a normal) octahedral encoded in two 16 bit signed normalized integers (4 bytes). @ingroup stxmath
+/// The decoded vector is unit length and within 6.5e-5 radians of the original.
+struct oct32 {
+	int16_t x, y;
+
+	oct32() = default;
+	explicit oct32(vec3 const& unit) noexcept {
+		vec2 const p = detail::oct_encode(unit);
+		x = (int16_t) std::nearbyint(detail::clamp_unit(p.x, -1.f) * 32767.f);
+		y = (int16_t) std::nearbyint(detail::clamp_unit(p.y, -1.f) * 32767.f);
+	}
+
+	vec3 unpack() const noexcept { return detail::oct_decode(x * (1.f / 32767.f), y * (1.f / 32767.f)); }
+};
+
+// -- Smallest three quaternions ------------------------------------------------------------
+
+namespace detail {
+
+/// Largest possible magnitude of the three smallest components of a unit quaternion, 1 / sqrt(2)
+constexpr float smallest_three_range = 0.70710678f;
+
+/// Splits a unit quaternion into the index of its largest component (w, x, y, z = 0..3) and the other three
+/// in order, with the sign flipped so the largest one is positive (q and -q are the same rotation)
+inline unsigned smallest_three(quat const& q, float* c) noexcept {
+	unsigned index = 0;
+	for(unsigned i = 1; i < 4; i++) {
+		if(std::abs(q.wxyz[i]) > std::abs(q.wxyz[index])) index = i;
+	}
+	float const sign = q.wxyz[index] < 0 ? -1.f : 1.f;
+	for(unsigned i = 0, k = 0; i < 4; i++) {
+		if(i != index) c[k++] = q.wxyz[i] * sign;
+	}
+	return index;
+}
+
+/// Inverse of smallest_three(), the largest component follows from the unit length
+inline quat smallest_three(unsigned index, float const* c) noexcept {
+	float const rest = 1.f - c[0] * c[0] - c[1] * c[1] - c[2] * c[2];
+	float const largest = rest > 0 ? std::sqrt(rest) : 0.f;
+	quat q;
+	for(unsigned i = 0, k = 0; i < 4; i++) {
+		q.wxyz[i] = i == index ? largest : c[k++];
+	}
+	return q;
+}
+
+template<unsigned Bits>
+inline uint32_t quantize_smallest(float c) noexcept {
+	constexpr float max   = float((1u << Bits) - 1);
+	constexpr float scale = max / (2 * smallest_three_range);
+	float const q = std::nearbyint((c + smallest_three_range) * scale);
+	return (uint32_t) (q < 0 ? 0 : (q > max ? max : q));
+}
+
+template<unsigned Bits>
+inline float dequantize_smallest(uint32_t q) noexcept {
+	constexpr float step = 2 * smallest_three_range / float((1u << Bits) - 1);
+	return q * step - smallest_three_range;
+}
+
+} // namespace detail
+
+/// A unit quaternion in 32 bits: the index of the largest component and the other three in 10 bits each. @ingroup stxmath
+/// The three stored components are within 6.9e-4 of the original, the reconstructed one within 2.1e-3.
+/// Unpacking may return -q, which is the same rotation.
+struct quat32 {
+	uint32_t bits;
+
+	quat32() = default;
+	explicit quat32(quat const& q) noexcept {
+		float c[3];
+		unsigned const index = detail::smallest_three(q, c);
+		bits =
+			index << 30 |
+			detail::quantize_smallest<10>(c[0]) << 20 |
+			detail::quantize_smallest<10>(c[1]) << 10 |
+			detail::quantize_smallest<10>(c[2]);
+	}
+
+	quat unpack() const noexcept {
+		float const c[3] = {
+			detail::dequantize_smallest<10>((bits >> 20) & 0x3FF),
+			detail::dequantize_smallest<10>((bits >> 10) & 0x3FF),
+			detail::dequantize_smallest<10>(bits & 0x3FF)
+		};
+		return detail::smallest_three(bits >> 30, c);
+	}
+};
+
+/// A unit quaternion in 48 bits: three components in 15 bits each, the index of the dropped largest one
+/// in the top bits of the first two. @ingroup stxmath
+/// The three stored components are within 2.2e-5 of the original, the reconstructed one within 6.5e-5.
+/// Unpacking may return -q, which is the same rotation.
+struct quat48 {
+	uint16_t v[3];
+
+	quat48() = default;
+	explicit quat48(quat const& q) noexcept {
+		float c[3];
+		unsigned const index = detail::smallest_three(q, c);
+		v[0] = (uint16_t) ((index & 2) << 14 | detail::quantize_smallest<15>(c[0]));
+		v[1] = (uint16_t) ((index & 1) << 15 | detail::quantize_smallest<15>(c[1]));
+		v[2] = (uint16_t) detail::quantize_smallest<15>(c[2]);
+	}
+
+	unsigned index() const noexcept { return (v[0] >> 15) << 1 | v[1] >> 15; }
+
+	quat unpack() const noexcept {
+		float const c[3] = {
+			detail::dequantize_smallest<15>(v[0] & 0x7FFF),
+			detail::dequantize_smallest<15>(v[1] & 0x7FFF),
+			detail::dequantize_smallest<15>(v[2])
+		};
+		return detail::smallest_three(index(), c);
+	}
+};
+
+// -- Batch kernels -------------------------------------------------------------------------
+
+namespace detail {
+
+inline void pack_snorm16(float const* in, int16_t* out, size_t n) noexcept {
+	using simd::float4;
+	size_t i = 0;
+	float4 const lo(-1.f), hi(1.f), scale(32767.f);
+	for(; i + 8 <= n; i += 8) {
+		simd::store_int16(
+			simd::min(simd::max(float4::load(in + i),     lo), hi) * scale,
+			simd::min(simd::max(float4::load(in + i + 4), lo), hi) * scale,
+			out + i
+		);
+	}
+	for(size_t const end = i + n % 8; i < end; i++) out[i] = to_snorm16(in[i]);
+}
+
+inline void unpack_snorm16(int16_t const* in, float* out, size_t n) noexcept {
+	using simd::float4;
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		int32_t const q[4] = { in[i], in[i + 1], in[i + 2], in[i + 3] };
+		simd::max(simd::load_int32(q) * float4(1.f / 32767.f), float4(-1.f)).store(out + i);
+	}
+	for(size_t const end = i + n % 4; i < end; i++) out[i] = from_snorm16(in[i]);
+}
+
+inline void pack_unorm8(float const* in, uint8_t* out, size_t n) noexcept {
+	using simd::float4;
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		int32_t q[4];
+		simd::store_int32(simd::min(simd::max(float4::load(in + i), float4(0.f)), float4(1.f)) * float4(255.f), q);
+		for(unsigned k = 0; k < 4; k++) out[i + k] = (uint8_t) q[k];
+	}
+	for(size_t const end = i + n % 4; i < end; i++) out[i] = to_unorm8(in[i]);
+}
+
+inline void unpack_unorm8(uint8_t const* in, float* out, size_t n) noexcept {
+	using simd::float4;
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		int32_t const q[4] = { in[i], in[i + 1], in[i + 2], in[i + 3] };
+		(simd::load_int32(q) * float4(1.f / 255.f)).store(out + i);
+	}
+	for(size_t const end = i + n % 4; i < end; i++) out[i] = from_unorm8(in[i]);
+}
+
+/// Uses the F16C (x86) or NEON (AArch64) conversion instructions when available
+inline void pack_half(float const* in, uint16_t* out, size_t n) noexcept {
+	size_t i = 0;
+#if defined(STX_MATH_F16C)
+	for(size_t const end = n - n % 4; i < end; i += 4) {
+		_mm_storel_epi64((__m128i*) (out + i), _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+	}
+#elif defined(STX_MATH_NEON) && defined(__aarch64__)
+	for(size_t const end = n - n % 4; i < end; i += 4) {
+		vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+	}
+#endif
+	for(; i < n; i++) out[i] = float_to_half(in[i]);
+}
+
+inline void unpack_half(uint16_t const* in, float* out, size_t n) noexcept {
+	size_t i = 0;
+#if defined(STX_MATH_F16C)
+	for(size_t const end = n - n % 4; i < end; i += 4) {
+		_mm_storeu_ps(out + i, _mm_cvtph_ps(_mm_loadl_epi64((__m128i const*) (in + i))));
+	}
+#elif defined(STX_MATH_NEON) && defined(__aarch64__)
+	for(size_t const end = n - n % 4; i < end; i += 4) {
+		vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+	}
+#endif
+	for(; i < n; i++) out[i] = half_to_float(in[i]);
+}
+
+/// Octahedral encoding of 4 normals given as x, y, z lanes, the results are scaled to [-max, max], rounded and stored as u0 v0 u1 v1 ...
+inline void pack_oct4(simd::float4 const& x, simd::float4 const& y, simd::float4 const& z, float max, int16_t* uv) noexcept {
+	using simd::float4;
+
+	float4 const inv = float4(1.f) / (simd::abs(x) + simd::abs(y) + simd::abs(z));
+	float4 pu = x * inv;
+	float4 pv = y * inv;
+
+	// Unfold the lower hemisphere, sign(p) with sign(0) = 1
+	float4 const one(1.f);
+	float4 const su = simd::select(pu >= float4::zero(), one, -one);
+	float4 const sv = simd::select(pv >= float4::zero(), one, -one);
+	float4 const lower = z < float4::zero();
+	float4 const fu = (one - simd::abs(pv)) * su;
+	float4 const fv = (one - simd::abs(pu)) * sv;
+	pu = simd::select(lower, fu, pu);
+	pv = simd::select(lower, fv, pv);
+
+	float4 const scale(max);
+	pu = simd::min(simd::max(pu, -one), one) * scale;
+	pv = simd::min(simd::max(pv, -one), one) * scale;
+	simd::store_int16(simd::unpacklo(pu, pv), simd::unpackhi(pu, pv), uv);
+}
+
+inline void unpack_oct4(int32_t const* u, int32_t const* v, float max, simd::float4& x, simd::float4& y, simd::float4& z) noexcept {
+	using simd::float4;
+
+	float4 const inv_max(1.f / max);
+	float4 const pu = simd::load_int32(u) * inv_max;
+	float4 const pv = simd::load_int32(v) * inv_max;
+
+	z = float4(1.f) - simd::abs(pu) - simd::abs(pv);
+	float4 const t = simd::max(-z, float4::zero());
+	x = simd::select(pu >= float4::zero(), pu - t, pu + t);
+	y = simd::select(pv >= float4::zero(), pv - t, pv + t);
+
+	float4 const inv = float4(1.f) / simd::sqrt(x * x + y * y + z * z);
+	x *= inv;
+	y *= inv;
+	z *= inv;
+}
+
+template<class Oct, class Int>
+inline void pack_oct(vec3 const* in, Oct* out, size_t n, float max) noexcept {
+	batch4(in, out, n, vec3(0, 0, 1), [max](vec3 const* src, Oct* dst) {
+		using simd::float4;
+		float4 x, y, z;
+		load_aos(src, x, y, z);
+		int16_t uv[8];
+		pack_oct4(x, y, z, max, uv);
+		Int packed[8]; // x, y pairs
+		for(unsigned k = 0; k < 8; k++) packed[k] = (Int) uv[k];
+		std::memcpy(dst, packed, sizeof(packed));
+	});
+}
+
+template<class Oct>
+inline void unpack_oct(Oct const* in, vec3* out, size_t n, float max) noexcept {
+	batch4(in, out, n, Oct(), [max](Oct const* src, vec3* dst) {
+		using simd::float4;
+		int32_t const u[4] = { src[0].x, src[1].x, src[2].x, src[3].x };
+		int32_t const v[4] = { src[0].y, src[1].y, src[2].y, src[3].y };
+		float4 x, y, z;
+		unpack_oct4(u, v, max, x, y, z);
+		store_aos(dst, x, y, z);
+	});
+}
+
+/// Smallest three encoding of 4 quaternions: the index of the largest component and the other three quantized to Bits
+template<unsigned Bits>
+inline void pack_smallest_three4(quat const* q, uint32_t* index, int32_t* a, int32_t* b, int32_t* c) noexcept {
+	using simd::float4;
+
+	float4 w = float4::load(q[0].wxyz);
+	float4 x = float4::load(q[1].wxyz);
+	float4 y = float4::load(q[2].wxyz);
+	float4 z = float4::load(q[3].wxyz);
+	simd::transpose(w, x, y, z);
+
+	// Index of the largest magnitude, the first one on ties like smallest_three()
+	float4 best = simd::abs(w), largest = w, idx = float4::zero();
+	float4 m = simd::abs(x) > best;
+	best = simd::select(m, simd::abs(x), best); largest = simd::select(m, x, largest); idx = simd::select(m, float4(1.f), idx);
+	m = simd::abs(y) > best;
+	best = simd::select(m, simd::abs(y), best); largest = simd::select(m, y, largest); idx = simd::select(m, float4(2.f), idx);
+	m = simd::abs(z) > best;
+	largest = simd::select(m, z, largest); idx = simd::select(m, float4(3.f), idx);
+
+	// The remaining three in order, signs flipped so the largest is positive
+	float4 const ca = simd::xorsign(simd::select(idx == float4(0.f), x, w), largest);
+	float4 const cb = simd::xorsign(simd::select(idx <= float4(1.f), y, x), largest);
+	float4 const cc = simd::xorsign(simd::select(idx <= float4(2.f), z, y), largest);
+
+	float4 const range(smallest_three_range);
+	float4 const max(float((1u << Bits) - 1));
+	float4 const scale = max / float4(2 * smallest_three_range);
+	float4 const zero = float4::zero();
+	simd::store_int32(simd::min(simd::max(simd::round((ca + range) * scale), zero), max), a);
+	simd::store_int32(simd::min(simd::max(simd::round((cb + range) * scale), zero), max), b);
+	simd::store_int32(simd::min(simd::max(simd::round((cc + range) * scale), zero), max), c);
+
+	int32_t i[4];
+	simd::store_int32(idx, i);
+	for(unsigned k = 0; k < 4; k++) index[k] = (uint32_t) i[k];
+}
+
+template<unsigned Bits>
+inline void unpack_smallest_three4(uint32_t const* index, int32_t const* a, int32_t const* b, int32_t const* c, quat* q) noexcept {
+	using simd::float4;
+
+	float4 const range(smallest_three_range);
+	float4 const step(2 * smallest_three_range / float((1u << Bits) - 1));
+	float4 const ca = simd::load_int32(a) * step - range;
+	float4 const cb = simd::load_int32(b) * step - range;
+	float4 const cc = simd::load_int32(c) * step - range;
+	float4 const largest = simd::sqrt(simd::max(float4::zero(), float4(1.f) - ca * ca - cb * cb - cc * cc));
+
+	int32_t const i[4] = { (int32_t) index[0], (int32_t) index[1], (int32_t) index[2], (int32_t) index[3] };
+	float4 const idx = simd::load_int32(i);
+
+	float4 w = simd::select(idx == float4(0.f), largest, ca);
+	float4 x = simd::select(idx == float4(1.f), largest, simd::select(idx == float4(0.f), ca, cb));
+	float4 y = simd::select(idx == float4(2.f), largest, simd::select(idx <= float4(1.f), cb, cc));
+	float4 z = simd::select(idx == float4(3.f), largest, cc);
+	simd::transpose(w, x, y, z);
+
+	w.store(q[0].wxyz);
+	x.store(q[1].wxyz);
+	y.store(q[2].wxyz);
+	z.store(q[3].wxyz);
+}
+
+} // namespace detail
+
+/// Packs n values, see the encoding types for their error bounds. in and out may not overlap. @ingroup stxmath
+inline void pack_batch(vec2 const* in, half2* out, size_t n) noexcept { detail::pack_half(reinterpret_cast<float const*>(in), reinterpret_cast<uint16_t*>(out), n * 2); }
+inline void pack_batch(vec3 const* in, half3* out, size_t n) noexcept { detail::pack_half(reinterpret_cast<float const*>(in), reinterpret_cast<uint16_t*>(out), n * 3); }
+inline void pack_batch(vec4 const* in, half4* out, size_t n) noexcept { detail::pack_half(reinterpret_cast<float const*>(in), reinterpret_cast<uint16_t*>(out), n * 4); }
+
+inline void pack_batch(vec3 const* in, snorm16x3* out, size_t n) noexcept { detail::pack_snorm16(reinterpret_cast<float const*>(in), reinterpret_cast<int16_t*>(out), n * 3); }
+inline void pack_batch(vec4 const* in, snorm16x4* out, size_t n) noexcept { detail::pack_snorm16(reinterpret_cast<float const*>(in), reinterpret_cast<int16_t*>(out), n * 4); }
+inline void pack_batch(vec4 const* in, unorm8x4* out, size_t n)  noexcept { detail::pack_unorm8(reinterpret_cast<float const*>(in), reinterpret_cast<uint8_t*>(out), n * 4); }
+
+inline void pack_batch(vec3 const* in, oct16* out, size_t n) noexcept { detail::pack_oct<oct16, int8_t>(in, out, n, 127.f); }
+inline void pack_batch(vec3 const* in, oct32* out, size_t n) noexcept { detail::pack_oct<oct32, int16_t>(in, out, n, 32767.f); }
+
+inline
+void pack_batch(quat const* in, quat32* out, size_t n) noexcept {
+	detail::batch4(in, out, n, quat(), [](quat const* src, quat32* dst) {
+		uint32_t index[4];
+		int32_t a[4], b[4], c[4];
+		detail::pack_smallest_three4<10>(src, index, a, b, c);
+		for(unsigned k = 0; k < 4; k++) {
+			dst[k].bits = index[k] << 30 | (uint32_t) a[k] << 20 | (uint32_t) b[k] << 10 | (uint32_t) c[k];
+		}
+	});
+}
+
+inline
+void pack_batch(quat const* in, quat48* out, size_t n) noexcept {
+	detail::batch4(in, out, n, quat(), [](quat const* src, quat48* dst) {
+		uint32_t index[4];
+		int32_t a[4], b[4], c[4];
+		detail::pack_smallest_three4<15>(src, index, a, b, c);
+		for(unsigned k = 0; k < 4; k++) {
+			dst[k].v[0] = (uint16_t) ((index[k] & 2) << 14 | (uint32_t) a[k]);
+			dst[k].v[1] = (uint16_t) ((index[k] & 1) << 15 | (uint32_t) b[k]);
+			dst[k].v[2] = (uint16_t) c[k];
+		}
+	});
+}
+
+/// Unpacks n values. in and out may not overlap. @ingroup stxmath
+inline void unpack_batch(half2 const* in, vec2* out, size_t n) noexcept { detail::unpack_half(reinterpret_cast<uint16_t const*>(in), reinterpret_cast<float*>(out), n * 2); }
+inline void unpack_batch(half3 const* in, vec3* out, size_t n) noexcept { detail::unpack_half(reinterpret_cast<uint16_t const*>(in), reinterpret_cast<float*>(out), n * 3); }
+inline void unpack_batch(half4 const* in, vec4* out, size_t n) noexcept { detail::unpack_half(reinterpret_cast<uint16_t const*>(in), reinterpret_cast<float*>(out), n * 4); }
+
+inline void unpack_batch(snorm16x3 const* in, vec3* out, size_t n) noexcept { detail::unpack_snorm16(reinterpret_cast<int16_t const*>(in), reinterpret_cast<float*>(out), n * 3); }
+inline void unpack_batch(snorm16x4 const* in, vec4* out, size_t n) noexcept { detail::unpack_snorm16(reinterpret_cast<int16_t const*>(in), reinterpret_cast<float*>(out), n * 4); }
+inline void unpack_batch(unorm8x4 const* in, vec4* out, size_t n)  noexcept { detail::unpack_unorm8(reinterpret_cast<uint8_t const*>(in), reinterpret_cast<float*>(out), n * 4); }
+
+inline void unpack_batch(oct16 const* in, vec3* out, size_t n) noexcept { detail::unpack_oct(in, out, n, 127.f); }
+inline void unpack_batch(oct32 const* in, vec3* out, size_t n) noexcept { detail::unpack_oct(in, out, n, 32767.f); }
+
+inline
+void unpack_batch(quat32 const* in, quat* out, size_t n) noexcept {
+	detail::batch4(in, out, n, quat32(quat()), [](quat32 const* src, quat* dst) {
+		uint32_t index[4];
+		int32_t a[4], b[4], c[4];
+		for(unsigned k = 0; k < 4; k++) {
+			index[k] = src[k].bits >> 30;
+			a[k] = (int32_t) (src[k].bits >> 20 & 0x3FF);
+			b[k] = (int32_t) (src[k].bits >> 10 & 0x3FF);
+			c[k] = (int32_t) (src[k].bits & 0x3FF);
+		}
+		detail::unpack_smallest_three4<10>(index, a, b, c, dst);
+	});
+}
+
+inline
+void unpack_batch(quat48 const* in, quat* out, size_t n) noexcept {
+	detail::batch4(in, out, n, quat48(quat()), [](quat48 const* src, quat* dst) {
+		uint32_t index[4];
+		int32_t a[4], b[4], c[4];
+		for(unsigned k = 0; k < 4; k++) {
+			index[k] = src[k].index();
+			a[k] = src[k].v[0] & 0x7FFF;
+			b[k] = src[k].v[1] & 0x7FFF;
+			c[k] = src[k].v[2];
+		}
+		detail::unpack_smallest_three4<15>(index, a, b, c, dst);
+	});
+}
+
+} // namespace stx
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stx {
+
+/// Number of threads the parallel helpers split work into by default @ingroup stxmath
+inline
+unsigned thread_count() noexcept {
+	unsigned const n = std::thread::hardware_concurrency();
+	return n ? n : 1;
+}
+
+namespace detail {
+
+/// The chunks of one parallel_for() call. Threads claim chunks through next until none are left,
+/// the caller waits until done reaches count. A pool thread that picks the job up late finds nothing
+/// to claim and never touches run or context, which may be gone by then.
+struct parallel_job {
+	void (*run)(void* context, size_t chunk) = nullptr;
+	void* context = nullptr;
+	size_t count = 0;
+	std::atomic<size_t> next{0};
+	std::atomic<size_t> done{0};
+	std::mutex mutex;
+	std::condition_variable finished;
+
+	/// Runs chunks until none are left to claim
+	void work() noexcept {
+		size_t ran = 0;
+		for(size_t chunk = next.fetch_add(1); chunk < count; chunk = next.fetch_add(1)) {
+			run(context, chunk);
+			ran++;
+		}
+		if(ran && done.fetch_add(ran) + ran == count) {
+			std::lock_guard<std::mutex> lock(mutex);
+			finished.notify_all();
+		}
+	}
+
+	void wait() noexcept {
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() { return done.load() == count; });
+	}
+};
+
+/// The threads behind parallel_for(), started on first use and kept until the program exits.
+/// Grows to the most helpers any call asked for, idle threads sleep on a condition variable.
+class thread_pool {
+public:
+	static thread_pool& instance() {
+		static thread_pool pool;
+		return pool;
+	}
+
+	/// Lets up to helpers pool threads join job
+	void submit(std::shared_ptr<parallel_job> const& job, unsigned helpers) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			while(m_threads.size() < helpers) m_threads.emplace_back([this]() { loop(); });
+			for(unsigned i = 0; i < helpers; i++) m_queue.push_back(job);
+		}
+		m_wake.notify_all();
+	}
+
+	~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for(std::thread& t : m_threads) t.join();
+	}
+
+private:
+	thread_pool() = default;
+
+	void loop() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for(;;) {
+			m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+			if(m_queue.empty()) return;
+
+			std::shared_ptr<parallel_job> job = std::move(m_queue.front());
+			m_queue.pop_front();
+			lock.unlock();
+			job->work();
+			lock.lock();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::deque<std::shared_ptr<parallel_job>> m_queue;
+	std::vector<std::thread> m_threads;
+	bool m_stop = false;
+};
+
+} // namespace detail
+
+/// Calls f(first, last) for disjoint ranges covering [begin, end) on up to `threads` threads, the calling thread included.
+/// Ranges aren't made smaller than grain, so small inputs run on the calling thread only.
+/// The other threads come from a pool that is started on first use and reused, so a split call costs a small allocation
+/// and a wake up rather than thread creation. The caller works on the ranges as well, which keeps nested calls from f
+/// from deadlocking when all pool threads are busy.
+/// Blocks until every call returned. f must not throw. @ingroup stxmath
+template<class Fn>
+void parallel_for(size_t begin, size_t end, size_t grain, Fn&& f, unsigned threads = thread_count()) {
+	if(begin >= end) return;
+
+	size_t const n = end - begin;
+	size_t chunks = (n + grain - 1) / (grain ? grain : 1);
+	if(chunks > threads) chunks = threads;
+	if(chunks <= 1) {
+		f(begin, end);
+		return;
+	}
+
+	struct context_type {
+		Fn& f;
+		size_t begin, step, rest;
+	} context = { f, begin, n / chunks, n % chunks };
+
+	auto job = std::make_shared<detail::parallel_job>();
+	job->count   = chunks;
+	job->context = &context;
+	job->run     = [](void* p, size_t chunk) {
+		context_type& c = *static_cast<context_type*>(p);
+		size_t const first = c.begin + chunk * c.step + (chunk < c.rest ? chunk : c.rest);
+		c.f(first, first + c.step + (chunk < c.rest ? 1 : 0));
+	};
+
+	detail::thread_pool::instance().submit(job, (unsigned) chunks - 1);
+	job->work();
+	job->wait();
+}
+
+/// Runs a() and b(), one of them on a pool thread if one is free (see parallel_for()), returns when both are done.
+/// Neither may throw. @ingroup stxmath
+template<class A, class B>
+void parallel_invoke(A&& a, B&& b) {
+	parallel_for(0, 2, 1, [&](size_t first, size_t last) {
+		for(size_t i = first; i < last; i++) {
+			if(i == 0) a();
+			else       b();
+		}
+	}, 2);
+}
+
+} // namespace stx
@@ -2,46 +2,89 @@
 
 #include "mat4.hpp"
 #include "vec2.hpp"
+#include "constexpr_math.hpp"
 
 namespace stx {
 
-static
-mat4 perspective(float fovy, float width, float height, float zNear, float zFar) {
+/// Depth mappings of perspective() and orthographic(). All of them map the visible range to [0, 1]. @ingroup stxmath
+enum class depth_mode {
+	/// zNear to 0, zFar to 1
+	zero_to_one,
+	/// zNear to 1, zFar to 0. With a float depth buffer and a depth test of greater, the float exponent evens out
+	/// the 1 / z distribution of perspective depth, which keeps the precision about constant over the whole range.
+	reverse_z,
+	/// zNear to 0, infinitely far to 1, zFar is ignored. Perspective only.
+	infinite,
+	/// zNear to 1, infinitely far to 0, zFar is ignored. Perspective only. The best precision of all with a float depth buffer.
+	infinite_reverse_z,
+};
+
+/// Perspective projection looking along -z, with depth mapped according to mode. @ingroup stxmath
+/// fovy is the vertical field of view in radians, width and height only give the aspect ratio.
+STX_MATH_CONSTEXPR static
+mat4 perspective(float fovy, float width, float height, float zNear, float zFar, depth_mode mode) {
 #ifdef xassert
-	xassert(zNear < zFar);
+	xassert(zNear > 0);
 	xassert(zNear == zNear);
-	xassert(zFar == zFar);
+	xassert(mode == depth_mode::infinite || mode == depth_mode::infinite_reverse_z || (zNear < zFar && zFar == zFar));
 	xassert(fovy == fovy);
 	xassert(fovy > 0);
 	xassertmsg(fovy < M_PI, "FOV is in radians and has to be smaller than 180 degrees (smaller than pi)");
 #endif
 
 	float const aspect      = width / height;
-	float const tanHalfFovy = tan(fovy / 2.f);
-
-	mat4 result = mat4::zero();
-	result[0][0] = 1.f / (aspect * tanHalfFovy);
-	result[1][1] = 1.f / tanHalfFovy;
-	result[2][3] = -1.f;
-
-	// Depth zero to one
-	result[2][2] = zFar / (zNear - zFar);
-	result[3][2] = -(zFar * zNear) / (zFar - zNear);
+	float const tanHalfFovy = detail::math_tan(fovy / 2.f);
+
+	// depth * -z = depth_scale * z + depth_offset, -z being the w of the result
+	float depth_scale  = 0;
+	float depth_offset = 0;
+	switch(mode) {
+		case depth_mode::zero_to_one:
+			depth_scale  = zFar / (zNear - zFar);
+			depth_offset = -(zFar * zNear) / (zFar - zNear);
+			break;
+		case depth_mode::reverse_z:
+			depth_scale  = zNear / (zFar - zNear);
+			depth_offset = (zFar * zNear) / (zFar - zNear);
+			break;
+		case depth_mode::infinite:
+			depth_scale  = -1;
+			depth_offset = -zNear;
+			break;
+		case depth_mode::infinite_reverse_z:
+			depth_scale  = 0;
+			depth_offset = zNear;
+			break;
+	}
 
 	// Depth negative one to one
-	// result[2][2] = - (zFar + zNear) / (zFar - zNear);
-	// result[3][2] = - (2.f * zFar * zNear) / (zFar - zNear);
+	// float const depth_scale  = - (zFar + zNear) / (zFar - zNear);
+	// float const depth_offset = - (2.f * zFar * zNear) / (zFar - zNear);
+
+	return mat4(
+		1.f / (aspect * tanHalfFovy),                0,           0,            0,
+		                           0, 1.f / tanHalfFovy,           0,            0,
+		                           0,                0, depth_scale, depth_offset,
+		                           0,                0,        -1.f,            0
+	);
+}
 
-	return result;
+/// Perspective projection looking along -z with depth zero (at zNear) to one (at zFar). @ingroup stxmath
+STX_MATH_CONSTEXPR static
+mat4 perspective(float fovy, float width, float height, float zNear, float zFar) {
+	return perspective(fovy, width, height, zNear, zFar, depth_mode::zero_to_one);
 }
 
+/// Orthographic projection of size around the origin, looking along -z. Depth is mapped linearly according to mode,
+/// which can't be one of the infinite ones. @ingroup stxmath
 constexpr static
-mat4 orthographic(vec2 const& size, float zNear, float zFar) {
+mat4 orthographic(vec2 const& size, float zNear, float zFar, depth_mode mode = depth_mode::zero_to_one) {
 #ifdef xassert
 	xassert(zNear < zFar);
 	xassert(zNear == zNear && zFar == zFar);
 	xassert(size.x != 0 && size.y != 0);
 	xassert(size.x == size.x && size.y == size.y);
+	xassert(mode == depth_mode::zero_to_one || mode == depth_mode::reverse_z);
 #endif // defined(xassert)
 
 	mat4 result = mat4::identity();
@@ -51,9 +94,14 @@ mat4 orthographic(vec2 const& size, float zNear, float zFar) {
 	result[3][0] = 0;
 	result[3][1] = 0;
 
-	// Depth zero to one
-	// result[2][2] = -1.f / (zFar - zNear);
-	// result[3][2] = -zNear / (zFar - zNear);
+	if(mode == depth_mode::reverse_z) {
+		result[2][2] = 1.f / (zFar - zNear);
+		result[3][2] = zFar / (zFar - zNear);
+	}
+	else {
+		result[2][2] = -1.f / (zFar - zNear);
+		result[3][2] = -zNear / (zFar - zNear);
+	}
 
 	// Depth negative one to one
 	// result[2][2] = -2.f / (zFar - zNear);
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "mat4.hpp"
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "rect.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace stx {
+
+/// Pixels or points per thread below which unproject_depth() and project_to_screen() don't split the work across threads @ingroup stxmath
+constexpr size_t projection_grain = 1 << 14;
+
+/// Bits of the clip codes (outcodes) project_to_screen() writes, set for points outside the plane.
+/// Bit i stands for frustum plane i. With depth_mode::reverse_z clip_near and clip_far trade places like the frustum planes do,
+/// and the bit of an infinite far plane is never set. @ingroup stxmath
+enum clip_code : uint8_t {
+	clip_left   = 1 << 0,
+	clip_right  = 1 << 1,
+	clip_bottom = 1 << 2,
+	clip_top    = 1 << 3,
+	clip_near   = 1 << 4,
+	clip_far    = 1 << 5,
+};
+
+namespace detail {
+
+/// inverse_projection * (ndc_x, ndc_y, depth, 1) with the perspective divide, one row of pixels.
+/// ndc_x is x * scale_x - 1 for pixel center x, the row's ndc_y is already part of base.
+inline
+void unproject_row(mat4 const& m, vec4 const& base, float scale_x, float const* depth, size_t width, vec3* out) noexcept {
+	using simd::float4;
+	using simd::float8;
+
+	float8 const m00(m[0][0]), m01(m[0][1]), m02(m[0][2]), m03(m[0][3]);
+	float8 const m20(m[2][0]), m21(m[2][1]), m22(m[2][2]), m23(m[2][3]);
+	float8 const b0(base.x), b1(base.y), b2(base.z), b3(base.w);
+	float8 const scale(scale_x), one(1.f);
+	float8 const lane_centers(float4(.5f, 1.5f, 2.5f, 3.5f), float4(4.5f, 5.5f, 6.5f, 7.5f));
+
+	size_t x = 0;
+	size_t const groups_end = width - width % 8;
+	for(; x < groups_end; x += 8) {
+		float8 const nx = simd::madd(lane_centers + float8((float) x), scale, -one);
+		float8 const d  = float8::load(depth + x);
+
+		float8 const px = simd::madd(m20, d, simd::madd(m00, nx, b0));
+		float8 const py = simd::madd(m21, d, simd::madd(m01, nx, b1));
+		float8 const pz = simd::madd(m22, d, simd::madd(m02, nx, b2));
+		float8 const pw = simd::madd(m23, d, simd::madd(m03, nx, b3));
+
+		float8 const inverse_w = one / pw;
+		vec3x8(px * inverse_w, py * inverse_w, pz * inverse_w).store(out + x);
+	}
+
+	for(; x < width; x++) {
+		float const nx = (x + .5f) * scale_x - 1;
+		vec4 const p = vec4(m[0][0], m[0][1], m[0][2], m[0][3]) * nx + vec4(m[2][0], m[2][1], m[2][2], m[2][3]) * depth[x] + base;
+		out[x] = vec3(p.x, p.y, p.z) * (1 / p.w);
+	}
+}
+
+/// view_projection * (p, 1), the perspective divide and the viewport mapping of one point, see project_to_screen()
+inline
+void project_point(mat4 const& m, vec2 const& scale, vec2 const& offset, vec3 const& p, vec2& screen, float& depth, uint8_t& clip) noexcept {
+	vec4 const c(
+		m[0][0] * p.x + m[1][0] * p.y + m[2][0] * p.z + m[3][0],
+		m[0][1] * p.x + m[1][1] * p.y + m[2][1] * p.z + m[3][1],
+		m[0][2] * p.x + m[1][2] * p.y + m[2][2] * p.z + m[3][2],
+		m[0][3] * p.x + m[1][3] * p.y + m[2][3] * p.z + m[3][3]
+	);
+
+	clip = (uint8_t) (
+		(c.x < -c.w ? clip_left   : 0) | (c.x > c.w ? clip_right : 0) |
+		(c.y < -c.w ? clip_bottom : 0) | (c.y > c.w ? clip_top   : 0) |
+		(c.z < 0    ? clip_near   : 0) | (c.z > c.w ? clip_far   : 0));
+
+	float const inverse_w = 1 / c.w;
+	screen = vec2(c.x * inverse_w * scale.x + offset.x, c.y * inverse_w * scale.y + offset.y);
+	depth  = c.z * inverse_w;
+}
+
+/// project_to_screen() for the points [first, last), 8 at a time. Without STX_MATH_SIMD all go through project_point().
+inline
+void project_range(mat4 const& m, vec2 const& scale, vec2 const& offset, vec3 const* in, size_t first, size_t last, vec2* screen, float* depth, uint8_t* clip) noexcept {
+	size_t i = first;
+
+#ifdef STX_MATH_HAS_SIMD
+	using simd::float8;
+
+	float8 const m00(m[0][0]), m01(m[0][1]), m02(m[0][2]), m03(m[0][3]);
+	float8 const m10(m[1][0]), m11(m[1][1]), m12(m[1][2]), m13(m[1][3]);
+	float8 const m20(m[2][0]), m21(m[2][1]), m22(m[2][2]), m23(m[2][3]);
+	float8 const m30(m[3][0]), m31(m[3][1]), m32(m[3][2]), m33(m[3][3]);
+	float8 const scale_x(scale.x), scale_y(scale.y), offset_x(offset.x), offset_y(offset.y);
+	float8 const zero = float8::zero(), one(1.f);
+
+	for(; i + 8 <= last; i += 8) {
+		vec3x8 const p = vec3x8::load(in + i);
+		float8 const cx = simd::madd(m20, p.z, simd::madd(m10, p.y, simd::madd(m00, p.x, m30)));
+		float8 const cy = simd::madd(m21, p.z, simd::madd(m11, p.y, simd::madd(m01, p.x, m31)));
+		float8 const cz = simd::madd(m22, p.z, simd::madd(m12, p.y, simd::madd(m02, p.x, m32)));
+		float8 const cw = simd::madd(m23, p.z, simd::madd(m13, p.y, simd::madd(m03, p.x, m33)));
+
+		float8 const inverse_w = one / cw;
+		float8 const sx = simd::madd(cx * inverse_w, scale_x, offset_x);
+		float8 const sy = simd::madd(cy * inverse_w, scale_y, offset_y);
+
+		// Interleaves x and y into vec2s
+		float* out = screen[i].xy;
+		simd::unpacklo(sx.lo(), sy.lo()).store(out);
+		simd::unpackhi(sx.lo(), sy.lo()).store(out + 4);
+		simd::unpacklo(sx.hi(), sy.hi()).store(out + 8);
+		simd::unpackhi(sx.hi(), sy.hi()).store(out + 12);
+
+		if(depth) (cz * inverse_w).store(depth + i);
+
+		if(clip) {
+			// The bits as floats, added up exactly and converted once
+			float8 const w = cw, minus_w = -cw;
+			float8 const codes =
+				((cx < minus_w) & float8((float) clip_left))   + ((cx > w) & float8((float) clip_right)) +
+				((cy < minus_w) & float8((float) clip_bottom)) + ((cy > w) & float8((float) clip_top)) +
+				((cz < zero)    & float8((float) clip_near))   + ((cz > w) & float8((float) clip_far));
+			int32_t bits[8];
+			simd::store_int32(codes.lo(), bits);
+			simd::store_int32(codes.hi(), bits + 4);
+			for(unsigned k = 0; k < 8; k++) clip[i + k] = (uint8_t) bits[k];
+		}
+	}
+#endif
+
+	for(; i < last; i++) {
+		float d;
+		uint8_t c;
+		project_point(m, scale, offset, in[i], screen[i], d, c);
+		if(depth) depth[i] = d;
+		if(clip) clip[i] = c;
+	}
+}
+
+} // namespace detail
+
+/// Reconstructs the positions of a whole depth buffer, 8 pixels at a time across rows split over threads. @ingroup stxmath
+/// inverse_projection maps (ndc x, ndc y, depth, 1) back, followed by the perspective divide:
+/// camera::inverse_projection() gives view space positions, camera::inverse_view_projection() world space ones.
+/// depth holds width * height values row by row from the top, like images and ui_space() are laid out,
+/// out receives one position per pixel center in the same order. Works for all depth_modes and orthographic().
+/// Depth at an infinite far plane gives inf/nan positions.
+inline
+void unproject_depth(mat4 const& inverse_projection, float const* depth, size_t width, size_t height, vec3* out, unsigned threads = thread_count()) {
+	if(width == 0) return;
+
+	mat4 const& m = inverse_projection;
+	vec4 const column1(m[1][0], m[1][1], m[1][2], m[1][3]);
+	vec4 const column3(m[3][0], m[3][1], m[3][2], m[3][3]);
+	float const scale_x =  2.f / width;
+	float const scale_y = -2.f / height;
+
+	size_t const grain = (projection_grain + width - 1) / width;
+	parallel_for(0, height, grain, [&](size_t first, size_t last) {
+		for(size_t y = first; y < last; y++) {
+			float const ny = (y + .5f) * scale_y + 1;
+			detail::unproject_row(m, column1 * ny + column3, scale_x, depth + y * width, width, out + y * width);
+		}
+	}, threads);
+}
+
+/// Projects n world space points to the screen, 8 at a time and split over threads for big inputs. @ingroup stxmath
+/// view_projection is e.g. camera::view_projection(). The points end up in screen as pixel coordinates inside viewport,
+/// with y going down from viewport.position like ui_space(). depth receives depth after the perspective divide and
+/// clip the clip_code bits of the planes each point is outside of, 0 for visible points. Both may be null.
+/// The clip tests run before the divide, so points behind the camera get a clip bit as well. Their screen
+/// position and depth are meaningless, as is anything with w = 0.
+inline
+void project_to_screen(mat4 const& view_projection, rect const& viewport, vec3 const* in, size_t n, vec2* screen, float* depth = nullptr, uint8_t* clip = nullptr, unsigned threads = thread_count()) {
+	vec2 const scale(viewport.size.x * .5f, viewport.size.y * -.5f);
+	vec2 const offset = viewport.position + viewport.size * .5f;
+
+	// Splits at multiples of 8, so every point takes the same SIMD or scalar path and the results don't depend on threads.
+	// Without STX_MATH_SIMD this only adds the threads to a loop over project_point().
+	size_t const blocks = (n + 7) / 8;
+	parallel_for(0, blocks, projection_grain / 8, [&](size_t first, size_t last) {
+		detail::project_range(view_projection, scale, offset, in, first * 8, std::min(last * 8, n), screen, depth, clip);
+	}, threads);
+}
+
+} // namespace stx
@@ -2,14 +2,16 @@
 
 #include <cmath>
 
+#include "fwd.hpp"
 #include "vec3.hpp"
+#include "simd.hpp"
+#include "fast_math.hpp"
+#include "constexpr_math.hpp"
 
 namespace stx {
 
-class mat4;
-class mat3;
-
 /// A quaternion used for rotation.
+/// With STX_MATH_SIMD it is stored in a 16 byte aligned vector register.
 /// @ingroup stxmath
 class quat {
 public:
@@ -17,6 +19,9 @@ public:
 		struct { float    w, x, y, z; };
 		struct { float real, i, j, k; };
 		float wxyz[4];
+#ifdef STX_MATH_HAS_SIMD
+		simd::native4 packed;
+#endif
 	};
 
 	constexpr
@@ -24,14 +29,45 @@ public:
 		quat(1, 0, 0, 0)
 	{}
 
+	/// Sets the lanes in one register with STX_MATH_SIMD, like vec4's constructor
 	constexpr
 	quat(float w, float x, float y, float z) :
 		w(w), x(x), y(y), z(z)
-	{}
+	{
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+		if(!STX_MATH_CONSTANT_EVALUATED()) packed = simd::float4(w, x, y, z).v;
+#endif
+	}
 
 	explicit
 	quat(mat3 const& m);
 
+#ifdef STX_MATH_HAS_SIMD
+	explicit
+	quat(simd::float4 const& f) noexcept :
+		packed(f.v)
+	{}
+
+	simd::float4 to_simd() const noexcept { return packed; }
+
+	quat operator+(const quat& other) const noexcept { return quat(to_simd() + other.to_simd()); }
+	quat operator-(const quat& other) const noexcept { return quat(to_simd() - other.to_simd()); }
+	quat operator*(const quat& other) const noexcept {
+		// Hamilton product as 4 broadcasts of this times sign flipped permutations of other
+		simd::float4 const a = to_simd();
+		simd::float4 const b = other.to_simd();
+
+		simd::float4 r = simd::splat<0>(a) * b;
+		r = simd::madd(simd::splat<1>(a), simd::shuffle<1, 0, 3, 2>(b) ^ simd::float4(-0.f, 0.f, -0.f, 0.f), r);
+		r = simd::madd(simd::splat<2>(a), simd::shuffle<2, 3, 0, 1>(b) ^ simd::float4(-0.f, 0.f, 0.f, -0.f), r);
+		r = simd::madd(simd::splat<3>(a), simd::shuffle<3, 2, 1, 0>(b) ^ simd::float4(-0.f, -0.f, 0.f, 0.f), r);
+		return quat(r);
+	}
+	quat operator/(const quat& other) const noexcept { return (*this) * other.conjugate(); }
+
+	quat operator*(float f) const noexcept { return quat(to_simd() * simd::float4(f)); }
+	quat operator/(float f) const noexcept { return (*this) * (1.f / f); }
+#else
 	constexpr quat operator+(const quat& other) const noexcept { return quat(w + other.w, x + other.x, y + other.y, z + other.z); }
 	constexpr quat operator-(const quat& other) const noexcept { return quat(w - other.w, x - other.x, y - other.y, z - other.z); }
 	constexpr quat operator*(const quat& other) const noexcept {
@@ -46,17 +82,37 @@ public:
 
 	constexpr quat operator*(float f) const noexcept { return quat(w * f, x * f, y * f, z * f); }
 	constexpr quat operator/(float f) const noexcept { return (*this) * (1.f / f); }
+#endif
 
+	/// Rotates v by this unit quaternion. Same as q * (0, v) * conjugate(q), expanded into
+	/// v + w * t + q.xyz x t with t = 2 * q.xyz x v: 15 multiplies instead of two Hamilton products.
 	constexpr vec3 operator*(stx::vec3 const& v) const noexcept {
-		quat tmp = *this * quat(0, v.x, v.y, v.z) * conjugate();
-		return vec3(tmp.x, tmp.y, tmp.z);
+		vec3 const u(x, y, z);
+		vec3 const t = u.cross(v) * 2.f;
+		return v + t * w + u.cross(t);
 	}
 
-	constexpr quat operator*=(const quat& other) { return *this = *this * other; }
-	constexpr quat operator/=(const quat& other) { return *this = *this / other; }
-	constexpr quat operator+=(const quat& other) { return *this = *this + other; }
-	constexpr quat operator-=(const quat& other) { return *this = *this - other; }
+	STX_SIMD_CONSTEXPR quat operator*=(const quat& other) { return *this = *this * other; }
+	STX_SIMD_CONSTEXPR quat operator/=(const quat& other) { return *this = *this / other; }
+	STX_SIMD_CONSTEXPR quat operator+=(const quat& other) { return *this = *this + other; }
+	STX_SIMD_CONSTEXPR quat operator-=(const quat& other) { return *this = *this - other; }
 
+#ifdef STX_MATH_HAS_SIMD
+	quat operator-() const noexcept { return quat(-to_simd()); }
+
+	bool operator==(quat const& other) const noexcept { return simd::all(to_simd() == other.to_simd()); }
+	bool operator!=(quat const& other) const noexcept { return !(*this == other); }
+
+	float length2() const noexcept { return dot(*this); }
+	STX_MATH_CONSTEXPR float length() const noexcept {
+		if(STX_MATH_CONSTANT_EVALUATED()) return detail::math_sqrt(w * w + x * x + y * y + z * z);
+		return simd::first(simd::sqrt(simd::dot4(to_simd(), to_simd())));
+	}
+
+	quat conjugate() const noexcept { return quat(to_simd() ^ simd::float4(0.f, -0.f, -0.f, -0.f)); }
+
+	float dot(quat const& q) const noexcept { return simd::first(simd::dot4(to_simd(), q.to_simd())); }
+#else
 	constexpr quat operator-() const noexcept { return quat(-w,-x,-y,-z); }
 
 	constexpr
@@ -65,13 +121,14 @@ public:
 	bool operator!=(quat const& other) const noexcept { return other.w != w || other.x != x || other.y != y || other.z != z; }
 
 	constexpr float length2() const noexcept { return w * w + x * x + y * y + z * z; }
-	float length() const noexcept { return sqrtf(length2()); }
+	STX_MATH_CONSTEXPR float length() const noexcept { return detail::math_sqrt(length2()); }
 
 	constexpr quat conjugate() const noexcept { return quat(w, -x, -y, -z); }
 
 	constexpr float dot(quat const& q) const noexcept {
 		return q.w * w + q.x * x + q.y * y + q.z * z;
 	}
+#endif
 
 	quat lerp(quat const& other, float k) const noexcept {
 		if(other.dot(*this) < 0)
@@ -103,23 +160,34 @@ public:
 
 		if(dot > 1) dot = 1;
 
-		float theta   = acosf(dot) * k;
+		float sintheta, costheta;
+		detail::math_sincos(detail::math_acos(dot) * k, sintheta, costheta);
 
 		quat v2 = (v1 - (*this) * dot).normalize();
 
-		return (*this) * cosf(theta) + v2 * sinf(theta);
+		return (*this) * costheta + v2 * sintheta;
 	}
 
 	quat slerp(quat const& other, float k, float step, float unit = 1) const noexcept {
 		return slerp(other, 1 - powf(1 - k, step / unit));
 	}
 
-	quat normalize() const noexcept {
-		float l = length();
+	STX_MATH_CONSTEXPR quat normalize() const noexcept {
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_FAST)
+		if(!STX_MATH_CONSTANT_EVALUATED()) return quat(to_simd() * simd::rsqrt(simd::dot4(to_simd(), to_simd())));
+#elif defined(STX_MATH_HAS_SIMD)
+		if(!STX_MATH_CONSTANT_EVALUATED()) return quat(to_simd() / simd::sqrt(simd::dot4(to_simd(), to_simd())));
+#elif defined(STX_MATH_FAST)
+		if(!STX_MATH_CONSTANT_EVALUATED()) {
+			float const f = fast_rsqrt(length2());
+			return quat(w * f, x * f, y * f, z * f);
+		}
+#endif
+		float const l = detail::math_sqrt(w * w + x * x + y * y + z * z);
 		return quat(w / l, x / l, y / l, z / l);
 	}
 
-	constexpr quat& make_conjugate()  noexcept { return (*this) = conjugate(); }
+	STX_SIMD_CONSTEXPR quat& make_conjugate()  noexcept { return (*this) = conjugate(); }
 	quat& make_normalized() noexcept { return (*this) = normalize(); }
 	quat& make_lerp(quat const& other, float k) noexcept { return (*this) = lerp(other, k); }
 	quat& make_lerp(quat const& other, float k, float step, float unit = 1) noexcept { return (*this) = lerp(other, k, step, unit); }
@@ -129,9 +197,9 @@ public:
 	mat3 to_mat3() const noexcept;
 	mat4 to_mat4() const noexcept;
 
-	static quat angle_axis(float angle, vec3 const& axis) noexcept {
-		float const sinangle = sinf(angle / 2.f);
-		float const cosangle = cosf(angle / 2.f);
+	STX_MATH_CONSTEXPR static quat angle_axis(float angle, vec3 const& axis) noexcept {
+		float sinangle = 0, cosangle = 0;
+		detail::math_sincos(angle / 2.f, sinangle, cosangle);
 		return quat(
 			cosangle,
 			axis.x * sinangle,
@@ -159,29 +227,26 @@ public:
 		return quat::angle_axis(v.y, vec3::yaxis()) * quat::angle_axis(v.x, vec3::xaxis());
 	}
 
-	static quat roll_pitch_yaw(vec3 const& v) noexcept {
+	STX_MATH_CONSTEXPR static quat roll_pitch_yaw(vec3 const& v) noexcept {
 		// Adapted from https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles
-		quat q;
-
-		float const t0 = cosf(v.z * 0.5);
-		float const t1 = sinf(v.z * 0.5);
-		float const t2 = cosf(v.x * 0.5);
-		float const t3 = sinf(v.x * 0.5);
-		float const t4 = cosf(v.y * 0.5);
-		float const t5 = sinf(v.y * 0.5);
-
-		q.w = t0 * t2 * t4 + t1 * t3 * t5;
-		q.x = t0 * t3 * t4 - t1 * t2 * t5;
-		q.y = t0 * t2 * t5 + t1 * t3 * t4;
-		q.z = t1 * t2 * t4 - t0 * t3 * t5;
+		float t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5 = 0;
+		detail::math_sincos(v.z * .5f, t1, t0);
+		detail::math_sincos(v.x * .5f, t3, t2);
+		detail::math_sincos(v.y * .5f, t5, t4);
 
-		return q;
+		return quat(
+			t0 * t2 * t4 + t1 * t3 * t5,
+			t0 * t3 * t4 - t1 * t2 * t5,
+			t0 * t2 * t5 + t1 * t3 * t4,
+			t1 * t2 * t4 - t0 * t3 * t5
+		);
 	}
 
 	static quat head_rotation(vec3 const& v) noexcept {
 		return quat::angle_axis(v.z, vec3::zaxis()) * quat::angle_axis(v.y, vec3::yaxis()) * quat::angle_axis(v.x, vec3::xaxis());
 	}
 
+	/// Drops w, decompress() recovers it assuming w >= 0. quat32 and quat48 from packing.hpp are smaller and work for any sign.
 	constexpr
 	vec3 compress() noexcept { return vec3{x, y, z}; }
 
@@ -0,0 +1,757 @@
+#pragma once
+
+/* Opt-in SIMD backend.
+ * Define STX_MATH_SIMD (e.g. -DSTX_MATH_SIMD) before including any stxmath header to
+ * switch vec4 and quat to 16 byte aligned vector storage and to enable the intrinsic
+ * kernels. SSE2 is used on x86 (SSE4.1, AVX, FMA and F16C are picked up if the compiler
+ * targets them, e.g. with -march=native), NEON on ARM.
+ * Without STX_MATH_SIMD the float4 type below is emulated with plain floats, so code
+ * written against it compiles either way.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(STX_MATH_SIMD)
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define STX_MATH_SSE 1
+#		include <emmintrin.h>
+#		if defined(__SSE4_1__)
+#			define STX_MATH_SSE41 1
+#			include <smmintrin.h>
+#		endif
+#		if defined(__AVX__)
+#			define STX_MATH_AVX 1
+#			include <immintrin.h>
+#		endif
+#		if defined(__FMA__)
+#			define STX_MATH_FMA 1
+#			include <immintrin.h>
+#		endif
+#		if defined(__F16C__)
+#			define STX_MATH_F16C 1
+#			include <immintrin.h>
+#		endif
+#	elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#		define STX_MATH_NEON 1
+#		include <arm_neon.h>
+#	endif
+#endif
+
+#if defined(STX_MATH_SSE) || defined(STX_MATH_NEON)
+#	define STX_MATH_HAS_SIMD 1
+	/// Functions that are constexpr in the scalar build but use intrinsics in the SIMD build
+#	define STX_SIMD_CONSTEXPR
+#else
+#	define STX_SIMD_CONSTEXPR constexpr
+#endif
+
+namespace stx {
+
+namespace simd {
+
+#if defined(STX_MATH_SSE)
+using native4 = __m128;
+#elif defined(STX_MATH_NEON)
+using native4 = float32x4_t;
+#else
+struct native4 { float v[4]; };
+#endif
+
+/// Four float lanes, one SSE/NEON register. Comparisons return lane masks (all bits set or zero). @ingroup stxmath
+struct float4 {
+	native4 v;
+
+	float4() = default;
+	float4(native4 const& v) noexcept : v(v) {}
+	explicit float4(float f) noexcept;
+	float4(float a, float b, float c, float d) noexcept;
+
+	static float4 zero() noexcept { return float4(0.f); }
+
+	/// Loads 4 floats, p doesn't need to be aligned
+	static float4 load(float const* p) noexcept;
+	/// Loads 4 floats, p must be 16 byte aligned
+	static float4 load_aligned(float const* p) noexcept;
+
+	void store(float* p) const noexcept;
+	void store_aligned(float* p) const noexcept;
+	/// Non temporal store bypassing the cache, p must be 16 byte aligned. Follow a series of these with fence().
+	void stream(float* p) const noexcept;
+
+	float operator[](unsigned i) const noexcept {
+		float tmp[4];
+		store(tmp);
+		return tmp[i];
+	}
+};
+
+#if defined(STX_MATH_SSE)
+
+inline float4::float4(float f) noexcept : v(_mm_set1_ps(f)) {}
+inline float4::float4(float a, float b, float c, float d) noexcept : v(_mm_setr_ps(a, b, c, d)) {}
+
+inline float4 float4::load(float const* p) noexcept { return _mm_loadu_ps(p); }
+inline float4 float4::load_aligned(float const* p) noexcept { return _mm_load_ps(p); }
+inline void float4::store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+inline void float4::store_aligned(float* p) const noexcept { _mm_store_ps(p, v); }
+inline void float4::stream(float* p) const noexcept { _mm_stream_ps(p, v); }
+
+inline float4 operator+(float4 const& a, float4 const& b) noexcept { return _mm_add_ps(a.v, b.v); }
+inline float4 operator-(float4 const& a, float4 const& b) noexcept { return _mm_sub_ps(a.v, b.v); }
+inline float4 operator*(float4 const& a, float4 const& b) noexcept { return _mm_mul_ps(a.v, b.v); }
+inline float4 operator/(float4 const& a, float4 const& b) noexcept { return _mm_div_ps(a.v, b.v); }
+inline float4 operator-(float4 const& a) noexcept { return _mm_xor_ps(a.v, _mm_set1_ps(-0.f)); }
+
+inline float4 operator< (float4 const& a, float4 const& b) noexcept { return _mm_cmplt_ps(a.v, b.v); }
+inline float4 operator<=(float4 const& a, float4 const& b) noexcept { return _mm_cmple_ps(a.v, b.v); }
+inline float4 operator> (float4 const& a, float4 const& b) noexcept { return _mm_cmpgt_ps(a.v, b.v); }
+inline float4 operator>=(float4 const& a, float4 const& b) noexcept { return _mm_cmpge_ps(a.v, b.v); }
+inline float4 operator==(float4 const& a, float4 const& b) noexcept { return _mm_cmpeq_ps(a.v, b.v); }
+inline float4 operator!=(float4 const& a, float4 const& b) noexcept { return _mm_cmpneq_ps(a.v, b.v); }
+
+inline float4 operator&(float4 const& a, float4 const& b) noexcept { return _mm_and_ps(a.v, b.v); }
+inline float4 operator|(float4 const& a, float4 const& b) noexcept { return _mm_or_ps(a.v, b.v); }
+inline float4 operator^(float4 const& a, float4 const& b) noexcept { return _mm_xor_ps(a.v, b.v); }
+/// a & ~b
+inline float4 andnot(float4 const& a, float4 const& b) noexcept { return _mm_andnot_ps(b.v, a.v); }
+
+/// a < b ? a : b per lane, so b when either is nan like stx::min, the same for max
+inline float4 min (float4 const& a, float4 const& b) noexcept { return _mm_min_ps(a.v, b.v); }
+inline float4 max (float4 const& a, float4 const& b) noexcept { return _mm_max_ps(a.v, b.v); }
+inline float4 sqrt(float4 const& a) noexcept { return _mm_sqrt_ps(a.v); }
+/// 1 / sqrt(a) from the hardware estimate and one Newton step, relative error below 5e-7
+inline float4 rsqrt(float4 const& a) noexcept {
+	__m128 const r = _mm_rsqrt_ps(a.v);
+	__m128 const e = _mm_mul_ps(_mm_mul_ps(a.v, r), r);
+	return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(.5f), r), _mm_sub_ps(_mm_set1_ps(3.f), e));
+}
+
+/// a * b + c. Fused (single rounding) when compiled with FMA support.
+inline float4 madd(float4 const& a, float4 const& b, float4 const& c) noexcept {
+#if defined(STX_MATH_FMA)
+	return _mm_fmadd_ps(a.v, b.v, c.v);
+#else
+	return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v);
+#endif
+}
+
+/// Lanes of a where mask is set, lanes of b otherwise
+inline float4 select(float4 const& mask, float4 const& a, float4 const& b) noexcept {
+#if defined(STX_MATH_SSE41)
+	return _mm_blendv_ps(b.v, a.v, mask.v);
+#else
+	return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+#endif
+}
+
+/// The sign bits of all lanes, lane 0 in bit 0
+inline int movemask(float4 const& a) noexcept { return _mm_movemask_ps(a.v); }
+
+/// Lanes (a[i0], a[i1], a[i2], a[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a) noexcept { return _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(i3, i2, i1, i0)); }
+/// Lanes (a[i0], a[i1], b[i2], b[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a, float4 const& b) noexcept { return _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(i3, i2, i1, i0)); }
+
+/// (a[0], b[0], a[1], b[1])
+inline float4 unpacklo(float4 const& a, float4 const& b) noexcept { return _mm_unpacklo_ps(a.v, b.v); }
+/// (a[2], b[2], a[3], b[3])
+inline float4 unpackhi(float4 const& a, float4 const& b) noexcept { return _mm_unpackhi_ps(a.v, b.v); }
+
+inline float first(float4 const& a) noexcept { return _mm_cvtss_f32(a.v); }
+
+/// Rounds to the nearest integer, ties to even. Without SSE4.1 only for |a| < 2^31.
+inline float4 round(float4 const& a) noexcept {
+#if defined(STX_MATH_SSE41)
+	return _mm_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+	return _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v));
+#endif
+}
+
+/// Loads 4 int32 as floats
+inline float4 load_int32(int32_t const* p) noexcept { return _mm_cvtepi32_ps(_mm_loadu_si128((__m128i const*) p)); }
+/// Rounds to the nearest integer and stores as int32, the lanes have to be in the int32 range
+inline void store_int32(float4 const& a, int32_t* p) noexcept { _mm_storeu_si128((__m128i*) p, _mm_cvtps_epi32(a.v)); }
+/// Rounds a and b to the nearest integers and stores them as 8 int16, saturating
+inline void store_int16(float4 const& a, float4 const& b, int16_t* p) noexcept {
+	_mm_storeu_si128((__m128i*) p, _mm_packs_epi32(_mm_cvtps_epi32(a.v), _mm_cvtps_epi32(b.v)));
+}
+
+/// Orders preceding stream() stores
+inline void fence() noexcept { _mm_sfence(); }
+
+#elif defined(STX_MATH_NEON)
+
+inline float4::float4(float f) noexcept : v(vdupq_n_f32(f)) {}
+inline float4::float4(float a, float b, float c, float d) noexcept {
+	float tmp[4] = { a, b, c, d };
+	v = vld1q_f32(tmp);
+}
+
+inline float4 float4::load(float const* p) noexcept { return vld1q_f32(p); }
+inline float4 float4::load_aligned(float const* p) noexcept { return vld1q_f32(p); }
+inline void float4::store(float* p) const noexcept { vst1q_f32(p, v); }
+inline void float4::store_aligned(float* p) const noexcept { vst1q_f32(p, v); }
+inline void float4::stream(float* p) const noexcept { vst1q_f32(p, v); }
+
+namespace detail {
+
+inline uint32x4_t bits(float4 const& a) noexcept { return vreinterpretq_u32_f32(a.v); }
+inline float4 from_bits(uint32x4_t const& a) noexcept { return vreinterpretq_f32_u32(a); }
+
+} // namespace detail
+
+inline float4 operator+(float4 const& a, float4 const& b) noexcept { return vaddq_f32(a.v, b.v); }
+inline float4 operator-(float4 const& a, float4 const& b) noexcept { return vsubq_f32(a.v, b.v); }
+inline float4 operator*(float4 const& a, float4 const& b) noexcept { return vmulq_f32(a.v, b.v); }
+inline float4 operator/(float4 const& a, float4 const& b) noexcept {
+#if defined(__aarch64__)
+	return vdivq_f32(a.v, b.v);
+#else
+	float32x4_t r = vrecpeq_f32(b.v);
+	r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+	r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+	return vmulq_f32(a.v, r);
+#endif
+}
+inline float4 operator-(float4 const& a) noexcept { return vnegq_f32(a.v); }
+
+inline float4 operator< (float4 const& a, float4 const& b) noexcept { return detail::from_bits(vcltq_f32(a.v, b.v)); }
+inline float4 operator<=(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vcleq_f32(a.v, b.v)); }
+inline float4 operator> (float4 const& a, float4 const& b) noexcept { return detail::from_bits(vcgtq_f32(a.v, b.v)); }
+inline float4 operator>=(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vcgeq_f32(a.v, b.v)); }
+inline float4 operator==(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vceqq_f32(a.v, b.v)); }
+inline float4 operator!=(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vmvnq_u32(vceqq_f32(a.v, b.v))); }
+
+inline float4 operator&(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vandq_u32(detail::bits(a), detail::bits(b))); }
+inline float4 operator|(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vorrq_u32(detail::bits(a), detail::bits(b))); }
+inline float4 operator^(float4 const& a, float4 const& b) noexcept { return detail::from_bits(veorq_u32(detail::bits(a), detail::bits(b))); }
+/// a & ~b
+inline float4 andnot(float4 const& a, float4 const& b) noexcept { return detail::from_bits(vbicq_u32(detail::bits(a), detail::bits(b))); }
+
+// Not vminq/vmaxq, those propagate nan while minps/maxps and the emulation return b
+inline float4 min(float4 const& a, float4 const& b) noexcept { return vbslq_f32(vcltq_f32(a.v, b.v), a.v, b.v); }
+inline float4 max(float4 const& a, float4 const& b) noexcept { return vbslq_f32(vcgtq_f32(a.v, b.v), a.v, b.v); }
+inline float4 sqrt(float4 const& a) noexcept {
+#if defined(__aarch64__)
+	return vsqrtq_f32(a.v);
+#else
+	float32x4_t r = vrsqrteq_f32(a.v);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+	return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vmulq_f32(a.v, r)), vmvnq_u32(vceqq_f32(a.v, vdupq_n_f32(0)))));
+#endif
+}
+/// 1 / sqrt(a) from the hardware estimate and two Newton steps (the NEON estimate has 8 bits), relative error below 5e-7
+inline float4 rsqrt(float4 const& a) noexcept {
+	float32x4_t r = vrsqrteq_f32(a.v);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+	return r;
+}
+
+/// a * b + c
+inline float4 madd(float4 const& a, float4 const& b, float4 const& c) noexcept { return vmlaq_f32(c.v, a.v, b.v); }
+
+/// Lanes of a where mask is set, lanes of b otherwise
+inline float4 select(float4 const& mask, float4 const& a, float4 const& b) noexcept { return vbslq_f32(detail::bits(mask), a.v, b.v); }
+
+/// The sign bits of all lanes, lane 0 in bit 0
+inline int movemask(float4 const& a) noexcept {
+	uint32x4_t s = vshrq_n_u32(detail::bits(a), 31);
+	return (int) (vgetq_lane_u32(s, 0) | (vgetq_lane_u32(s, 1) << 1) | (vgetq_lane_u32(s, 2) << 2) | (vgetq_lane_u32(s, 3) << 3));
+}
+
+/// Lanes (a[i0], a[i1], a[i2], a[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a) noexcept {
+#if defined(__clang__)
+	return __builtin_shufflevector(a.v, a.v, i0, i1, i2, i3);
+#else
+	return __builtin_shuffle(a.v, uint32x4_t{ i0, i1, i2, i3 });
+#endif
+}
+/// Lanes (a[i0], a[i1], b[i2], b[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a, float4 const& b) noexcept {
+#if defined(__clang__)
+	return __builtin_shufflevector(a.v, b.v, i0, i1, i2 + 4, i3 + 4);
+#else
+	return __builtin_shuffle(a.v, b.v, uint32x4_t{ i0, i1, i2 + 4, i3 + 4 });
+#endif
+}
+
+/// (a[0], b[0], a[1], b[1])
+inline float4 unpacklo(float4 const& a, float4 const& b) noexcept { return vzipq_f32(a.v, b.v).val[0]; }
+/// (a[2], b[2], a[3], b[3])
+inline float4 unpackhi(float4 const& a, float4 const& b) noexcept { return vzipq_f32(a.v, b.v).val[1]; }
+
+inline float first(float4 const& a) noexcept { return vgetq_lane_f32(a.v, 0); }
+
+/// Rounds to the nearest integer, ties to even. On 32 bit ARM only for |a| < 2^22.
+inline float4 round(float4 const& a) noexcept {
+#if defined(__aarch64__)
+	return vrndnq_f32(a.v);
+#else
+	float32x4_t const magic = detail::from_bits(vorrq_u32(vandq_u32(detail::bits(a), vdupq_n_u32(0x80000000u)), vdupq_n_u32(0x4B400000u))).v;
+	return vsubq_f32(vaddq_f32(a.v, magic), magic);
+#endif
+}
+
+/// Loads 4 int32 as floats
+inline float4 load_int32(int32_t const* p) noexcept { return vcvtq_f32_s32(vld1q_s32(p)); }
+/// Rounds to the nearest integer and stores as int32, the lanes have to be in the int32 range
+inline void store_int32(float4 const& a, int32_t* p) noexcept { vst1q_s32(p, vcvtq_s32_f32(round(a).v)); }
+/// Rounds a and b to the nearest integers and stores them as 8 int16, saturating
+inline void store_int16(float4 const& a, float4 const& b, int16_t* p) noexcept {
+	vst1q_s16(p, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(round(a).v)), vqmovn_s32(vcvtq_s32_f32(round(b).v))));
+}
+
+/// Orders preceding stream() stores
+inline void fence() noexcept {}
+
+#else // Scalar emulation
+
+namespace detail {
+
+template<typename Fn> inline
+float4 map(float4 const& a, Fn fn) noexcept {
+	float4 r;
+	for(unsigned i = 0; i < 4; i++) r.v.v[i] = fn(a.v.v[i]);
+	return r;
+}
+template<typename Fn> inline
+float4 map(float4 const& a, float4 const& b, Fn fn) noexcept {
+	float4 r;
+	for(unsigned i = 0; i < 4; i++) r.v.v[i] = fn(a.v.v[i], b.v.v[i]);
+	return r;
+}
+
+inline uint32_t bits(float f) noexcept { uint32_t u; std::memcpy(&u, &f, 4); return u; }
+inline float from_bits(uint32_t u) noexcept { float f; std::memcpy(&f, &u, 4); return f; }
+inline float mask(bool b) noexcept { return from_bits(b ? 0xFFFFFFFFu : 0u); }
+
+} // namespace detail
+
+inline float4::float4(float f) noexcept : v{{ f, f, f, f }} {}
+inline float4::float4(float a, float b, float c, float d) noexcept : v{{ a, b, c, d }} {}
+
+inline float4 float4::load(float const* p) noexcept { return float4(p[0], p[1], p[2], p[3]); }
+inline float4 float4::load_aligned(float const* p) noexcept { return load(p); }
+inline void float4::store(float* p) const noexcept { for(unsigned i = 0; i < 4; i++) p[i] = v.v[i]; }
+inline void float4::store_aligned(float* p) const noexcept { store(p); }
+inline void float4::stream(float* p) const noexcept { store(p); }
+
+inline float4 operator+(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x + y; }); }
+inline float4 operator-(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x - y; }); }
+inline float4 operator*(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x * y; }); }
+inline float4 operator/(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x / y; }); }
+inline float4 operator-(float4 const& a) noexcept { return detail::map(a, [](float x) { return -x; }); }
+
+inline float4 operator< (float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x <  y); }); }
+inline float4 operator<=(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x <= y); }); }
+inline float4 operator> (float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x >  y); }); }
+inline float4 operator>=(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x >= y); }); }
+inline float4 operator==(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x == y); }); }
+inline float4 operator!=(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::mask(x != y); }); }
+
+inline float4 operator&(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::from_bits(detail::bits(x) & detail::bits(y)); }); }
+inline float4 operator|(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::from_bits(detail::bits(x) | detail::bits(y)); }); }
+inline float4 operator^(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::from_bits(detail::bits(x) ^ detail::bits(y)); }); }
+/// a & ~b
+inline float4 andnot(float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return detail::from_bits(detail::bits(x) & ~detail::bits(y)); }); }
+
+inline float4 min (float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+inline float4 max (float4 const& a, float4 const& b) noexcept { return detail::map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+inline float4 sqrt(float4 const& a) noexcept { return detail::map(a, [](float x) { return sqrtf(x); }); }
+inline float4 rsqrt(float4 const& a) noexcept { return detail::map(a, [](float x) { return 1.f / sqrtf(x); }); }
+
+/// a * b + c
+inline float4 madd(float4 const& a, float4 const& b, float4 const& c) noexcept { return a * b + c; }
+
+/// Lanes of a where mask is set, lanes of b otherwise
+inline float4 select(float4 const& mask, float4 const& a, float4 const& b) noexcept { return (mask & a) | andnot(b, mask); }
+
+/// The sign bits of all lanes, lane 0 in bit 0
+inline int movemask(float4 const& a) noexcept {
+	int result = 0;
+	for(unsigned i = 0; i < 4; i++) result |= (int)(detail::bits(a.v.v[i]) >> 31) << i;
+	return result;
+}
+
+/// Lanes (a[i0], a[i1], a[i2], a[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a) noexcept { return float4(a.v.v[i0], a.v.v[i1], a.v.v[i2], a.v.v[i3]); }
+/// Lanes (a[i0], a[i1], b[i2], b[i3])
+template<unsigned i0, unsigned i1, unsigned i2, unsigned i3> inline
+float4 shuffle(float4 const& a, float4 const& b) noexcept { return float4(a.v.v[i0], a.v.v[i1], b.v.v[i2], b.v.v[i3]); }
+
+/// (a[0], b[0], a[1], b[1])
+inline float4 unpacklo(float4 const& a, float4 const& b) noexcept { return float4(a.v.v[0], b.v.v[0], a.v.v[1], b.v.v[1]); }
+/// (a[2], b[2], a[3], b[3])
+inline float4 unpackhi(float4 const& a, float4 const& b) noexcept { return float4(a.v.v[2], b.v.v[2], a.v.v[3], b.v.v[3]); }
+
+inline float first(float4 const& a) noexcept { return a.v.v[0]; }
+
+/// Rounds to the nearest integer, ties to even
+inline float4 round(float4 const& a) noexcept { return detail::map(a, [](float x) { return std::nearbyint(x); }); }
+
+/// Loads 4 int32 as floats
+inline float4 load_int32(int32_t const* p) noexcept { return float4((float) p[0], (float) p[1], (float) p[2], (float) p[3]); }
+/// Rounds to the nearest integer and stores as int32, the lanes have to be in the int32 range
+inline void store_int32(float4 const& a, int32_t* p) noexcept { for(unsigned i = 0; i < 4; i++) p[i] = (int32_t) std::nearbyint(a.v.v[i]); }
+/// Rounds a and b to the nearest integers and stores them as 8 int16, saturating
+inline void store_int16(float4 const& a, float4 const& b, int16_t* p) noexcept {
+	for(unsigned i = 0; i < 8; i++) {
+		float const f = std::nearbyint(i < 4 ? a.v.v[i] : b.v.v[i - 4]);
+		p[i] = (int16_t) (f < -32768.f ? -32768.f : (f > 32767.f ? 32767.f : f));
+	}
+}
+
+/// Orders preceding stream() stores
+inline void fence() noexcept {}
+
+#endif
+
+// -- Derived operations ---------------------------------------------------------------
+
+inline float4& operator+=(float4& a, float4 const& b) noexcept { return a = a + b; }
+inline float4& operator-=(float4& a, float4 const& b) noexcept { return a = a - b; }
+inline float4& operator*=(float4& a, float4 const& b) noexcept { return a = a * b; }
+inline float4& operator/=(float4& a, float4 const& b) noexcept { return a = a / b; }
+
+/// c - a * b
+inline float4 nmadd(float4 const& a, float4 const& b, float4 const& c) noexcept { return c - a * b; }
+
+/// a * b + c on single floats, so kernels templated on the lane type also run one value at a time
+inline float madd(float a, float b, float c) noexcept { return a * b + c; }
+
+inline float4 abs(float4 const& a) noexcept { return andnot(a, float4(-0.f)); }
+
+/// Flips the sign of a where the sign bit of s is set
+inline float4 xorsign(float4 const& a, float4 const& s) noexcept { return a ^ (s & float4(-0.f)); }
+
+/// Broadcasts lane i
+template<unsigned i> inline
+float4 splat(float4 const& a) noexcept { return shuffle<i, i, i, i>(a); }
+
+inline bool any(float4 const& mask) noexcept { return movemask(mask) != 0; }
+inline bool all(float4 const& mask) noexcept { return movemask(mask) == 0xF; }
+
+/// Horizontal sum, broadcast to all lanes
+inline float4 hsum(float4 const& a) noexcept {
+	float4 t = a + shuffle<1, 0, 3, 2>(a);
+	return t + shuffle<2, 3, 0, 1>(t);
+}
+
+/// 4 component dot product, broadcast to all lanes
+inline float4 dot4(float4 const& a, float4 const& b) noexcept {
+#if defined(STX_MATH_SSE41)
+	return _mm_dp_ps(a.v, b.v, 0xFF);
+#else
+	return hsum(a * b);
+#endif
+}
+
+/// Transposes the 4x4 matrix in rows a, b, c, d in place
+inline void transpose(float4& a, float4& b, float4& c, float4& d) noexcept {
+	float4 t0 = unpacklo(a, b);
+	float4 t1 = unpacklo(c, d);
+	float4 t2 = unpackhi(a, b);
+	float4 t3 = unpackhi(c, d);
+	a = shuffle<0, 1, 0, 1>(t0, t1);
+	b = shuffle<2, 3, 2, 3>(t0, t1);
+	c = shuffle<0, 1, 0, 1>(t2, t3);
+	d = shuffle<2, 3, 2, 3>(t2, t3);
+}
+
+/// Splits 4 consecutive xyz triples (a, b, c = 12 floats) into (x0..x3), (y0..y3), (z0..z3)
+inline void deinterleave3(float4 const& a, float4 const& b, float4 const& c, float4& x, float4& y, float4& z) noexcept {
+	float4 const s = shuffle<1, 2, 0, 1>(a, b); // a1 a2 b0 b1
+	float4 const t = shuffle<2, 3, 1, 2>(b, c); // b2 b3 c1 c2
+	x = shuffle<0, 3, 0, 2>(a, t);
+	y = shuffle<0, 2, 1, 3>(s, t);
+	z = shuffle<1, 3, 0, 3>(s, c);
+}
+
+/// Inverse of deinterleave3
+inline void interleave3(float4 const& x, float4 const& y, float4 const& z, float4& a, float4& b, float4& c) noexcept {
+	a = shuffle<0, 2, 0, 2>(shuffle<0, 1, 0, 1>(x, y), shuffle<0, 0, 1, 1>(z, x));
+	b = shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y));
+	c = shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z));
+}
+
+// -- 8 lanes -----------------------------------------------------------------------------
+
+#if defined(STX_MATH_AVX)
+
+/// Eight float lanes, one AVX register. @ingroup stxmath
+struct float8 {
+	__m256 v;
+
+	float8() = default;
+	float8(__m256 const& v) noexcept : v(v) {}
+	explicit float8(float f) noexcept : v(_mm256_set1_ps(f)) {}
+	float8(float4 const& lo, float4 const& hi) noexcept : v(_mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1)) {}
+
+	static float8 zero() noexcept { return float8(0.f); }
+
+	static float8 load(float const* p) noexcept { return _mm256_loadu_ps(p); }
+	/// p must be 32 byte aligned
+	static float8 load_aligned(float const* p) noexcept { return _mm256_load_ps(p); }
+
+	void store(float* p) const noexcept { _mm256_storeu_ps(p, v); }
+	void store_aligned(float* p) const noexcept { _mm256_store_ps(p, v); }
+	/// p must be 32 byte aligned
+	void stream(float* p) const noexcept { _mm256_stream_ps(p, v); }
+
+	float4 lo() const noexcept { return _mm256_castps256_ps128(v); }
+	float4 hi() const noexcept { return _mm256_extractf128_ps(v, 1); }
+
+	float operator[](unsigned i) const noexcept {
+		float tmp[8];
+		store(tmp);
+		return tmp[i];
+	}
+};
+
+inline float8 operator+(float8 const& a, float8 const& b) noexcept { return _mm256_add_ps(a.v, b.v); }
+inline float8 operator-(float8 const& a, float8 const& b) noexcept { return _mm256_sub_ps(a.v, b.v); }
+inline float8 operator*(float8 const& a, float8 const& b) noexcept { return _mm256_mul_ps(a.v, b.v); }
+inline float8 operator/(float8 const& a, float8 const& b) noexcept { return _mm256_div_ps(a.v, b.v); }
+inline float8 operator-(float8 const& a) noexcept { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.f)); }
+
+inline float8 operator< (float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline float8 operator<=(float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline float8 operator> (float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline float8 operator>=(float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+inline float8 operator==(float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+inline float8 operator!=(float8 const& a, float8 const& b) noexcept { return _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ); }
+
+inline float8 operator&(float8 const& a, float8 const& b) noexcept { return _mm256_and_ps(a.v, b.v); }
+inline float8 operator|(float8 const& a, float8 const& b) noexcept { return _mm256_or_ps(a.v, b.v); }
+inline float8 operator^(float8 const& a, float8 const& b) noexcept { return _mm256_xor_ps(a.v, b.v); }
+/// a & ~b
+inline float8 andnot(float8 const& a, float8 const& b) noexcept { return _mm256_andnot_ps(b.v, a.v); }
+
+inline float8 min (float8 const& a, float8 const& b) noexcept { return _mm256_min_ps(a.v, b.v); }
+inline float8 max (float8 const& a, float8 const& b) noexcept { return _mm256_max_ps(a.v, b.v); }
+inline float8 sqrt(float8 const& a) noexcept { return _mm256_sqrt_ps(a.v); }
+/// 1 / sqrt(a) from the hardware estimate and one Newton step, relative error below 5e-7
+inline float8 rsqrt(float8 const& a) noexcept {
+	__m256 const r = _mm256_rsqrt_ps(a.v);
+	__m256 const e = _mm256_mul_ps(_mm256_mul_ps(a.v, r), r);
+	return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), r), _mm256_sub_ps(_mm256_set1_ps(3.f), e));
+}
+
+/// a * b + c. Fused (single rounding) when compiled with FMA support.
+inline float8 madd(float8 const& a, float8 const& b, float8 const& c) noexcept {
+#if defined(STX_MATH_FMA)
+	return _mm256_fmadd_ps(a.v, b.v, c.v);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v);
+#endif
+}
+
+/// Lanes of a where mask is set, lanes of b otherwise
+inline float8 select(float8 const& mask, float8 const& a, float8 const& b) noexcept { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+/// The sign bits of all lanes, lane 0 in bit 0
+inline int movemask(float8 const& a) noexcept { return _mm256_movemask_ps(a.v); }
+
+inline float first(float8 const& a) noexcept { return _mm256_cvtss_f32(a.v); }
+
+#else // Two float4
+
+/// Eight float lanes, emulated with two float4 without AVX. @ingroup stxmath
+struct float8 {
+	float4 a, b;
+
+	float8() = default;
+	explicit float8(float f) noexcept : a(f), b(f) {}
+	float8(float4 const& lo, float4 const& hi) noexcept : a(lo), b(hi) {}
+
+	static float8 zero() noexcept { return float8(0.f); }
+
+	static float8 load(float const* p) noexcept { return float8(float4::load(p), float4::load(p + 4)); }
+	/// p must be 32 byte aligned
+	static float8 load_aligned(float const* p) noexcept { return float8(float4::load_aligned(p), float4::load_aligned(p + 4)); }
+
+	void store(float* p) const noexcept { a.store(p); b.store(p + 4); }
+	void store_aligned(float* p) const noexcept { a.store_aligned(p); b.store_aligned(p + 4); }
+	/// p must be 32 byte aligned
+	void stream(float* p) const noexcept { a.stream(p); b.stream(p + 4); }
+
+	float4 lo() const noexcept { return a; }
+	float4 hi() const noexcept { return b; }
+
+	float operator[](unsigned i) const noexcept { return i < 4 ? a[i] : b[i - 4]; }
+};
+
+inline float8 operator+(float8 const& a, float8 const& b) noexcept { return float8(a.a + b.a, a.b + b.b); }
+inline float8 operator-(float8 const& a, float8 const& b) noexcept { return float8(a.a - b.a, a.b - b.b); }
+inline float8 operator*(float8 const& a, float8 const& b) noexcept { return float8(a.a * b.a, a.b * b.b); }
+inline float8 operator/(float8 const& a, float8 const& b) noexcept { return float8(a.a / b.a, a.b / b.b); }
+inline float8 operator-(float8 const& a) noexcept { return float8(-a.a, -a.b); }
+
+inline float8 operator< (float8 const& a, float8 const& b) noexcept { return float8(a.a <  b.a, a.b <  b.b); }
+inline float8 operator<=(float8 const& a, float8 const& b) noexcept { return float8(a.a <= b.a, a.b <= b.b); }
+inline float8 operator> (float8 const& a, float8 const& b) noexcept { return float8(a.a >  b.a, a.b >  b.b); }
+inline float8 operator>=(float8 const& a, float8 const& b) noexcept { return float8(a.a >= b.a, a.b >= b.b); }
+inline float8 operator==(float8 const& a, float8 const& b) noexcept { return float8(a.a == b.a, a.b == b.b); }
+inline float8 operator!=(float8 const& a, float8 const& b) noexcept { return float8(a.a != b.a, a.b != b.b); }
+
+inline float8 operator&(float8 const& a, float8 const& b) noexcept { return float8(a.a & b.a, a.b & b.b); }
+inline float8 operator|(float8 const& a, float8 const& b) noexcept { return float8(a.a | b.a, a.b | b.b); }
+inline float8 operator^(float8 const& a, float8 const& b) noexcept { return float8(a.a ^ b.a, a.b ^ b.b); }
+/// a & ~b
+inline float8 andnot(float8 const& a, float8 const& b) noexcept { return float8(andnot(a.a, b.a), andnot(a.b, b.b)); }
+
+inline float8 min (float8 const& a, float8 const& b) noexcept { return float8(min(a.a, b.a), min(a.b, b.b)); }
+inline float8 max (float8 const& a, float8 const& b) noexcept { return float8(max(a.a, b.a), max(a.b, b.b)); }
+inline float8 sqrt(float8 const& a) noexcept { return float8(sqrt(a.a), sqrt(a.b)); }
+inline float8 rsqrt(float8 const& a) noexcept { return float8(rsqrt(a.a), rsqrt(a.b)); }
+
+/// a * b + c
+inline float8 madd(float8 const& a, float8 const& b, float8 const& c) noexcept { return float8(madd(a.a, b.a, c.a), madd(a.b, b.b, c.b)); }
+
+/// Lanes of a where mask is set, lanes of b otherwise
+inline float8 select(float8 const& mask, float8 const& a, float8 const& b) noexcept { return float8(select(mask.a, a.a, b.a), select(mask.b, a.b, b.b)); }
+
+/// The sign bits of all lanes, lane 0 in bit 0
+inline int movemask(float8 const& a) noexcept { return movemask(a.a) | (movemask(a.b) << 4); }
+
+inline float first(float8 const& a) noexcept { return first(a.a); }
+
+#endif
+
+inline float8& operator+=(float8& a, float8 const& b) noexcept { return a = a + b; }
+inline float8& operator-=(float8& a, float8 const& b) noexcept { return a = a - b; }
+inline float8& operator*=(float8& a, float8 const& b) noexcept { return a = a * b; }
+inline float8& operator/=(float8& a, float8 const& b) noexcept { return a = a / b; }
+
+/// c - a * b
+inline float8 nmadd(float8 const& a, float8 const& b, float8 const& c) noexcept { return c - a * b; }
+
+inline float8 abs(float8 const& a) noexcept { return andnot(a, float8(-0.f)); }
+
+/// Flips the sign of a where the sign bit of s is set
+inline float8 xorsign(float8 const& a, float8 const& s) noexcept { return a ^ (s & float8(-0.f)); }
+
+inline bool any(float8 const& mask) noexcept { return movemask(mask) != 0; }
+inline bool all(float8 const& mask) noexcept { return movemask(mask) == 0xFF; }
+
+// -- 4 double lanes ----------------------------------------------------------------------
+
+#if defined(STX_MATH_AVX)
+
+/// Four double lanes, one AVX register. @ingroup stxmath
+struct double4 {
+	__m256d v;
+
+	double4() = default;
+	double4(__m256d const& v) noexcept : v(v) {}
+	explicit double4(double f) noexcept : v(_mm256_set1_pd(f)) {}
+
+	static double4 load(double const* p) noexcept { return _mm256_loadu_pd(p); }
+	void store(double* p) const noexcept { _mm256_storeu_pd(p, v); }
+};
+
+inline double4 operator+(double4 const& a, double4 const& b) noexcept { return _mm256_add_pd(a.v, b.v); }
+inline double4 operator-(double4 const& a, double4 const& b) noexcept { return _mm256_sub_pd(a.v, b.v); }
+inline double4 operator*(double4 const& a, double4 const& b) noexcept { return _mm256_mul_pd(a.v, b.v); }
+inline double4 operator/(double4 const& a, double4 const& b) noexcept { return _mm256_div_pd(a.v, b.v); }
+inline double4 operator-(double4 const& a) noexcept { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.)); }
+
+/// a * b + c. Fused (single rounding) when compiled with FMA support.
+inline double4 madd(double4 const& a, double4 const& b, double4 const& c) noexcept {
+#if defined(STX_MATH_FMA)
+	return _mm256_fmadd_pd(a.v, b.v, c.v);
+#else
+	return _mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v);
+#endif
+}
+
+#else // Two double pairs
+
+namespace detail {
+
+// Two double lanes, the halves of double4
+#if defined(STX_MATH_SSE)
+using native2d = __m128d;
+inline native2d set1(double f) noexcept { return _mm_set1_pd(f); }
+inline native2d load2(double const* p) noexcept { return _mm_loadu_pd(p); }
+inline void store2(native2d const& a, double* p) noexcept { _mm_storeu_pd(p, a); }
+inline native2d add(native2d const& a, native2d const& b) noexcept { return _mm_add_pd(a, b); }
+inline native2d sub(native2d const& a, native2d const& b) noexcept { return _mm_sub_pd(a, b); }
+inline native2d mul(native2d const& a, native2d const& b) noexcept { return _mm_mul_pd(a, b); }
+inline native2d div(native2d const& a, native2d const& b) noexcept { return _mm_div_pd(a, b); }
+inline native2d neg(native2d const& a) noexcept { return _mm_xor_pd(a, _mm_set1_pd(-0.)); }
+inline native2d madd(native2d const& a, native2d const& b, native2d const& c) noexcept {
+#if defined(STX_MATH_FMA)
+	return _mm_fmadd_pd(a, b, c);
+#else
+	return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+}
+#elif defined(STX_MATH_NEON) && defined(__aarch64__)
+using native2d = float64x2_t;
+inline native2d set1(double f) noexcept { return vdupq_n_f64(f); }
+inline native2d load2(double const* p) noexcept { return vld1q_f64(p); }
+inline void store2(native2d const& a, double* p) noexcept { vst1q_f64(p, a); }
+inline native2d add(native2d const& a, native2d const& b) noexcept { return vaddq_f64(a, b); }
+inline native2d sub(native2d const& a, native2d const& b) noexcept { return vsubq_f64(a, b); }
+inline native2d mul(native2d const& a, native2d const& b) noexcept { return vmulq_f64(a, b); }
+inline native2d div(native2d const& a, native2d const& b) noexcept { return vdivq_f64(a, b); }
+inline native2d neg(native2d const& a) noexcept { return vnegq_f64(a); }
+inline native2d madd(native2d const& a, native2d const& b, native2d const& c) noexcept { return vfmaq_f64(c, a, b); }
+#else
+struct native2d { double v[2]; };
+inline native2d set1(double f) noexcept { return native2d{{ f, f }}; }
+inline native2d load2(double const* p) noexcept { return native2d{{ p[0], p[1] }}; }
+inline void store2(native2d const& a, double* p) noexcept { p[0] = a.v[0]; p[1] = a.v[1]; }
+inline native2d add(native2d const& a, native2d const& b) noexcept { return native2d{{ a.v[0] + b.v[0], a.v[1] + b.v[1] }}; }
+inline native2d sub(native2d const& a, native2d const& b) noexcept { return native2d{{ a.v[0] - b.v[0], a.v[1] - b.v[1] }}; }
+inline native2d mul(native2d const& a, native2d const& b) noexcept { return native2d{{ a.v[0] * b.v[0], a.v[1] * b.v[1] }}; }
+inline native2d div(native2d const& a, native2d const& b) noexcept { return native2d{{ a.v[0] / b.v[0], a.v[1] / b.v[1] }}; }
+inline native2d neg(native2d const& a) noexcept { return native2d{{ -a.v[0], -a.v[1] }}; }
+inline native2d madd(native2d const& a, native2d const& b, native2d const& c) noexcept { return add(mul(a, b), c); }
+#endif
+
+} // namespace detail
+
+/// Four double lanes, two SSE2/NEON registers without AVX (emulated with plain doubles on 32 bit ARM and without STX_MATH_SIMD). @ingroup stxmath
+struct double4 {
+	detail::native2d a, b;
+
+	double4() = default;
+	double4(detail::native2d const& lo, detail::native2d const& hi) noexcept : a(lo), b(hi) {}
+	explicit double4(double f) noexcept : a(detail::set1(f)), b(detail::set1(f)) {}
+
+	static double4 load(double const* p) noexcept { return double4(detail::load2(p), detail::load2(p + 2)); }
+	void store(double* p) const noexcept { detail::store2(a, p); detail::store2(b, p + 2); }
+};
+
+inline double4 operator+(double4 const& a, double4 const& b) noexcept { return double4(detail::add(a.a, b.a), detail::add(a.b, b.b)); }
+inline double4 operator-(double4 const& a, double4 const& b) noexcept { return double4(detail::sub(a.a, b.a), detail::sub(a.b, b.b)); }
+inline double4 operator*(double4 const& a, double4 const& b) noexcept { return double4(detail::mul(a.a, b.a), detail::mul(a.b, b.b)); }
+inline double4 operator/(double4 const& a, double4 const& b) noexcept { return double4(detail::div(a.a, b.a), detail::div(a.b, b.b)); }
+inline double4 operator-(double4 const& a) noexcept { return double4(detail::neg(a.a), detail::neg(a.b)); }
+
+/// a * b + c
+inline double4 madd(double4 const& a, double4 const& b, double4 const& c) noexcept { return double4(detail::madd(a.a, b.a, c.a), detail::madd(a.b, b.b, c.b)); }
+
+#endif
+
+/// Number of lanes of a float4 / float8
+template<typename F> struct lanes;
+template<> struct lanes<float4> { static constexpr unsigned value = 4; };
+template<> struct lanes<float8> { static constexpr unsigned value = 8; };
+
+} // namespace simd
+
+} // namespace stx
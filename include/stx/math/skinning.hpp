@@ -0,0 +1,168 @@
+#pragma once
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat4.hpp"
+#include "transform.hpp"
+#include "dualquat.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stx {
+
+/// A bone transform as the upper three rows of a mat4, row major, see affine3.
+/// Each row is dotted with (x, y, z, 1), which takes 48 instead of 64 bytes per bone. @ingroup stxmath
+using skin_matrix = affine3;
+
+/// Up to four bones influencing a vertex. Unused influences need a weight of 0 and a valid bone index (e.g. 0).
+/// The weights of a vertex should sum up to 1. @ingroup stxmath
+struct skin_influences {
+	uint16_t bone[4];
+	float    weight[4];
+};
+
+/// Vertex streams read and written by the skinning functions. @ingroup stxmath
+/// Normals and tangents are optional, leave both the input and output null to skip them.
+/// Outputs may be the same arrays as the inputs. Tangents keep their handedness in w.
+struct skin_streams {
+	vec3 const* positions     = nullptr;
+	vec3 const* normals       = nullptr;
+	vec4 const* tangents      = nullptr;
+	vec3*       out_positions = nullptr;
+	vec3*       out_normals   = nullptr;
+	vec4*       out_tangents  = nullptr;
+};
+
+/// Vertices per thread below which skinning isn't split any further @ingroup stxmath
+constexpr size_t skin_grain = 2048;
+
+namespace detail {
+
+inline simd::float4 load3(vec3 const& v, float w) noexcept { return simd::float4(v.x, v.y, v.z, w); }
+
+inline vec3 store3(simd::float4 const& v) noexcept {
+	float tmp[4];
+	v.store(tmp);
+	return vec3(tmp[0], tmp[1], tmp[2]);
+}
+
+/// (dot(r0, v), dot(r1, v), dot(r2, v), 0)
+inline simd::float4 mul_rows(simd::float4 const& r0, simd::float4 const& r1, simd::float4 const& r2, simd::float4 const& v) noexcept {
+	simd::float4 a = r0 * v, b = r1 * v, c = r2 * v, d = simd::float4::zero();
+	simd::transpose(a, b, c, d);
+	return (a + b) + (c + d);
+}
+
+inline simd::float4 normalize3(simd::float4 const& v) noexcept {
+	return v / simd::sqrt(simd::dot4(v, v));
+}
+
+/// Cross product of the x, y, z parts of two quaternions stored as (w, x, y, z), lane 0 is zero
+inline simd::float4 cross_wxyz(simd::float4 const& a, simd::float4 const& b) noexcept {
+	return
+		simd::shuffle<0, 2, 3, 1>(a) * simd::shuffle<0, 3, 1, 2>(b) -
+		simd::shuffle<0, 3, 1, 2>(a) * simd::shuffle<0, 2, 3, 1>(b);
+}
+
+/// Rotates v = (0, x, y, z) by the unit quaternion q = (w, x, y, z)
+inline simd::float4 rotate_wxyz(simd::float4 const& q, simd::float4 const& v) noexcept {
+	simd::float4 const t = cross_wxyz(q, v) * simd::float4(2.f);
+	return v + simd::madd(simd::splat<0>(q), t, cross_wxyz(q, t));
+}
+
+inline
+void skin_linear_range(skin_matrix const* palette, skin_influences const* influences, skin_streams const& s, size_t first, size_t last) noexcept {
+	using simd::float4;
+
+	for(size_t i = first; i < last; i++) {
+		skin_influences const& inf = influences[i];
+
+		// Blend the matrices, then transform once
+		float4 r0 = float4(0.f), r1 = float4(0.f), r2 = float4(0.f);
+		for(unsigned k = 0; k < 4; k++) {
+			skin_matrix const& m = palette[inf.bone[k]];
+			float4 const w(inf.weight[k]);
+			r0 = simd::madd(float4::load(m.rows[0].xyzw), w, r0);
+			r1 = simd::madd(float4::load(m.rows[1].xyzw), w, r1);
+			r2 = simd::madd(float4::load(m.rows[2].xyzw), w, r2);
+		}
+
+		if(s.positions) s.out_positions[i] = store3(mul_rows(r0, r1, r2, load3(s.positions[i], 1)));
+		if(s.normals)   s.out_normals[i]   = store3(normalize3(mul_rows(r0, r1, r2, load3(s.normals[i], 0))));
+		if(s.tangents) {
+			vec3 const t = store3(normalize3(mul_rows(r0, r1, r2, float4(s.tangents[i].x, s.tangents[i].y, s.tangents[i].z, 0))));
+			s.out_tangents[i] = vec4(t.x, t.y, t.z, s.tangents[i].w);
+		}
+	}
+}
+
+inline
+void skin_dual_quat_range(dualquat const* palette, skin_influences const* influences, skin_streams const& s, size_t first, size_t last) noexcept {
+	using simd::float4;
+
+	for(size_t i = first; i < last; i++) {
+		skin_influences const& inf = influences[i];
+
+		// Blend along the shorter path relative to the first bone, then normalize
+		float4 const pivot = float4::load(palette[inf.bone[0]].real.wxyz);
+		float4 real = float4(0.f), dual = float4(0.f);
+		for(unsigned k = 0; k < 4; k++) {
+			dualquat const& q = palette[inf.bone[k]];
+			float4 const r = float4::load(q.real.wxyz);
+			float4 const w = simd::xorsign(float4(inf.weight[k]), simd::dot4(pivot, r));
+			real = simd::madd(r, w, real);
+			dual = simd::madd(float4::load(q.dual.wxyz), w, dual);
+		}
+		float4 const inv_length = float4(1.f) / simd::sqrt(simd::dot4(real, real));
+		real = real * inv_length;
+		dual = dual * inv_length;
+
+		if(s.positions) {
+			// translation = 2 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz))
+			float4 const translation = float4(2.f) * (simd::nmadd(simd::splat<0>(dual), real, simd::splat<0>(real) * dual) + cross_wxyz(real, dual));
+			vec3 const& p = s.positions[i];
+			float4 const r = rotate_wxyz(real, float4(0, p.x, p.y, p.z)) + translation;
+			float tmp[4];
+			r.store(tmp);
+			s.out_positions[i] = vec3(tmp[1], tmp[2], tmp[3]);
+		}
+		if(s.normals) {
+			vec3 const& n = s.normals[i];
+			float tmp[4];
+			rotate_wxyz(real, float4(0, n.x, n.y, n.z)).store(tmp);
+			s.out_normals[i] = vec3(tmp[1], tmp[2], tmp[3]);
+		}
+		if(s.tangents) {
+			vec4 const& t = s.tangents[i];
+			float tmp[4];
+			rotate_wxyz(real, float4(0, t.x, t.y, t.z)).store(tmp);
+			s.out_tangents[i] = vec4(tmp[1], tmp[2], tmp[3], t.w);
+		}
+	}
+}
+
+} // namespace detail
+
+/// Linear blend skinning: blends the bone matrices by weight and transforms each vertex by the result.
+/// Normals and tangents are transformed by the same matrix and renormalized, which is exact for rotations and uniform scale.
+/// Splits the vertices across threads in chunks of at least skin_grain. @ingroup stxmath
+inline
+void skin_linear(skin_matrix const* palette, skin_influences const* influences, size_t n, skin_streams const& streams, unsigned threads = thread_count()) {
+	parallel_for(0, n, skin_grain, [&](size_t first, size_t last) {
+		detail::skin_linear_range(palette, influences, streams, first, last);
+	}, threads);
+}
+
+/// Dual quaternion skinning: blends the bones' dual quaternions, which keeps joints from collapsing
+/// when bones twist, at the price of supporting rigid bones only (no scale). @ingroup stxmath
+inline
+void skin_dual_quat(dualquat const* palette, skin_influences const* influences, size_t n, skin_streams const& streams, unsigned threads = thread_count()) {
+	parallel_for(0, n, skin_grain, [&](size_t first, size_t last) {
+		detail::skin_dual_quat_range(palette, influences, streams, first, last);
+	}, threads);
+}
+
+} // namespace stx
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace stx {
+
+// =============================================================
+// == AoS <-> SoA =============================================
+// =============================================================
+
+namespace detail {
+
+inline void load_aos(vec3 const* p, simd::float4& x, simd::float4& y, simd::float4& z) noexcept {
+	using simd::float4;
+	float const* f = p->xyz;
+	simd::deinterleave3(float4::load(f), float4::load(f + 4), float4::load(f + 8), x, y, z);
+}
+inline void load_aos(vec3 const* p, simd::float8& x, simd::float8& y, simd::float8& z) noexcept {
+	simd::float4 x0, y0, z0, x1, y1, z1;
+	load_aos(p,     x0, y0, z0);
+	load_aos(p + 4, x1, y1, z1);
+	x = simd::float8(x0, x1);
+	y = simd::float8(y0, y1);
+	z = simd::float8(z0, z1);
+}
+
+inline void store_aos(vec3* p, simd::float4 const& x, simd::float4 const& y, simd::float4 const& z) noexcept {
+	simd::float4 a, b, c;
+	simd::interleave3(x, y, z, a, b, c);
+	float* f = p->xyz;
+	a.store(f);
+	b.store(f + 4);
+	c.store(f + 8);
+}
+inline void store_aos(vec3* p, simd::float8 const& x, simd::float8 const& y, simd::float8 const& z) noexcept {
+	store_aos(p,     x.lo(), y.lo(), z.lo());
+	store_aos(p + 4, x.hi(), y.hi(), z.hi());
+}
+
+/// Runs kernel(in, out) over groups of 4, the tail goes through padded copies so it gets the same treatment
+template<class In, class Out, class Kernel>
+inline void batch4(In const* in, Out* out, size_t n, In const& pad, Kernel kernel) noexcept {
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) kernel(in + i, out + i);
+	if(i < n) {
+		In  tmp_in[4] = { pad, pad, pad, pad };
+		Out tmp_out[4];
+		std::copy(in + i, in + n, tmp_in);
+		kernel(tmp_in, tmp_out);
+		std::copy(tmp_out, tmp_out + (n - i), out + i);
+	}
+}
+
+} // namespace detail
+
+/// Splits n vec3 into separate x, y and z arrays. @ingroup stxmath
+inline
+void aos_to_soa(vec3 const* in, size_t n, float* x, float* y, float* z) noexcept {
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		simd::float4 px, py, pz;
+		detail::load_aos(in + i, px, py, pz);
+		px.store(x + i);
+		py.store(y + i);
+		pz.store(z + i);
+	}
+	for(; i < n; i++) {
+		x[i] = in[i].x;
+		y[i] = in[i].y;
+		z[i] = in[i].z;
+	}
+}
+
+/// Interleaves separate x, y and z arrays into n vec3. @ingroup stxmath
+inline
+void soa_to_aos(float const* x, float const* y, float const* z, size_t n, vec3* out) noexcept {
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		detail::store_aos(out + i, simd::float4::load(x + i), simd::float4::load(y + i), simd::float4::load(z + i));
+	}
+	for(; i < n; i++) {
+		out[i] = vec3(x[i], y[i], z[i]);
+	}
+}
+
+/// Splits n vec4 into separate x, y, z and w arrays. @ingroup stxmath
+inline
+void aos_to_soa(vec4 const* in, size_t n, float* x, float* y, float* z, float* w) noexcept {
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		simd::float4 a = simd::float4::load(in[i + 0].xyzw);
+		simd::float4 b = simd::float4::load(in[i + 1].xyzw);
+		simd::float4 c = simd::float4::load(in[i + 2].xyzw);
+		simd::float4 d = simd::float4::load(in[i + 3].xyzw);
+		simd::transpose(a, b, c, d);
+		a.store(x + i);
+		b.store(y + i);
+		c.store(z + i);
+		d.store(w + i);
+	}
+	for(; i < n; i++) {
+		x[i] = in[i].x;
+		y[i] = in[i].y;
+		z[i] = in[i].z;
+		w[i] = in[i].w;
+	}
+}
+
+/// Interleaves separate x, y, z and w arrays into n vec4. @ingroup stxmath
+inline
+void soa_to_aos(float const* x, float const* y, float const* z, float const* w, size_t n, vec4* out) noexcept {
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		simd::float4 a = simd::float4::load(x + i);
+		simd::float4 b = simd::float4::load(y + i);
+		simd::float4 c = simd::float4::load(z + i);
+		simd::float4 d = simd::float4::load(w + i);
+		simd::transpose(a, b, c, d);
+		a.store(out[i + 0].xyzw);
+		b.store(out[i + 1].xyzw);
+		c.store(out[i + 2].xyzw);
+		d.store(out[i + 3].xyzw);
+	}
+	for(; i < n; i++) {
+		out[i] = vec4(x[i], y[i], z[i], w[i]);
+	}
+}
+
+// =============================================================
+// == Packets =============================================
+// =============================================================
+
+/// 4 or 8 vec3 with one SIMD lane per vector, see vec3x4 and vec3x8.
+/// Mirrors the operations of vec3, scalar results become one lane each and comparisons become lane masks. @ingroup stxmath
+template<typename F>
+class vec3_packet {
+public:
+	constexpr static unsigned width = simd::lanes<F>::value;
+
+	F x, y, z;
+
+	vec3_packet() = default;
+
+	explicit
+	vec3_packet(float f) noexcept :
+		x(f), y(f), z(f)
+	{}
+
+	explicit
+	vec3_packet(vec3 const& v) noexcept :
+		x(v.x), y(v.y), z(v.z)
+	{}
+
+	vec3_packet(F const& x, F const& y, F const& z) noexcept :
+		x(x), y(y), z(z)
+	{}
+
+	/// Loads `width` consecutive vec3
+	static vec3_packet load(vec3 const* p) noexcept {
+		vec3_packet result;
+		detail::load_aos(p, result.x, result.y, result.z);
+		return result;
+	}
+
+	/// Loads `width` vectors from separate x, y and z arrays
+	static vec3_packet load(float const* x, float const* y, float const* z) noexcept {
+		return vec3_packet(F::load(x), F::load(y), F::load(z));
+	}
+
+	/// Stores `width` consecutive vec3
+	void store(vec3* p) const noexcept { detail::store_aos(p, x, y, z); }
+
+	/// Stores `width` vectors to separate x, y and z arrays
+	void store(float* px, float* py, float* pz) const noexcept {
+		x.store(px);
+		y.store(py);
+		z.store(pz);
+	}
+
+	vec3 lane(unsigned i) const noexcept { return vec3(x[i], y[i], z[i]); }
+
+	vec3_packet operator+(vec3_packet const& o) const noexcept { return vec3_packet(x + o.x, y + o.y, z + o.z); }
+	vec3_packet operator-(vec3_packet const& o) const noexcept { return vec3_packet(x - o.x, y - o.y, z - o.z); }
+	vec3_packet operator*(vec3_packet const& o) const noexcept { return vec3_packet(x * o.x, y * o.y, z * o.z); }
+	vec3_packet operator/(vec3_packet const& o) const noexcept { return vec3_packet(x / o.x, y / o.y, z / o.z); }
+
+	vec3_packet operator*(F const& f) const noexcept { return vec3_packet(x * f, y * f, z * f); }
+	vec3_packet operator/(F const& f) const noexcept { return vec3_packet(x / f, y / f, z / f); }
+
+	vec3_packet& operator+=(vec3_packet const& o) noexcept { return *this = *this + o; }
+	vec3_packet& operator-=(vec3_packet const& o) noexcept { return *this = *this - o; }
+	vec3_packet& operator*=(vec3_packet const& o) noexcept { return *this = *this * o; }
+	vec3_packet& operator/=(vec3_packet const& o) noexcept { return *this = *this / o; }
+
+	vec3_packet& operator*=(F const& f) noexcept { return *this = *this * f; }
+	vec3_packet& operator/=(F const& f) noexcept { return *this = *this / f; }
+
+	vec3_packet operator-() const noexcept { return vec3_packet(-x, -y, -z); }
+
+	/// Lane mask of equal vectors
+	F operator==(vec3_packet const& o) const noexcept { return (x == o.x) & (y == o.y) & (z == o.z); }
+	/// Lane mask of unequal vectors
+	F operator!=(vec3_packet const& o) const noexcept { return (x != o.x) | (y != o.y) | (z != o.z); }
+
+	vec3_packet cross(vec3_packet const& v) const noexcept {
+		return vec3_packet(
+			y * v.z - v.y * z,
+			z * v.x - v.z * x,
+			x * v.y - v.x * y
+		);
+	}
+
+	F dot(vec3_packet const& v) const noexcept { return simd::madd(z, v.z, simd::madd(y, v.y, x * v.x)); }
+	F length2()                 const noexcept { return dot(*this); }
+	F length()                  const noexcept { return simd::sqrt(length2()); }
+
+	vec3_packet normalize() const noexcept { return (*this) / length(); }
+
+	vec3_packet mix(vec3_packet const& other, F const& k) const noexcept {
+		return vec3_packet(
+			simd::madd(other.x - x, k, x),
+			simd::madd(other.y - y, k, y),
+			simd::madd(other.z - z, k, z)
+		);
+	}
+	vec3_packet mix(vec3_packet const& other, float k) const noexcept { return mix(other, F(k)); }
+
+	vec3_packet max(vec3_packet const& v) const noexcept { return vec3_packet(simd::max(x, v.x), simd::max(y, v.y), simd::max(z, v.z)); }
+	vec3_packet min(vec3_packet const& v) const noexcept { return vec3_packet(simd::min(x, v.x), simd::min(y, v.y), simd::min(z, v.z)); }
+	vec3_packet clamp(vec3_packet const& mn, vec3_packet const& mx) const noexcept { return min(mx).max(mn); }
+
+	/// Per lane the axis vec3::longest_axis() would return, as one lane mask per axis
+	vec3_packet longest_axis() const noexcept {
+		F const x_gt_y = x > y;
+		F const is_x   = x_gt_y & (x > z);
+		F const is_y   = andnot(y > z, x_gt_y);
+		F const all    = F(0.f) == F(0.f);
+		return vec3_packet(is_x, is_y, andnot(all, is_x | is_y));
+	}
+
+	/// Per lane the axis vec3::shortest_axis() would return, as one lane mask per axis
+	vec3_packet shortest_axis() const noexcept {
+		F const x_lt_y = x < y;
+		F const is_x   = x_lt_y & (x < z);
+		F const is_y   = andnot(y < z, x_lt_y);
+		F const all    = F(0.f) == F(0.f);
+		return vec3_packet(is_x, is_y, andnot(all, is_x | is_y));
+	}
+
+	/// Lanes of a where mask is set, lanes of b otherwise
+	static vec3_packet select(F const& mask, vec3_packet const& a, vec3_packet const& b) noexcept {
+		return vec3_packet(simd::select(mask, a.x, b.x), simd::select(mask, a.y, b.y), simd::select(mask, a.z, b.z));
+	}
+};
+
+/// 4 vec3 in one set of SSE/NEON registers. @ingroup stxmath
+using vec3x4 = vec3_packet<simd::float4>;
+/// 8 vec3 in one set of AVX registers (two SSE/NEON sets without AVX). @ingroup stxmath
+using vec3x8 = vec3_packet<simd::float8>;
+
+template<typename F> inline
+vec3_packet<F> operator*(F const& f, vec3_packet<F> const& v) noexcept { return v * f; }
+
+template<typename F> inline F dot    (vec3_packet<F> const& a, vec3_packet<F> const& b) noexcept { return a.dot(b); }
+template<typename F> inline F length2(vec3_packet<F> const& v) noexcept { return v.length2(); }
+template<typename F> inline F length (vec3_packet<F> const& v) noexcept { return v.length(); }
+
+template<typename F> inline
+vec3_packet<F> cross(vec3_packet<F> const& a, vec3_packet<F> const& b) noexcept { return a.cross(b); }
+
+template<typename F> inline
+vec3_packet<F> mix(vec3_packet<F> const& a, vec3_packet<F> const& b, F const& k) noexcept { return a.mix(b, k); }
+
+// =============================================================
+// == Containers =============================================
+// =============================================================
+
+/// A resizable array of vec3 stored as separate x, y and z arrays. @ingroup stxmath
+class vec3_soa {
+public:
+	std::vector<float> x, y, z;
+
+	vec3_soa() = default;
+
+	explicit
+	vec3_soa(size_t n) :
+		x(n), y(n), z(n)
+	{}
+
+	vec3_soa(vec3 const* v, size_t n) :
+		vec3_soa(n)
+	{
+		aos_to_soa(v, n, x.data(), y.data(), z.data());
+	}
+
+	size_t size()  const noexcept { return x.size(); }
+	bool   empty() const noexcept { return x.empty(); }
+
+	void resize(size_t n) {
+		x.resize(n);
+		y.resize(n);
+		z.resize(n);
+	}
+
+	void reserve(size_t n) {
+		x.reserve(n);
+		y.reserve(n);
+		z.reserve(n);
+	}
+
+	void clear() noexcept {
+		x.clear();
+		y.clear();
+		z.clear();
+	}
+
+	void push_back(vec3 const& v) {
+		x.push_back(v.x);
+		y.push_back(v.y);
+		z.push_back(v.z);
+	}
+
+	vec3 operator[](size_t i) const noexcept { return vec3(x[i], y[i], z[i]); }
+
+	void set(size_t i, vec3 const& v) noexcept {
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+	}
+
+	/// Copies all elements to out as vec3
+	void to_aos(vec3* out) const noexcept { soa_to_aos(x.data(), y.data(), z.data(), size(), out); }
+
+	/// Loads the packet starting at element i, i + Packet::width must be <= size()
+	template<typename Packet>
+	Packet packet(size_t i) const noexcept { return Packet::load(x.data() + i, y.data() + i, z.data() + i); }
+
+	/// Stores a packet starting at element i, i + Packet::width must be <= size()
+	template<typename Packet>
+	void store(size_t i, Packet const& p) noexcept { p.store(x.data() + i, y.data() + i, z.data() + i); }
+};
+
+/// A resizable array of vec4 stored as separate x, y, z and w arrays. @ingroup stxmath
+class vec4_soa {
+public:
+	std::vector<float> x, y, z, w;
+
+	vec4_soa() = default;
+
+	explicit
+	vec4_soa(size_t n) :
+		x(n), y(n), z(n), w(n)
+	{}
+
+	vec4_soa(vec4 const* v, size_t n) :
+		vec4_soa(n)
+	{
+		aos_to_soa(v, n, x.data(), y.data(), z.data(), w.data());
+	}
+
+	size_t size()  const noexcept { return x.size(); }
+	bool   empty() const noexcept { return x.empty(); }
+
+	void resize(size_t n) {
+		x.resize(n);
+		y.resize(n);
+		z.resize(n);
+		w.resize(n);
+	}
+
+	void reserve(size_t n) {
+		x.reserve(n);
+		y.reserve(n);
+		z.reserve(n);
+		w.reserve(n);
+	}
+
+	void clear() noexcept {
+		x.clear();
+		y.clear();
+		z.clear();
+		w.clear();
+	}
+
+	void push_back(vec4 const& v) {
+		x.push_back(v.x);
+		y.push_back(v.y);
+		z.push_back(v.z);
+		w.push_back(v.w);
+	}
+
+	vec4 operator[](size_t i) const noexcept { return vec4(x[i], y[i], z[i], w[i]); }
+
+	void set(size_t i, vec4 const& v) noexcept {
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+		w[i] = v.w;
+	}
+
+	/// Copies all elements to out as vec4
+	void to_aos(vec4* out) const noexcept { soa_to_aos(x.data(), y.data(), z.data(), w.data(), size(), out); }
+};
+
+} // namespace stx
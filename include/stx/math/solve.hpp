@@ -0,0 +1,97 @@
+#pragma once
+
+#include "vec3.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stx {
+
+/// Default tolerance of solve3(): systems whose |det| is below this times |a| * |b| * |c| count as singular. @ingroup stxmath
+/// The product of the column lengths is the determinant the columns would have if they were orthogonal,
+/// so the test doesn't depend on the scale of the system.
+constexpr float solve3_tolerance = 1e-6f;
+
+/// Solves the 3x3 systems a * x.x + b * x.y + c * x.z = d (columns a, b and c), one per lane. @ingroup stxmath
+/// Cramer's rule as triple products: the cross products b x c, c x a and a x b are the rows of the adjugate,
+/// which takes 3 cross products, 4 dot products and one division instead of four determinants.
+/// Returns the lane mask of near singular systems (see solve3_tolerance). Their x is zero instead of inf/nan.
+template<typename F> inline
+F solve3(vec3_packet<F> const& a, vec3_packet<F> const& b, vec3_packet<F> const& c, vec3_packet<F> const& d, vec3_packet<F>& x, float tolerance = solve3_tolerance) noexcept {
+	vec3_packet<F> const bc = b.cross(c);
+	vec3_packet<F> const ca = c.cross(a);
+	vec3_packet<F> const ab = a.cross(b);
+
+	// The lengths only scale the tolerance, the rsqrt estimate is precise enough and much cheaper than sqrt.
+	// Zero columns give nan bounds, which count as singular below.
+	F const a2 = a.length2(), b2 = b.length2(), c2 = c.length2();
+	F const det   = a.dot(bc);
+	F const bound = F(tolerance) * (a2 * simd::rsqrt(a2)) * (b2 * simd::rsqrt(b2)) * (c2 * simd::rsqrt(c2));
+	F const all   = F(0.f) == F(0.f);
+	// Written as not greater, so nan determinants count as singular as well
+	F const singular = andnot(all, simd::abs(det) > bound);
+
+	F const inverse_det = andnot(F(1.f) / select(singular, F(1.f), det), singular);
+	x = vec3_packet<F>(d.dot(bc) * inverse_det, d.dot(ca) * inverse_det, d.dot(ab) * inverse_det);
+	return singular;
+}
+
+/// Solves the n systems a[i] * x[i].x + b[i] * x[i].y + c[i] * x[i].z = d[i], 8 per iteration (one AVX register, or two SSE/NEON). @ingroup stxmath
+/// a, b, c and d need the same size, x is resized to it. singular may be null, otherwise it receives 1 for near singular
+/// systems (their x is zero) and 0 for the others. Returns the number of near singular systems.
+inline
+size_t solve3_batch(vec3_soa const& a, vec3_soa const& b, vec3_soa const& c, vec3_soa const& d, vec3_soa& x, uint8_t* singular = nullptr, float tolerance = solve3_tolerance) {
+	size_t const n = a.size();
+	x.resize(n);
+
+	size_t count = 0;
+	auto report = [&](size_t i, int mask, unsigned lanes) {
+		if(singular) {
+			for(unsigned k = 0; k < lanes; k++) singular[i + k] = (uint8_t) ((mask >> k) & 1);
+		}
+		for(; mask; mask &= mask - 1) count++;
+	};
+
+	size_t i = 0;
+	for(; i + 8 <= n; i += 8) {
+		vec3x8 result;
+		simd::float8 const mask = solve3(a.packet<vec3x8>(i), b.packet<vec3x8>(i), c.packet<vec3x8>(i), d.packet<vec3x8>(i), result, tolerance);
+		x.store(i, result);
+		report(i, simd::movemask(mask), 8);
+	}
+
+	if(i < n) {
+		// Pads the tail with identity systems
+		float in[12][8] = {};
+		for(unsigned k = 0; k < 8; k++) in[0][k] = in[4][k] = in[8][k] = 1;
+
+		vec3_soa const* sources[4] = { &a, &b, &c, &d };
+		for(unsigned s = 0; s < 4; s++) {
+			std::copy(sources[s]->x.begin() + i, sources[s]->x.end(), in[3 * s + 0]);
+			std::copy(sources[s]->y.begin() + i, sources[s]->y.end(), in[3 * s + 1]);
+			std::copy(sources[s]->z.begin() + i, sources[s]->z.end(), in[3 * s + 2]);
+		}
+
+		vec3x8 result;
+		int const mask = simd::movemask(solve3(
+			vec3x8::load(in[0], in[1],  in[2]),
+			vec3x8::load(in[3], in[4],  in[5]),
+			vec3x8::load(in[6], in[7],  in[8]),
+			vec3x8::load(in[9], in[10], in[11]),
+			result, tolerance));
+
+		float out[3][8];
+		result.store(out[0], out[1], out[2]);
+		size_t const rest = n - i;
+		std::copy(out[0], out[0] + rest, x.x.begin() + i);
+		std::copy(out[1], out[1] + rest, x.y.begin() + i);
+		std::copy(out[2], out[2] + rest, x.z.begin() + i);
+		report(i, mask, (unsigned) rest);
+	}
+
+	return count;
+}
+
+} // namespace stx
@@ -3,54 +3,264 @@
 #include "mat3.hpp"
 #include "mat4.hpp"
 #include "quat.hpp"
+#include "simd.hpp"
 
 namespace stx {
 
-/// Converts a quaternion to a 3x3 rotation matrix. @ingroup stxmath
-/// Adapted from java source: http://www.euclideanspace.com/maths/geometry/rotations/conversions/quaternionToMatrix/
+/// Converts a quaternion to a 3x3 rotation matrix, same as q.to_mat3(). @ingroup stxmath
+inline
 mat3 rotate(const quat& q) {
-	mat3 m;
-
-	float sqw = q.w * q.w;
-	float sqx = q.x * q.x;
-	float sqy = q.y * q.y;
-	float sqz = q.z * q.z;
-	m[0][0] = sqx - sqy - sqz + sqw; // since sqw + sqx + sqy + sqz =1
-	m[1][1] = -sqx + sqy - sqz + sqw;
-	m[2][2] = -sqx - sqy + sqz + sqw;
-
-	float tmp1 = q.x * q.y;
-	float tmp2 = q.z * q.w;
-	m[0][1] = 2.0 * (tmp1 + tmp2);
-	m[1][0] = 2.0 * (tmp1 - tmp2);
-
-	tmp1 = q.x * q.z;
-	tmp2 = q.y * q.w;
-	m[0][2] = 2.0 * (tmp1 - tmp2);
-	m[2][0] = 2.0 * (tmp1 + tmp2);
-
-	tmp1 = q1.y * q.z;
-	tmp2 = q1.x * q.w;
-	m[1][2] = 2.0 * (tmp1 + tmp2);
-	m[1][2] = 2.0 * (tmp1 - tmp2);
+	return q.to_mat3();
 }
 
 /// Generates a scaling 3x3 matrix. @ingroup stxmath
+constexpr inline
 mat3 scale(const vec3& v) {
-	return mat3 {
+	return mat3(
 		v.x, 0, 0,
 		0, v.y, 0,
 		0, 0, v.z
-	};
+	);
 }
 
+/// Generates a translation matrix. @ingroup stxmath
+constexpr inline
 mat4 translate(const vec3& v) {
-	return mat4 {
+	return mat4(
 		1, 0, 0, v.x,
 		0, 1, 0, v.y,
 		0, 0, 1, v.z,
 		0, 0, 0, 1
-	};
+	);
 }
 
+/// An affine transform as the upper three rows of a mat4, row major. Also known as mat3x4. @ingroup stxmath
+/// The last row of a mat4 is (0, 0, 0, 1) for rotations, scales and translations, leaving it out takes
+/// 48 instead of 64 bytes and 36 instead of 64 multiply-adds per product.
+/// Each row is dotted with (x, y, z, 1), so the rows can be uploaded as they are, e.g. as a vec4[3] uniform.
+class affine3 {
+public:
+	vec4 rows[3];
+
+	/// Identity
+	constexpr
+	affine3() :
+		rows{ vec4(1, 0, 0, 0), vec4(0, 1, 0, 0), vec4(0, 0, 1, 0) }
+	{}
+
+	constexpr
+	affine3(vec4 const& r0, vec4 const& r1, vec4 const& r2) :
+		rows{ r0, r1, r2 }
+	{}
+
+	constexpr // Row major, like the mat4 constructor
+	affine3(
+		float aa, float ab, float ac, float ad,
+		float ba, float bb, float bc, float bd,
+		float ca, float cb, float cc, float cd) :
+		rows{ vec4(aa, ab, ac, ad), vec4(ba, bb, bc, bd), vec4(ca, cb, cc, cd) }
+	{}
+
+	/// The linear part from m, followed by the translation t
+	constexpr explicit
+	affine3(mat3 const& m, vec3 const& t = vec3()) :
+		rows{
+			vec4(m.data[0], m.data[3], m.data[6], t.x),
+			vec4(m.data[1], m.data[4], m.data[7], t.y),
+			vec4(m.data[2], m.data[5], m.data[8], t.z)
+		}
+	{}
+
+	/// Drops the last row, which is (0, 0, 0, 1) for affine transforms
+	constexpr explicit
+	affine3(mat4 const& m) :
+		rows{
+			vec4(m[0][0], m[1][0], m[2][0], m[3][0]),
+			vec4(m[0][1], m[1][1], m[2][1], m[3][1]),
+			vec4(m[0][2], m[1][2], m[2][2], m[3][2])
+		}
+	{}
+
+	constexpr
+	mat4 to_mat4() const noexcept {
+		return mat4(
+			rows[0].x, rows[0].y, rows[0].z, rows[0].w,
+			rows[1].x, rows[1].y, rows[1].z, rows[1].w,
+			rows[2].x, rows[2].y, rows[2].z, rows[2].w,
+			        0,         0,         0,         1
+		);
+	}
+
+	/// The upper 3x3 part
+	constexpr
+	mat3 linear() const noexcept {
+		return mat3(
+			rows[0].x, rows[0].y, rows[0].z,
+			rows[1].x, rows[1].y, rows[1].z,
+			rows[2].x, rows[2].y, rows[2].z
+		);
+	}
+
+	constexpr
+	vec3 translation() const noexcept {
+		return vec3(rows[0].w, rows[1].w, rows[2].w);
+	}
+
+	constexpr
+	vec3 transform_point(vec3 const& p) const noexcept {
+		return vec3(
+			rows[0].x * p.x + rows[0].y * p.y + rows[0].z * p.z + rows[0].w,
+			rows[1].x * p.x + rows[1].y * p.y + rows[1].z * p.z + rows[1].w,
+			rows[2].x * p.x + rows[2].y * p.y + rows[2].z * p.z + rows[2].w
+		);
+	}
+
+	constexpr
+	vec3 transform_vector(vec3 const& v) const noexcept {
+		return vec3(
+			rows[0].x * v.x + rows[0].y * v.y + rows[0].z * v.z,
+			rows[1].x * v.x + rows[1].y * v.y + rows[1].z * v.z,
+			rows[2].x * v.x + rows[2].y * v.y + rows[2].z * v.z
+		);
+	}
+
+	/// Same as transform_point()
+	constexpr
+	vec3 operator*(vec3 const& p) const noexcept { return transform_point(p); }
+
+	/// Composition, (a * b).transform_point(p) == a.transform_point(b.transform_point(p)).
+	/// Each row of the result is a combination of b's rows: 9 vector multiply-adds, 36 scalar ones.
+	STX_SIMD_CONSTEXPR
+	affine3 operator*(affine3 const& b) const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		using simd::float4;
+
+		float4 const b0 = b.rows[0].to_simd();
+		float4 const b1 = b.rows[1].to_simd();
+		float4 const b2 = b.rows[2].to_simd();
+		float4 const translation_only(0.f, 0.f, 0.f, 1.f);
+
+		auto row = [&](float4 const& a) {
+			float4 r = a * translation_only;
+			r = simd::madd(simd::splat<0>(a), b0, r);
+			r = simd::madd(simd::splat<1>(a), b1, r);
+			r = simd::madd(simd::splat<2>(a), b2, r);
+			return vec4(r);
+		};
+		return affine3(row(rows[0].to_simd()), row(rows[1].to_simd()), row(rows[2].to_simd()));
+#else
+		return affine3(
+			b.rows[0] * rows[0].x + b.rows[1] * rows[0].y + b.rows[2] * rows[0].z + vec4(0, 0, 0, rows[0].w),
+			b.rows[0] * rows[1].x + b.rows[1] * rows[1].y + b.rows[2] * rows[1].z + vec4(0, 0, 0, rows[1].w),
+			b.rows[0] * rows[2].x + b.rows[1] * rows[2].y + b.rows[2] * rows[2].z + vec4(0, 0, 0, rows[2].w)
+		);
+#endif
+	}
+
+	affine3& operator*=(affine3 const& b) noexcept { return *this = *this * b; }
+
+	STX_SIMD_CONSTEXPR
+	bool operator==(affine3 const& other) const noexcept {
+		return rows[0] == other.rows[0] && rows[1] == other.rows[1] && rows[2] == other.rows[2];
+	}
+	STX_SIMD_CONSTEXPR
+	bool operator!=(affine3 const& other) const noexcept { return !(*this == other); }
+
+	/// The inverse transform. The upper 3x3 part is inverted via the adjugate, the result is undefined (inf/nan) if it is singular.
+	/// Use inverse_rigid() for pure rotations and translations.
+	affine3 inverse() const noexcept {
+#ifdef STX_MATH_HAS_SIMD
+		using simd::float4;
+
+		auto cross = [](float4 a, float4 b) {
+			return
+				simd::shuffle<1, 2, 0, 3>(a) * simd::shuffle<2, 0, 1, 3>(b) -
+				simd::shuffle<2, 0, 1, 3>(a) * simd::shuffle<1, 2, 0, 3>(b);
+		};
+
+		float4 const r0 = rows[0].to_simd();
+		float4 const r1 = rows[1].to_simd();
+		float4 const r2 = rows[2].to_simd();
+
+		// Columns of the inverse 3x3 part, times the determinant. w is zero, the products cancel exactly.
+		float4 c0 = cross(r1, r2);
+		float4 c1 = cross(r2, r0);
+		float4 c2 = cross(r0, r1);
+
+		float4 const inverse_det = float4(1.f) / simd::dot4(r0, c0);
+		c0 *= inverse_det;
+		c1 *= inverse_det;
+		c2 *= inverse_det;
+
+		// -inverse3 * t, becomes the w column after the transpose
+		float4 t = -(c0 * simd::splat<3>(r0) + c1 * simd::splat<3>(r1) + c2 * simd::splat<3>(r2));
+		simd::transpose(c0, c1, c2, t);
+		return affine3(vec4(c0), vec4(c1), vec4(c2));
+#else
+		vec3 const r0(rows[0].x, rows[0].y, rows[0].z);
+		vec3 const r1(rows[1].x, rows[1].y, rows[1].z);
+		vec3 const r2(rows[2].x, rows[2].y, rows[2].z);
+
+		float const inverse_det = 1 / r0.dot(r1.cross(r2));
+		vec3 const c0 = r1.cross(r2) * inverse_det;
+		vec3 const c1 = r2.cross(r0) * inverse_det;
+		vec3 const c2 = r0.cross(r1) * inverse_det;
+		vec3 const t  = -(c0 * rows[0].w + c1 * rows[1].w + c2 * rows[2].w);
+
+		return affine3(
+			c0.x, c1.x, c2.x, t.x,
+			c0.y, c1.y, c2.y, t.y,
+			c0.z, c1.z, c2.z, t.z
+		);
+#endif
+	}
+
+	/// The inverse of a rotation and translation without scale. The rotation part is simply transposed.
+	constexpr
+	affine3 inverse_rigid() const noexcept {
+		return affine3(
+			rows[0].x, rows[1].x, rows[2].x, -(rows[0].x * rows[0].w + rows[1].x * rows[1].w + rows[2].x * rows[2].w),
+			rows[0].y, rows[1].y, rows[2].y, -(rows[0].y * rows[0].w + rows[1].y * rows[1].w + rows[2].y * rows[2].w),
+			rows[0].z, rows[1].z, rows[2].z, -(rows[0].z * rows[0].w + rows[1].z * rows[1].w + rows[2].z * rows[2].w)
+		);
+	}
+
+	constexpr static
+	affine3 translation(vec3 const& t) noexcept {
+		return affine3(
+			1, 0, 0, t.x,
+			0, 1, 0, t.y,
+			0, 0, 1, t.z
+		);
+	}
+
+	constexpr static
+	affine3 scaling(vec3 const& s) noexcept {
+		return affine3(
+			s.x,   0,   0, 0,
+			  0, s.y,   0, 0,
+			  0,   0, s.z, 0
+		);
+	}
+
+	static
+	affine3 rotation(quat const& q) noexcept {
+		return affine3(q.to_mat3());
+	}
+
+	/// translation * rotation * scale, i.e. scales first, then rotates, then translates
+	static
+	affine3 compose(vec3 const& translation, quat const& rotation, vec3 const& scale = vec3(1)) noexcept {
+		mat3 const r = rotation.to_mat3();
+		return affine3(
+			r.data[0] * scale.x, r.data[3] * scale.y, r.data[6] * scale.z, translation.x,
+			r.data[1] * scale.x, r.data[4] * scale.y, r.data[7] * scale.z, translation.y,
+			r.data[2] * scale.x, r.data[5] * scale.y, r.data[8] * scale.z, translation.z
+		);
+	}
+};
+
+/// affine3 under the name of its shape, 3 rows by 4 columns @ingroup stxmath
+using mat3x4 = affine3;
+
 } // namespace stx
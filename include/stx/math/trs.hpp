@@ -0,0 +1,277 @@
+#pragma once
+
+#include "vec3.hpp"
+#include "quat.hpp"
+#include "mat3.hpp"
+#include "mat4.hpp"
+#include "transform.hpp"
+#include "batch.hpp"
+#include "soa.hpp"
+#include "simd.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+namespace stx {
+
+namespace detail {
+
+/// Squared lengths below this count as zero when decomposing
+constexpr float trs_tiny = 1e-30f;
+
+/// Whether v is long enough to normalize, relative to a squared reference length it was computed from
+inline bool usable(vec3 const& v, float reference2) noexcept { return v.length2() > 1e-12f * reference2 + trs_tiny; }
+
+/// Some vector perpendicular to v (any vector for a zero v), not normalized
+inline
+vec3 perpendicular(vec3 const& v) noexcept {
+	float const l2 = v.length2();
+	vec3 const axis = v.x * v.x < .81f * l2 ? vec3(1, 0, 0) : vec3(0, 1, 0);
+	return axis - v * (v.dot(axis) / (l2 > trs_tiny ? l2 : 1.f));
+}
+
+} // namespace detail
+
+/// A transform as translation, rotation and scale, applied as translation * rotation * scale. @ingroup stxmath
+/// Composing, inverting and interpolating work on the parts directly, without building matrices.
+/// mat4 * mat4 can shear a non uniformly scaled child, which a trs can't express: composing and inverting
+/// match the matrix versions exactly only when the parent's scale is uniform (the usual case) or along the child's axes.
+class trs {
+public:
+	vec3 translation;
+	quat rotation;
+	vec3 scale;
+
+	/// The identity transform
+	trs() :
+		translation(0), rotation(), scale(1)
+	{}
+
+	trs(vec3 const& translation, quat const& rotation, vec3 const& scale = vec3(1)) :
+		translation(translation), rotation(rotation), scale(scale)
+	{}
+
+	/// Decomposes an affine matrix, see decompose()
+	explicit
+	trs(mat4 const& m) :
+		trs(decompose(vec3(m[0].x, m[0].y, m[0].z), vec3(m[1].x, m[1].y, m[1].z), vec3(m[2].x, m[2].y, m[2].z), m.translation()))
+	{}
+
+	/// Decomposes an affine matrix, see decompose()
+	explicit
+	trs(affine3 const& m) :
+		trs(decompose(
+			vec3(m.rows[0].x, m.rows[1].x, m.rows[2].x),
+			vec3(m.rows[0].y, m.rows[1].y, m.rows[2].y),
+			vec3(m.rows[0].z, m.rows[1].z, m.rows[2].z),
+			m.translation()))
+	{}
+
+	mat4 to_mat4() const noexcept {
+		mat3 const r = rotation.to_mat3();
+		return mat4(
+			r.data[0] * scale.x, r.data[3] * scale.y, r.data[6] * scale.z, translation.x,
+			r.data[1] * scale.x, r.data[4] * scale.y, r.data[7] * scale.z, translation.y,
+			r.data[2] * scale.x, r.data[5] * scale.y, r.data[8] * scale.z, translation.z,
+			                  0,                   0,                   0,             1
+		);
+	}
+
+	affine3 to_affine3() const noexcept { return affine3::compose(translation, rotation, scale); }
+
+	vec3 transform_point(vec3 const& p)  const noexcept { return rotation * (scale * p) + translation; }
+	vec3 transform_vector(vec3 const& v) const noexcept { return rotation * (scale * v); }
+
+	/// Composition, applies other first: (a * b).transform_point(p) == a.transform_point(b.transform_point(p))
+	/// as long as a's scale is uniform, otherwise the scales are simply multiplied and the shear is lost.
+	trs operator*(trs const& other) const noexcept {
+		return trs(
+			rotation * (scale * other.translation) + translation,
+			rotation * other.rotation,
+			scale * other.scale
+		);
+	}
+
+	trs& operator*=(trs const& other) noexcept { return *this = *this * other; }
+
+	bool operator==(trs const& other) const noexcept { return translation == other.translation && rotation == other.rotation && scale == other.scale; }
+	bool operator!=(trs const& other) const noexcept { return !(*this == other); }
+
+	/// The inverse transform, exact for uniform scale. Zero scales turn into inf.
+	trs inverse() const noexcept {
+		quat const r = rotation.conjugate();
+		vec3 const s = 1.f / scale;
+		return trs(-(s * (r * translation)), r, s);
+	}
+
+	/// Interpolates translation and scale linearly and the rotation with quat::lerp()
+	trs lerp(trs const& other, float k) const noexcept {
+		return trs(
+			translation + (other.translation - translation) * k,
+			rotation.lerp(other.rotation, k),
+			scale + (other.scale - scale) * k
+		);
+	}
+
+	/// Like lerp(), but with quat::slerp() for a constant angular velocity
+	trs slerp(trs const& other, float k) const noexcept {
+		return trs(
+			translation + (other.translation - translation) * k,
+			rotation.slerp(other.rotation, k),
+			scale + (other.scale - scale) * k
+		);
+	}
+
+	/// Splits the linear part with columns c0, c1, c2 into rotation * scale by Gram-Schmidt:
+	/// the rotation's x axis follows c0, its y axis the part of c1 perpendicular to it and z completes a
+	/// right handed basis. Shear is dropped and a mirroring turns into a negative z scale.
+	/// Zero (or parallel) columns get a zero scale and an axis perpendicular to the others, so the rotation stays valid
+	/// and to_mat4() gives back any matrix without shear.
+	static
+	trs decompose(vec3 const& c0, vec3 const& c1, vec3 const& c2, vec3 const& translation) noexcept {
+		using detail::usable;
+		using detail::perpendicular;
+
+		vec3 const c12 = c1.cross(c2);
+		vec3 const x_axis =
+			usable(c0, 0)                                ? c0 :
+			usable(c12, c1.length2() * c2.length2())     ? c12 :
+			perpendicular(usable(c1, 0) ? c1 : c2);
+		vec3 const n0 = x_axis * (1 / std::sqrt(x_axis.length2()));
+
+		vec3 const u1 = c1 - n0 * n0.dot(c1);
+		vec3 const c20 = c2.cross(n0);
+		vec3 const y_axis =
+			usable(u1, c1.length2())  ? u1 :
+			usable(c20, c2.length2()) ? c20 :
+			perpendicular(n0);
+		vec3 const n1 = y_axis * (1 / std::sqrt(y_axis.length2()));
+		vec3 const n2 = n0.cross(n1);
+
+		return trs(
+			translation,
+			detail::rotation_to_quat(n0, n1, n2),
+			vec3(n0.dot(c0), n1.dot(c1), n2.dot(c2))
+		);
+	}
+};
+
+namespace detail {
+
+/// trs::decompose() for 4 matrices at once
+inline
+void decompose4(mat4 const* m, trs* out) noexcept {
+	using simd::float4;
+	using simd::select;
+
+	// Column k of all 4 matrices, transposed so each register holds one component of 4 matrices
+	vec3x4 c[4];
+	for(unsigned k = 0; k < 4; k++) {
+		float4 x = float4::load(m[0].data + 4 * k);
+		float4 y = float4::load(m[1].data + 4 * k);
+		float4 z = float4::load(m[2].data + 4 * k);
+		float4 w = float4::load(m[3].data + 4 * k);
+		simd::transpose(x, y, z, w);
+		c[k] = vec3x4(x, y, z);
+	}
+
+	float4 const tiny(trs_tiny), eps(1e-12f), one(1.f);
+	vec3x4 const unit_x(vec3(1, 0, 0)), unit_y(vec3(0, 1, 0));
+
+	auto usable = [&](vec3x4 const& v, float4 const& reference2) { return v.length2() > simd::madd(eps, reference2, tiny); };
+	auto perpendicular = [&](vec3x4 const& v) {
+		float4 const l2 = v.length2();
+		vec3x4 const axis = vec3x4::select(v.x * v.x < float4(.81f) * l2, unit_x, unit_y);
+		return axis - v * (v.dot(axis) / select(l2 > tiny, l2, one));
+	};
+	auto normalize = [&](vec3x4 const& v) { return v * (one / simd::sqrt(v.length2())); };
+
+	vec3x4 const c12 = c[1].cross(c[2]);
+	vec3x4 const x_axis = vec3x4::select(usable(c[0], float4::zero()), c[0],
+		vec3x4::select(usable(c12, c[1].length2() * c[2].length2()), c12,
+		perpendicular(vec3x4::select(usable(c[1], float4::zero()), c[1], c[2]))));
+	vec3x4 const n0 = normalize(x_axis);
+
+	vec3x4 const u1 = c[1] - n0 * n0.dot(c[1]);
+	vec3x4 const c20 = c[2].cross(n0);
+	vec3x4 const y_axis = vec3x4::select(usable(u1, c[1].length2()), u1,
+		vec3x4::select(usable(c20, c[2].length2()), c20,
+		perpendicular(n0)));
+	vec3x4 const n1 = normalize(y_axis);
+	vec3x4 const n2 = n0.cross(n1);
+
+	float4 w, x, y, z;
+	rotation_to_quat(n0, n1, n2, w, x, y, z);
+	vec3x4 const s(n0.dot(c[0]), n1.dot(c[1]), n2.dot(c[2]));
+
+	for(unsigned i = 0; i < 4; i++) {
+		out[i] = trs(c[3].lane(i), quat(w[i], x[i], y[i], z[i]), s.lane(i));
+	}
+}
+
+/// trs::to_mat4() for 4 transforms at once
+inline
+void compose4(trs const* in, mat4* out) noexcept {
+	using simd::float4;
+
+	float4 w = float4::load(in[0].rotation.wxyz);
+	float4 x = float4::load(in[1].rotation.wxyz);
+	float4 y = float4::load(in[2].rotation.wxyz);
+	float4 z = float4::load(in[3].rotation.wxyz);
+	simd::transpose(w, x, y, z);
+
+	float4 const sx(in[0].scale.x, in[1].scale.x, in[2].scale.x, in[3].scale.x);
+	float4 const sy(in[0].scale.y, in[1].scale.y, in[2].scale.y, in[3].scale.y);
+	float4 const sz(in[0].scale.z, in[1].scale.z, in[2].scale.z, in[3].scale.z);
+
+	float4 const one(1.f), two(2.f);
+	float4 const xx = x * x, yy = y * y, zz = z * z;
+	float4 const xy = x * y, xz = x * z, yz = y * z;
+	float4 const xw = x * w, yw = y * w, zw = z * w;
+
+	// Columns of rotation * scale, one component of 4 matrices per register
+	float4 columns[4][4] = {
+		{ (one - two * (yy + zz)) * sx, two * (xy + zw) * sx, two * (xz - yw) * sx, float4::zero() },
+		{ two * (xy - zw) * sy, (one - two * (xx + zz)) * sy, two * (yz + xw) * sy, float4::zero() },
+		{ two * (xz + yw) * sz, two * (yz - xw) * sz, (one - two * (xx + yy)) * sz, float4::zero() },
+		{
+			float4(in[0].translation.x, in[1].translation.x, in[2].translation.x, in[3].translation.x),
+			float4(in[0].translation.y, in[1].translation.y, in[2].translation.y, in[3].translation.y),
+			float4(in[0].translation.z, in[1].translation.z, in[2].translation.z, in[3].translation.z),
+			one
+		},
+	};
+
+	for(unsigned k = 0; k < 4; k++) {
+		float4* col = columns[k];
+		simd::transpose(col[0], col[1], col[2], col[3]);
+		for(unsigned i = 0; i < 4; i++) col[i].store(out[i].data + 4 * k);
+	}
+}
+
+} // namespace detail
+
+/// out[i] = in[i].to_mat4(), 4 transforms at a time. @ingroup stxmath
+/// Without STX_MATH_SIMD it is a plain loop over to_mat4().
+inline
+void compose_batch(trs const* in, mat4* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::batch4(in, out, n, trs(), detail::compose4);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = in[i].to_mat4();
+#endif
+}
+
+/// out[i] = trs(in[i]), 4 matrices at a time with the branches of trs::decompose() turned into selects. @ingroup stxmath
+/// The results match the single matrix version within a few ulp.
+/// Without STX_MATH_SIMD it is a plain loop over trs(mat4), which beats the emulated lanes.
+inline
+void decompose_batch(mat4 const* in, trs* out, size_t n) noexcept {
+#ifdef STX_MATH_HAS_SIMD
+	detail::batch4(in, out, n, mat4(), detail::decompose4);
+#else
+	for(size_t i = 0; i < n; i++) out[i] = trs(in[i]);
+#endif
+}
+
+} // namespace stx
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "fwd.hpp"
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "constexpr_math.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace stx {
+
+namespace detail {
+
+/// Components of the generic vec, named x, y, z, w up to 4 dimensions
+template<unsigned N, class T>
+struct vec_storage {
+	T data[N];
+
+	constexpr vec_storage() : data{} {}
+};
+
+template<class T>
+struct vec_storage<2, T> {
+	union {
+		struct { T x, y; };
+		T data[2];
+	};
+
+	constexpr vec_storage() : data{} {}
+};
+
+template<class T>
+struct vec_storage<3, T> {
+	union {
+		struct { T x, y, z; };
+		T data[3];
+	};
+
+	constexpr vec_storage() : data{} {}
+};
+
+template<class T>
+struct vec_storage<4, T> {
+	union {
+		struct { T x, y, z, w; };
+		T data[4];
+	};
+
+	constexpr vec_storage() : data{} {}
+};
+
+/// The component loops of the generic vec, left to the compiler's auto vectorizer
+struct vec_loops {
+	template<class V> constexpr static V add(V const& a, V const& b) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] + b[i]; return r; }
+	template<class V> constexpr static V sub(V const& a, V const& b) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] - b[i]; return r; }
+	template<class V> constexpr static V mul(V const& a, V const& b) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] * b[i]; return r; }
+	template<class V> constexpr static V div(V const& a, V const& b) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] / b[i]; return r; }
+	template<class V, class T> constexpr static V mul(V const& a, T f) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] * f; return r; }
+	template<class V, class T> constexpr static V div(V const& a, T f) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = a[i] / f; return r; }
+	template<class V> constexpr static V neg(V const& a) noexcept { V r; for(unsigned i = 0; i < V::dimensions(); i++) r[i] = -a[i]; return r; }
+
+	template<class V>
+	constexpr static typename V::value_type dot(V const& a, V const& b) noexcept {
+		typename V::value_type result = typename V::value_type();
+		for(unsigned i = 0; i < V::dimensions(); i++) result += a[i] * b[i];
+		return result;
+	}
+};
+
+/// Picks the kernels of vec<N, T>, the plain loops unless specialized below
+template<unsigned N, class T>
+struct vec_kernels : vec_loops {};
+
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+/// dvec4 arithmetic on simd::double4 (one AVX or two SSE2/NEON registers), except while constant evaluated.
+/// dot() keeps the loop, a horizontal add measured no faster and would round differently.
+template<>
+struct vec_kernels<4, double> : vec_loops {
+	template<class V> static V from(simd::double4 const& a) noexcept { V r; a.store(r.data); return r; }
+	template<class V> static simd::double4 load(V const& a) noexcept { return simd::double4::load(a.data); }
+
+	template<class V> constexpr static V add(V const& a, V const& b) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::add(a, b) : from<V>(load(a) + load(b)); }
+	template<class V> constexpr static V sub(V const& a, V const& b) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::sub(a, b) : from<V>(load(a) - load(b)); }
+	template<class V> constexpr static V mul(V const& a, V const& b) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::mul(a, b) : from<V>(load(a) * load(b)); }
+	template<class V> constexpr static V div(V const& a, V const& b) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::div(a, b) : from<V>(load(a) / load(b)); }
+	template<class V> constexpr static V mul(V const& a, double f) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::mul(a, f) : from<V>(load(a) * simd::double4(f)); }
+	template<class V> constexpr static V div(V const& a, double f) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::div(a, f) : from<V>(load(a) / simd::double4(f)); }
+	template<class V> constexpr static V neg(V const& a) noexcept { return STX_MATH_CONSTANT_EVALUATED() ? vec_loops::neg(a) : from<V>(-load(a)); }
+};
+#endif
+
+} // namespace detail
+
+/// The generic N dimensional vector, e.g. dvec3 for large worlds or ivec2 for grid math. @ingroup stxmath
+/// Which implementation a vec<N, T> gets is decided at compile time: vec2, vec3 and vec4 are hand written
+/// float specializations (vec4 with SIMD storage), every other element type uses this template,
+/// whose component loops are left to the compiler's auto vectorizer. With STX_MATH_SIMD, dvec4 arithmetic
+/// runs on simd::double4 instead (see detail::vec_kernels).
+/// length(), normalize() and mix() need a floating point T, operator% an integral one.
+template<unsigned N, class T>
+class vec : public detail::vec_storage<N, T> {
+	using storage = detail::vec_storage<N, T>;
+	using kernels = detail::vec_kernels<N, T>;
+	static_assert(N > 0, "vec needs at least one dimension");
+public:
+	using value_type = T;
+	using storage::data;
+
+	constexpr explicit
+	vec(T f = T()) :
+		storage()
+	{
+		for(unsigned i = 0; i < N; i++) data[i] = f;
+	}
+
+	/// One value per component
+	template<class... Args, class = typename std::enable_if<(N > 1) && sizeof...(Args) == N>::type>
+	constexpr
+	vec(Args... args) :
+		storage()
+	{
+		T const values[] = { T(args)... };
+		for(unsigned i = 0; i < N; i++) data[i] = values[i];
+	}
+
+	/// Converts the element type, e.g. dvec3(vec3(...)) or ivec2(dvec2(...))
+	template<class U>
+	constexpr explicit
+	vec(vec<N, U> const& other) :
+		storage()
+	{
+		for(unsigned i = 0; i < N; i++) data[i] = T(other[i]);
+	}
+
+	/// Converts to the float vectors, e.g. vec3(dvec3(...))
+	template<class U, class = typename std::enable_if<std::is_same<U, float>::value && !std::is_same<T, float>::value>::type>
+	explicit operator vec<N, U>() const noexcept {
+		vec<N, U> result;
+		for(unsigned i = 0; i < N; i++) result[i] = U(data[i]);
+		return result;
+	}
+
+	constexpr T const& operator[](size_t idx) const noexcept { return data[idx]; }
+	constexpr T&       operator[](size_t idx)       noexcept { return data[idx]; }
+
+	constexpr vec operator+(vec const& other) const noexcept { return kernels::add(*this, other); }
+	constexpr vec operator-(vec const& other) const noexcept { return kernels::sub(*this, other); }
+	constexpr vec operator*(vec const& other) const noexcept { return kernels::mul(*this, other); }
+	constexpr vec operator/(vec const& other) const noexcept { return kernels::div(*this, other); }
+	constexpr vec operator%(vec const& other) const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = data[i] % other[i]; return r; }
+
+	constexpr vec operator*(T f) const noexcept { return kernels::mul(*this, f); }
+	constexpr vec operator/(T f) const noexcept { return kernels::div(*this, f); }
+	constexpr vec operator%(T f) const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = data[i] % f; return r; }
+
+	constexpr vec& operator+=(vec const& other) noexcept { return *this = *this + other; }
+	constexpr vec& operator-=(vec const& other) noexcept { return *this = *this - other; }
+	constexpr vec& operator*=(vec const& other) noexcept { return *this = *this * other; }
+	constexpr vec& operator/=(vec const& other) noexcept { return *this = *this / other; }
+
+	constexpr vec& operator*=(T f) noexcept { return *this = *this * f; }
+	constexpr vec& operator/=(T f) noexcept { return *this = *this / f; }
+
+	constexpr vec operator-() const noexcept { return kernels::neg(*this); }
+
+	constexpr bool operator==(vec const& other) const noexcept {
+		for(unsigned i = 0; i < N; i++) {
+			if(data[i] != other[i]) return false;
+		}
+		return true;
+	}
+	constexpr bool operator!=(vec const& other) const noexcept { return !(*this == other); }
+
+	constexpr T dot(vec const& v) const noexcept { return kernels::dot(*this, v); }
+	constexpr T length2() const noexcept { return dot(*this); }
+	STX_MATH_CONSTEXPR auto length() const noexcept -> decltype(std::sqrt(T())) {
+		using result = decltype(std::sqrt(T()));
+		return STX_MATH_CONSTANT_EVALUATED() ? result(detail::cx_sqrt(double(length2()))) : std::sqrt(result(length2()));
+	}
+
+	constexpr T sum() const noexcept {
+		T result = T();
+		for(unsigned i = 0; i < N; i++) result += data[i];
+		return result;
+	}
+
+	constexpr vec cross(vec const& v) const noexcept {
+		static_assert(N == 3, "cross() is only defined for 3 dimensions");
+		return vec(
+			data[1] * v[2] - v[1] * data[2],
+			data[2] * v[0] - v[2] * data[0],
+			data[0] * v[1] - v[0] * data[1]
+		);
+	}
+
+	constexpr vec mix(vec const& other, T k) const noexcept { return (*this) + (other - *this) * k; }
+
+	STX_MATH_CONSTEXPR vec normalize() const noexcept { return (*this) / length(); }
+
+	constexpr vec max(vec const& v) const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = data[i] > v[i] ? data[i] : v[i]; return r; }
+	constexpr vec min(vec const& v) const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = data[i] < v[i] ? data[i] : v[i]; return r; }
+	constexpr vec clamp(vec const& mn, vec const& mx) const noexcept { return min(mx).max(mn); }
+	constexpr vec abs() const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = data[i] < T() ? -data[i] : data[i]; return r; }
+
+	vec round() const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = std::round(data[i]); return r; }
+	vec ceil()  const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = std::ceil(data[i]);  return r; }
+	vec floor() const noexcept { vec r; for(unsigned i = 0; i < N; i++) r[i] = std::floor(data[i]); return r; }
+
+	constexpr bool is_null() const noexcept { return *this == vec(); }
+
+	constexpr static unsigned dimensions() noexcept { return N; }
+};
+
+// The scalar parameters take value_type, which keeps e.g. 2 * dvec3 working and leaves the
+// float specializations (which have no value_type) to their own overloads
+
+template<unsigned N, class T>
+constexpr inline
+vec<N, T> operator*(typename vec<N, T>::value_type f, vec<N, T> const& v) noexcept { return v * f; }
+template<unsigned N, class T>
+constexpr inline
+vec<N, T> operator/(typename vec<N, T>::value_type f, vec<N, T> const& v) noexcept { return vec<N, T>(f) / v; }
+
+template<unsigned N, class T>
+constexpr inline typename vec<N, T>::value_type dot(vec<N, T> const& a, vec<N, T> const& b) noexcept { return a.dot(b); }
+template<unsigned N, class T>
+constexpr inline vec<N, T> cross(vec<N, T> const& a, vec<N, T> const& b) noexcept { return a.cross(b); }
+template<unsigned N, class T>
+constexpr inline typename vec<N, T>::value_type length2(vec<N, T> const& v) noexcept { return v.length2(); }
+template<unsigned N, class T>
+inline STX_MATH_CONSTEXPR auto length(vec<N, T> const& v) noexcept -> decltype(v.length()) { return v.length(); }
+template<unsigned N, class T>
+constexpr inline vec<N, T> mix(vec<N, T> const& a, vec<N, T> const& b, typename vec<N, T>::value_type k) noexcept { return a.mix(b, k); }
+
+} // namespace stx
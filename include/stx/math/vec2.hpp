@@ -1,11 +1,16 @@
 #pragma once
 
+#include "fwd.hpp"
+#include "fast_math.hpp"
+#include "constexpr_math.hpp"
+
 #include <cmath>
 
 namespace stx {
 
-/// A 2 dimensional vector. @ingroup stxmath
-class vec2 {
+/// A 2 dimensional vector, the float specialization of vec<2, T> aliased as vec2. @ingroup stxmath
+template<>
+class vec<2, float> {
 public:
 	union {
 		struct {
@@ -15,12 +20,12 @@ public:
 	};
 
 	constexpr explicit
-	vec2(float f = 0.f) :
+	vec(float f = 0.f) :
 		x(f), y(f)
 	{}
 
 	constexpr
-	vec2(float x, float y) :
+	vec(float x, float y) :
 		x(x), y(y)
 	{}
 
@@ -54,7 +59,7 @@ public:
 
 	constexpr float dot(const vec2& v) const noexcept { return x * v.x + y * v.y; }
 	constexpr float length2() const noexcept { return dot(*this); }
-	float length() const noexcept { return sqrtf(length2()); }
+	STX_MATH_CONSTEXPR float length() const noexcept { return detail::math_sqrt(length2()); }
 
 	constexpr vec2 mix(vec2 const& other, float k) const noexcept {
 		return (*this) * k + other * (1 - k);
@@ -65,8 +70,13 @@ public:
 		return mix(other, adjusted_k);
 	}
 
-	vec2  normalized()      const noexcept { return *this / length(); }
-	vec2& make_normalized()       { return *this /= length(); }
+	STX_MATH_CONSTEXPR vec2 normalized() const noexcept {
+#if defined(STX_MATH_FAST)
+		if(!STX_MATH_CONSTANT_EVALUATED()) return *this * fast_rsqrt(length2());
+#endif
+		return *this / length();
+	}
+	STX_MATH_CONSTEXPR vec2& make_normalized() { return *this = normalized(); }
 
 	constexpr vec2 max(const vec2& v) const noexcept {
 		return vec2{
@@ -109,6 +119,6 @@ inline vec2 mix(const vec2& a, const vec2& b, float k, float step, float unit =
 
 inline constexpr float dot    (const vec2& a, const vec2& b) { return a.dot(b); }
 inline constexpr float length2(const vec2& v) { return v.length2(); }
-inline float length (const vec2& v) { return v.length(); }
+inline STX_MATH_CONSTEXPR float length (const vec2& v) { return v.length(); }
 
 } // namespace stx
@@ -1,14 +1,17 @@
 #pragma once
 
+#include "fwd.hpp"
+#include "fast_math.hpp"
+#include "constexpr_math.hpp"
+
 #include <cmath>
 #include <cstddef>
 
 namespace stx {
 
-class vec2;
-
-/// A 3 dimensional vector or rgb color. @ingroup stxmath
-class vec3 {
+/// A 3 dimensional vector or rgb color, the float specialization of vec<3, T> aliased as vec3. @ingroup stxmath
+template<>
+class vec<3, float> {
 public:
 	union {
 		struct {
@@ -22,12 +25,12 @@ public:
 	};
 
 	constexpr explicit
-	vec3(float f = 0.f) :
+	vec(float f = 0.f) :
 		x(f), y(f), z(f)
 	{}
 
 	constexpr inline
-	vec3(float x, float y, float z) :
+	vec(float x, float y, float z) :
 		x(x), y(y), z(z)
 	{}
 
@@ -57,10 +60,10 @@ public:
 	constexpr vec3 operator-() const noexcept { return vec3{-x, -y, -z}; }
 
 	constexpr bool operator==(const vec3& other) const noexcept {
-		return x == other.x && y == other.y && y == other.y;
+		return x == other.x && y == other.y && z == other.z;
 	}
 	constexpr bool operator!=(const vec3& other) const noexcept {
-		return x != other.x || y != other.y || y != other.y;
+		return x != other.x || y != other.y || z != other.z;
 	}
 
 	constexpr vec3 cross(const vec3& v) const noexcept {
@@ -91,7 +94,7 @@ public:
 
 	constexpr float dot(const vec3& v) const noexcept { return x * v.x + y * v.y + z * v.z; }
 	constexpr float length2()          const noexcept { return dot(*this); }
-	float length()                     const noexcept { return sqrtf(length2()); }
+	STX_MATH_CONSTEXPR float length()  const noexcept { return detail::math_sqrt(length2()); }
 
 	constexpr vec3 mix(vec3 const& other, float k) const noexcept {
 		return (*this) + (other - *this) * k;
@@ -101,12 +104,16 @@ public:
 		return mix(other, 1 - powf(1 - k, step / unit));
 	}
 
-	 // constexpr TODO: make constexpr as soon as length() is
-	vec3  normalize() const noexcept { return (*this) / length(); }
+	STX_MATH_CONSTEXPR vec3 normalize() const noexcept {
+#if defined(STX_MATH_FAST)
+		if(!STX_MATH_CONSTANT_EVALUATED()) return (*this) * fast_rsqrt(length2());
+#endif
+		return (*this) / length();
+	}
 
 	vec3& make_mix(vec3 const& other, float k) noexcept { return (*this) = mix(other, k); }
 	vec3& make_mix(vec3 const& other, float k, float step, float unit = 1) noexcept { return (*this) = mix(other, k, step, unit); }
-	vec3& make_normal() noexcept { return (*this) = normalize(); }
+	STX_MATH_CONSTEXPR vec3& make_normal() noexcept { return (*this) = normalize(); }
 
 	constexpr vec3 max(const vec3& v) const noexcept {
 		return vec3 {
@@ -124,22 +131,22 @@ public:
 	}
 	constexpr vec3 clamp(const vec3& mn, const vec3& mx) const noexcept { return min(mx).max(mn); }
 
-	static vec3 look_along(vec3 const& dir) noexcept {
+	STX_MATH_CONSTEXPR static vec3 look_along(vec3 const& dir) noexcept {
 		if(dir.is_null()) return vec3();
 
-		float look_up_dist   = sqrtf(dir.z * dir.z + dir.x * dir.x);
+		float look_up_dist   = detail::math_sqrt(dir.z * dir.z + dir.x * dir.x);
 		float look_up_height = dir.y;
 
 		if(look_up_dist == 0) { // Edgecase: directly below or above
-			return vec3(copysignf(M_PI * .5f, look_up_height), 0, 0);
+			return vec3(look_up_height < 0 ? -M_PI * .5f : M_PI * .5f, 0, 0);
 		}
 
-		float look_up_angle = atanf(look_up_height / look_up_dist);
+		float look_up_angle = detail::math_atan(look_up_height / look_up_dist);
 
 		float turn_dist   = -dir.z;
 		float turn_height = dir.x;
 
-		float turn_angle = -atan2f(turn_height, turn_dist);
+		float turn_angle = -detail::math_atan2(turn_height, turn_dist);
 
 		return vec3(look_up_angle, turn_angle, 0);
 	}
@@ -172,7 +179,7 @@ vec3 operator/(float f, vec3 const& v) noexcept { return vec3(f / v.x, f / v.y,
 inline constexpr float dot    (const vec3& a, const vec3& b) noexcept { return a.dot(b); }
 inline constexpr vec3  cross  (const vec3& a, const vec3& b) noexcept { return a.cross(b); }
 inline constexpr float length2(const vec3& v)                noexcept { return v.length2(); }
-inline float           length (const vec3& v)                noexcept { return v.length(); }
+inline STX_MATH_CONSTEXPR float length(const vec3& v)       noexcept { return v.length(); }
 
 inline constexpr vec3 mix(const vec3& a, const vec3& b, float k) noexcept {
 	return a.mix(b, k);
@@ -2,12 +2,17 @@
 
 #include <cmath>
 
-namespace stx {
+#include "fwd.hpp"
+#include "simd.hpp"
+#include "fast_math.hpp"
+#include "constexpr_math.hpp"
 
-class vec3;
+namespace stx {
 
-/// A 4 dimensional vector or rgba color. @ingroup stxmath
-class vec4 {
+/// A 4 dimensional vector or rgba color, the float specialization of vec<4, T> aliased as vec4.
+/// With STX_MATH_SIMD it is stored in a 16 byte aligned vector register. @ingroup stxmath
+template<>
+class vec<4, float> {
 public:
 	union {
 		struct {
@@ -18,21 +23,96 @@ public:
 		};
 		float xyzw[4];
 		float rgba[4];
+#ifdef STX_MATH_HAS_SIMD
+		simd::native4 packed;
+#endif
 	};
 
 	constexpr explicit
-	vec4(float f = 0.f) :
+	vec(float f = 0.f) :
 		x(f), y(f), z(f), w(f)
-	{}
+	{
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+		if(!STX_MATH_CONSTANT_EVALUATED()) packed = simd::float4(f).v;
+#endif
+	}
 
+	/// With STX_MATH_SIMD the lanes are set in one register outside of constant evaluation. Four scalar
+	/// stores followed by the packed load of the next operator would stall store to load forwarding.
 	constexpr inline
-	vec4(float x, float y, float z, float w) :
+	vec(float x, float y, float z, float w) :
 		x(x), y(y), z(z), w(w)
-	{}
+	{
+#if defined(STX_MATH_HAS_SIMD) && defined(STX_MATH_HAS_CONSTEXPR_MATH)
+		if(!STX_MATH_CONSTANT_EVALUATED()) packed = simd::float4(x, y, z, w).v;
+#endif
+	}
 
 	constexpr operator const float*() const noexcept { return xyzw; }
 	constexpr operator       float*()       { return xyzw; }
 
+#ifdef STX_MATH_HAS_SIMD
+	explicit
+	vec(simd::float4 const& f) noexcept :
+		packed(f.v)
+	{}
+
+	simd::float4 to_simd() const noexcept { return packed; }
+
+	vec4 operator+(const vec4& other) const noexcept { return vec4(to_simd() + other.to_simd()); }
+	vec4 operator-(const vec4& other) const noexcept { return vec4(to_simd() - other.to_simd()); }
+	vec4 operator*(const vec4& other) const noexcept { return vec4(to_simd() * other.to_simd()); }
+	vec4 operator/(const vec4& other) const noexcept { return vec4(to_simd() / other.to_simd()); }
+
+	vec4 operator*(float f) const noexcept { return vec4(to_simd() * simd::float4(f)); }
+	vec4 operator/(float f) const noexcept { return vec4(to_simd() / simd::float4(f)); }
+
+	vec4 operator+=(const vec4& other) noexcept { return *this = *this + other; }
+	vec4 operator-=(const vec4& other) noexcept { return *this = *this - other; }
+	vec4 operator*=(const vec4& other) noexcept { return *this = *this * other; }
+	vec4 operator/=(const vec4& other) noexcept { return *this = *this / other; }
+
+	vec4 operator*=(float f) noexcept { return *this = *this * f; }
+	vec4 operator/=(float f) noexcept { return *this = *this / f; }
+
+	vec4 operator-() const noexcept { return vec4(-to_simd()); }
+
+	bool operator==(const vec4& other) const noexcept { return simd::all(to_simd() == other.to_simd()); }
+	bool operator!=(const vec4& other) const noexcept { return !(*this == other); }
+
+	float dot(const vec4& v) const noexcept { return simd::first(simd::dot4(to_simd(), v.to_simd())); }
+	float length2()          const noexcept { return dot(*this); }
+	STX_MATH_CONSTEXPR float length() const noexcept {
+		if(STX_MATH_CONSTANT_EVALUATED()) return detail::math_sqrt(x * x + y * y + z * z + w * w);
+		return simd::first(simd::sqrt(simd::dot4(to_simd(), to_simd())));
+	}
+
+	vec4 mix(vec4 const& other, float k) const noexcept {
+		return vec4(simd::madd(to_simd(), simd::float4(k), other.to_simd() * simd::float4(1 - k)));
+	}
+
+	vec4 mix(vec4 const& other, float k, float step, float unit = 1) const noexcept {
+		float adjusted_k = powf(k, step / unit);
+		return mix(other, adjusted_k);
+	}
+
+	STX_MATH_CONSTEXPR vec4 normalize() const noexcept {
+		if(STX_MATH_CONSTANT_EVALUATED()) {
+			float const l = length();
+			return vec4(x / l, y / l, z / l, w / l);
+		}
+#if defined(STX_MATH_FAST)
+		return vec4(to_simd() * simd::rsqrt(simd::dot4(to_simd(), to_simd())));
+#else
+		return vec4(to_simd() / simd::sqrt(simd::dot4(to_simd(), to_simd())));
+#endif
+	}
+	vec4& make_normal() noexcept { *this = normalize(); return *this; }
+
+	vec4 max(const vec4& v) const noexcept { return vec4(simd::max(to_simd(), v.to_simd())); }
+	vec4 min(const vec4& v) const noexcept { return vec4(simd::min(to_simd(), v.to_simd())); }
+	vec4 clamp(const vec4& mn, const vec4& mx) const noexcept { return min(mx).max(mn); }
+#else
 	constexpr vec4 operator+(const vec4& other) const noexcept { return vec4{x+other.x, y+other.y, z+other.z, w+other.w}; }
 	constexpr vec4 operator-(const vec4& other) const noexcept { return vec4{x-other.x, y-other.y, z-other.z, w-other.w}; }
 	constexpr vec4 operator*(const vec4& other) const noexcept { return vec4{x*other.x, y*other.y, z*other.z, w*other.w}; }
@@ -60,7 +140,7 @@ public:
 
 	constexpr float dot(const vec4& v) const noexcept { return x * v.x + y * v.y + z * v.z + w * v.w; }
 	constexpr float length2()          const noexcept { return dot(*this); }
-	float length()                     const noexcept { return sqrtf(length2()); }
+	STX_MATH_CONSTEXPR float length()  const noexcept { return detail::math_sqrt(length2()); }
 
 	constexpr vec4 mix(vec4 const& other, float k) const noexcept {
 		return (*this) * k + other * (1 - k);
@@ -71,9 +151,13 @@ public:
 		return mix(other, adjusted_k);
 	}
 
-	// TODO: make these two constexpr if as length() is
-	vec4  normalize()   const noexcept { return *this / length(); }
-	vec4& make_normal() { *this = normalize(); return *this; }
+	STX_MATH_CONSTEXPR vec4 normalize() const noexcept {
+#if defined(STX_MATH_FAST)
+		if(!STX_MATH_CONSTANT_EVALUATED()) return *this * fast_rsqrt(length2());
+#endif
+		return *this / length();
+	}
+	STX_MATH_CONSTEXPR vec4& make_normal() { *this = normalize(); return *this; }
 
 
 	constexpr vec4 max(const vec4& v) const noexcept {
@@ -93,25 +177,26 @@ public:
 		};
 	}
 	constexpr vec4 clamp(const vec4& mn, const vec4& mx) const noexcept { return min(mx).max(mn); }
+#endif
 
 	constexpr float sum() const noexcept { return x + y + z + w; }
 
 	const vec3& as_vec3() const noexcept { return *reinterpret_cast<vec3 const*>(xyzw); }
 	      vec3& as_vec3()       noexcept { return *reinterpret_cast<vec3*>(xyzw); }
 
-	constexpr static unsigned dimensions() { return 3; }
+	constexpr static unsigned dimensions() { return 4; }
 };
 
-constexpr inline
+STX_SIMD_CONSTEXPR inline
 vec4 operator*(float f, vec4 const& v) noexcept { return v * f; }
 constexpr inline
 vec4 operator/(float f, vec4 const& v) noexcept { return vec4(f / v.x, f / v.y, f / v.z, f / v.w); }
 
-inline constexpr float dot    (const vec4& a, const vec4& b) { return a.dot(b); }
-inline constexpr float length2(const vec4& v)   { return v.length2(); }
-inline float           length (const vec4& v)   { return v.length(); }
+inline STX_SIMD_CONSTEXPR float dot    (const vec4& a, const vec4& b) { return a.dot(b); }
+inline STX_SIMD_CONSTEXPR float length2(const vec4& v)   { return v.length2(); }
+inline STX_MATH_CONSTEXPR float    length (const vec4& v)   { return v.length(); }
 
-inline constexpr vec4 mix(const vec4& a, const vec4& b, float k) {
+inline STX_SIMD_CONSTEXPR vec4 mix(const vec4& a, const vec4& b, float k) {
 	return a.mix(b, k);
 }
 
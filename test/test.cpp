@@ -32,12 +32,46 @@ extern void test_vec();
 extern void test_mat3();
 extern void test_mat4();
 extern void test_quat();
+extern void test_batch();
+extern void test_frustum();
+extern void test_box();
+extern void test_bvh();
+extern void test_hierarchy();
+extern void test_skinning();
+extern void test_animation();
+extern void test_mat();
+extern void test_packing();
+extern void test_fast_math();
+extern void test_constexpr_math();
+extern void test_transform();
+extern void test_trs();
+extern void test_solve();
+extern void test_camera();
+extern void test_projection();
+extern void test_parallel();
 
 int main(int argc, char const** argv) {
 	test_vec();
 	test_mat3();
 	test_mat4();
 	test_quat();
+	test_batch();
+	test_frustum();
+	test_box();
+	test_bvh();
+	test_hierarchy();
+	test_skinning();
+	test_animation();
+	test_mat();
+	test_packing();
+	test_fast_math();
+	test_constexpr_math();
+	test_transform();
+	test_trs();
+	test_solve();
+	test_camera();
+	test_projection();
+	test_parallel();
 
 	std::cout << "tests: "  << tests << std::endl;
 	std::cout << "passed: " << tests - fails << std::endl;
@@ -1,5 +1,68 @@
+#pragma once
+
 #include <xplatform>
 
+#include <xmath/mat4>
+#include <xmath/quat>
+#include <xmath/vec3>
+#include <xmath/vec4>
+
+#include <cmath>
+#include <random>
+
 void _testResult(const char* file, int line, const char* fn, const char* test, bool value);
 
 #define test(X) _testResult(__FILE__, __LINE__, STX_FUNCTION, #X, X)
+
+/// Helpers shared by the tests, pulled in with using namespace test_helpers
+namespace test_helpers {
+
+/// Every component within eps
+inline
+bool near(stx::vec3 const& a, stx::vec3 const& b, float eps = 1e-4f) {
+	return std::abs(a.x - b.x) <= eps && std::abs(a.y - b.y) <= eps && std::abs(a.z - b.z) <= eps;
+}
+
+/// Every component within eps
+inline
+bool near(stx::vec4 const& a, stx::vec4 const& b, float eps = 1e-4f) {
+	return std::abs(a.x - b.x) <= eps && std::abs(a.y - b.y) <= eps && std::abs(a.z - b.z) <= eps && std::abs(a.w - b.w) <= eps;
+}
+
+/// Every component within eps, q and -q differ
+inline
+bool near(stx::quat const& a, stx::quat const& b, float eps = 1e-4f) {
+	return std::abs(a.w - b.w) <= eps && std::abs(a.x - b.x) <= eps && std::abs(a.y - b.y) <= eps && std::abs(a.z - b.z) <= eps;
+}
+
+/// Every element within eps, relative to the expected element for those above 1 like projection terms
+inline
+bool near(stx::mat4 const& a, stx::mat4 const& b, float eps = 1e-4f) {
+	for(unsigned i = 0; i < 16; i++) {
+		if(std::abs(a.data[i] - b.data[i]) > eps * std::fmax(1.f, std::abs(b.data[i]))) return false;
+	}
+	return true;
+}
+
+/// Largest absolute difference of two elements
+inline
+float max_difference(stx::mat4 const& a, stx::mat4 const& b) {
+	float result = 0;
+	for(unsigned i = 0; i < 16; i++) result = std::fmax(result, std::abs(a.data[i] - b.data[i]));
+	return result;
+}
+
+/// A random unit quaternion
+inline
+stx::quat random_rotation(std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-1, 1);
+	return stx::quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+}
+
+inline
+stx::vec3 random_vec3(std::mt19937& rng, float lo = -5, float hi = 5) {
+	std::uniform_real_distribution<float> dist(lo, hi);
+	return stx::vec3(dist(rng), dist(rng), dist(rng));
+}
+
+} // namespace test_helpers
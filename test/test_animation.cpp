@@ -0,0 +1,87 @@
+#include "test.hpp"
+
+#include <xmath/animation>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+static
+void test_animation_track() {
+	animation_track<float> track;
+	test(track.sample(1) == 0);
+	track.add(1, 10);
+	test(track.sample(0) == 10 && track.sample(5) == 10);
+	track.add(2, 20);
+	track.add(4, 0);
+
+	test(track.sample(0) == 10);
+	test(track.sample(1.5f) == 15);
+	test(track.sample(3) == 10);
+	test(track.sample(9) == 0);
+
+	uint32_t cursor = 0;
+	test(track.sample(1.5f, cursor) == 15 && cursor == 0);
+	test(track.sample(3.f, cursor) == 10 && cursor == 1);
+	test(track.sample(1.5f, cursor) == 15 && cursor == 0);
+
+	// Forward playback, jumps and scrubbing backwards all agree with the binary search
+	std::mt19937 rng(51);
+	std::uniform_real_distribution<float> step(0, .05f);
+	animation_track<vec3> positions;
+	for(int i = 0; i < 200; i++) positions.add(i * .1f + step(rng), vec3(i, i * i, -i));
+
+	bool forward_ok = true, random_ok = true;
+	cursor = 0;
+	for(float t = -1; t < 25; t += step(rng)) forward_ok &= positions.sample(t, cursor) == positions.sample(t);
+	std::uniform_real_distribution<float> any_time(-1, 25);
+	for(int i = 0; i < 1000; i++) {
+		float const t = any_time(rng);
+		random_ok &= positions.sample(t, cursor) == positions.sample(t);
+	}
+	test(forward_ok);
+	test(random_ok);
+}
+
+static
+void test_animation_clip() {
+	std::mt19937 rng(52);
+	std::uniform_real_distribution<float> dist(-1, 1);
+	std::uniform_real_distribution<float> step(.01f, .5f);
+
+	animation_clip clip;
+	clip.vec3_tracks.resize(13);
+	clip.quat_tracks.resize(11);
+	for(auto& track : clip.vec3_tracks) {
+		float t = 0;
+		for(int i = 0; i < 20; i++) track.add(t += step(rng), vec3(dist(rng), dist(rng), dist(rng)));
+	}
+	for(auto& track : clip.quat_tracks) {
+		float t = 0;
+		for(int i = 0; i < 20; i++) track.add(t += step(rng), quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize());
+	}
+	// Degenerate tracks
+	clip.vec3_tracks[3] = animation_track<vec3>();
+	clip.quat_tracks[5] = animation_track<quat>();
+	clip.quat_tracks[5].add(1, quat(0, 1, 0, 0));
+
+	animation_cursor cursor;
+	std::vector<vec3> positions(clip.vec3_tracks.size());
+	std::vector<quat> rotations(clip.quat_tracks.size());
+
+	bool vec3_ok = true, quat_ok = true;
+	for(float t = 0; t < clip.duration() + 1; t += .03f) {
+		clip.sample(t, cursor, positions.data(), rotations.data());
+		for(size_t i = 0; i < positions.size(); i++) vec3_ok &= near(positions[i], clip.vec3_tracks[i].sample(t), 1e-6f);
+		for(size_t i = 0; i < rotations.size(); i++) quat_ok &= near(rotations[i], clip.quat_tracks[i].sample(t), 1e-5f);
+	}
+	test(vec3_ok);
+	test(quat_ok);
+}
+
+void test_animation() {
+	test_animation_track();
+	test_animation_clip();
+}
@@ -0,0 +1,226 @@
+#include "test.hpp"
+
+#include <xmath/batch>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+namespace {
+
+mat4 test_matrix() {
+	return mat4::transform(quat::angle_axis(.7f, vec3(1, 2, 3).normalize()), vec3(4, -5, 6), vec3(2, 3, .5f));
+}
+
+std::vector<vec3> random_vec3(size_t n) {
+	std::mt19937 rng(n);
+	std::uniform_real_distribution<float> dist(-100, 100);
+	std::vector<vec3> result(n);
+	for(auto& v : result) v = vec3(dist(rng), dist(rng), dist(rng));
+	return result;
+}
+
+bool close(vec3 const& a, vec3 const& b) {
+	return (a - b).length2() <= 1e-8f * fmaxf(1, b.length2());
+}
+
+} // namespace
+
+static
+void test_transform_points() {
+	mat4 m = test_matrix();
+
+	bool points_ok = true, vectors_ok = true, in_place_ok = true;
+	// Covers every tail length and one buffer above batch_stream_threshold
+	for(size_t n : { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 1000, 200000 }) {
+		std::vector<vec3> in = random_vec3(n);
+		std::vector<vec3> out(n + 1);
+
+		transform_points(m, in.data(), out.data() + 1, n); // Misaligned output
+		for(size_t i = 0; i < n; i++) points_ok &= close(out[i + 1], m * in[i]);
+
+		transform_vectors(m, in.data(), out.data(), n);
+		for(size_t i = 0; i < n; i++) vectors_ok &= close(out[i], vec3((m * vec4(in[i].x, in[i].y, in[i].z, 0)).as_vec3()));
+
+		std::vector<vec3> copy = in;
+		transform_points(m, copy.data(), copy.data(), n);
+		for(size_t i = 0; i < n; i++) in_place_ok &= close(copy[i], m * in[i]);
+	}
+	test(points_ok);
+	test(vectors_ok);
+	test(in_place_ok);
+}
+
+static
+void test_transform_vec4() {
+	mat4 m = test_matrix();
+
+	bool ok = true;
+	for(size_t n : { 0, 1, 7, 100000 }) {
+		std::vector<vec4> in(n), out(n);
+		for(size_t i = 0; i < n; i++) in[i] = vec4(i, -(float)i, 1, i % 2);
+
+		transform_vec4(m, in.data(), out.data(), n);
+		for(size_t i = 0; i < n; i++) ok &= (out[i] - m * in[i]).length2() <= 1e-8f * fmaxf(1, out[i].length2());
+	}
+	test(ok);
+}
+
+/// Exact slerp in double precision
+static
+quat reference_slerp(quat const& a, quat b, float t) {
+	double d = (double) a.w * b.w + (double) a.x * b.x + (double) a.y * b.y + (double) a.z * b.z;
+	if(d < 0) {
+		b = -b;
+		d = -d;
+	}
+	double const theta = acos(d > 1 ? 1 : d);
+	double wa = 1 - t, wb = t;
+	if(theta > 1e-6) {
+		wa = sin((1 - t) * theta) / sin(theta);
+		wb = sin(t * theta) / sin(theta);
+	}
+	return quat(
+		(float) (a.w * wa + b.w * wb), (float) (a.x * wa + b.x * wb),
+		(float) (a.y * wa + b.y * wb), (float) (a.z * wa + b.z * wb)
+	);
+}
+
+static
+float max_component_difference(quat const& a, quat const& b) {
+	return fmaxf(fmaxf(fabsf(a.w - b.w), fabsf(a.x - b.x)), fmaxf(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+static
+void test_quat_interpolation() {
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<float> dist(-1, 1);
+	std::uniform_real_distribution<float> unit(0, 1);
+
+	size_t const n = 1003;
+	std::vector<quat> a(n), b(n), out(n);
+	std::vector<float> t(n);
+	for(size_t i = 0; i < n; i++) {
+		a[i] = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+		// Mix of far apart, nearly identical and opposite quaternions
+		switch(i % 3) {
+			case 0: b[i] = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize(); break;
+			case 1: b[i] = (a[i] + quat(dist(rng), dist(rng), dist(rng), dist(rng)) * 1e-3f).normalize(); break;
+			case 2: b[i] = -a[i]; break;
+		}
+		t[i] = unit(rng);
+	}
+
+	float slerp_error = 0, nlerp_error = 0, uniform_error = 0;
+
+	slerp_batch(a.data(), b.data(), t.data(), out.data(), n);
+	for(size_t i = 0; i < n; i++) slerp_error = fmaxf(slerp_error, max_component_difference(out[i], reference_slerp(a[i], b[i], t[i])));
+
+	nlerp_batch(a.data(), b.data(), t.data(), out.data(), n);
+	for(size_t i = 0; i < n; i++) nlerp_error = fmaxf(nlerp_error, max_component_difference(out[i], a[i].lerp(b[i], t[i])));
+
+	slerp_batch(a.data(), b.data(), .25f, out.data(), n);
+	for(size_t i = 0; i < n; i++) uniform_error = fmaxf(uniform_error, max_component_difference(out[i], reference_slerp(a[i], b[i], .25f)));
+
+	test(slerp_error < 2e-6f);
+	test(nlerp_error < 1e-6f);
+	test(uniform_error < 2e-6f);
+
+	// In place
+	std::vector<quat> in_place = a;
+	nlerp_batch(in_place.data(), b.data(), .5f, in_place.data(), n);
+	nlerp_batch(a.data(), b.data(), .5f, out.data(), n);
+	test(in_place == out);
+}
+
+static
+void test_rotate() {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(-1, 1);
+
+	// The cross product form matches the Hamilton products
+	quat const q = quat(.3f, -.5f, .7f, .2f).normalize();
+	vec3 const v(1, -2, 3);
+	quat const h = q * quat(0, v.x, v.y, v.z) * q.conjugate();
+	test(close(q * v, vec3(h.x, h.y, h.z)));
+	test(q * vec3(0) == vec3(0));
+
+	size_t const n = 1003;
+	std::vector<vec3> const in = random_vec3(n);
+	std::vector<quat> rotations(n);
+	for(quat& r : rotations) r = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+
+	std::vector<vec3> out(n);
+	rotate_batch(q, in.data(), out.data(), n);
+	bool single_ok = true;
+	for(size_t i = 0; i < n; i++) single_ok &= close(out[i], q * in[i]);
+	test(single_ok);
+
+	rotate_batch(rotations.data(), in.data(), out.data(), n);
+	bool each_ok = true;
+	for(size_t i = 0; i < n; i++) each_ok &= close(out[i], rotations[i] * in[i]);
+	test(each_ok);
+
+	// In place
+	std::vector<vec3> in_place = in;
+	rotate_batch(rotations.data(), in_place.data(), in_place.data(), n);
+	test(in_place == out);
+
+	// SoA
+	vec3_soa soa(in.data(), n), soa_out;
+	rotate_batch(rotations.data(), soa, soa_out);
+	bool soa_ok = soa_out.size() == n;
+	for(size_t i = 0; i < n; i++) soa_ok &= close(soa_out[i], rotations[i] * in[i]);
+	test(soa_ok);
+
+	rotate_batch(q, soa, soa);
+	soa_ok = true;
+	for(size_t i = 0; i < n; i++) soa_ok &= close(soa[i], q * in[i]);
+	test(soa_ok);
+}
+
+static
+void test_to_quat() {
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-1, 1);
+
+	// Random rotations, every third one a half turn
+	size_t const n = 1003;
+	std::vector<mat3> m3(n);
+	std::vector<mat4> m4(n);
+	for(size_t i = 0; i < n; i++) {
+		vec3 const axis = vec3(dist(rng), dist(rng), dist(rng)).normalize();
+		float const angle = i % 3 == 0 ? float(M_PI) : 4 * dist(rng);
+		m3[i] = quat::angle_axis(angle, axis).to_mat3();
+		m4[i] = mat4(m3[i]);
+		m4[i][3] = vec4(dist(rng), dist(rng), dist(rng), 1);
+	}
+
+	std::vector<quat> out(n);
+	to_quat_batch(m3.data(), out.data(), n);
+	bool mat3_ok = true;
+	for(size_t i = 0; i < n; i++) mat3_ok &= max_component_difference(out[i], quat(m3[i])) < 1e-6f;
+	test(mat3_ok);
+
+	to_quat_batch(m4.data(), out.data(), n);
+	bool mat4_ok = true;
+	for(size_t i = 0; i < n; i++) mat4_ok &= max_component_difference(out[i], quat(m3[i])) < 1e-6f;
+	test(mat4_ok);
+
+	// Back to the same matrices
+	bool round_trip = true;
+	for(size_t i = 0; i < n; i++) {
+		mat3 const r = out[i].to_mat3();
+		for(size_t k = 0; k < 9; k++) round_trip &= fabsf(r.data[k] - m3[i].data[k]) < 1e-5f;
+	}
+	test(round_trip);
+}
+
+void test_batch() {
+	test_transform_points();
+	test_transform_vec4();
+	test_quat_interpolation();
+	test_rotate();
+	test_to_quat();
+}
@@ -0,0 +1,103 @@
+#include "test.hpp"
+
+#include <xmath/box3>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+static
+void test_box3_operations() {
+	box3 a(vec3(0, 0, 0), vec3(2, 2, 2));
+	box3 b(vec3(1, 1, 1), vec3(3, 4, 5));
+
+	test(a.unite(b).min == vec3(0, 0, 0) && a.unite(b).max == vec3(3, 4, 5));
+	test(a.intersect(b).min == vec3(1, 1, 1) && a.intersect(b).max == vec3(2, 2, 2));
+	test(!a.intersect(box3(vec3(5), vec3(6))).valid());
+	test(a.contains(vec3(1, 1, 1)));
+	test(!a.contains(vec3(1, 3, 1)));
+	test(a.contains(box3(vec3(.5f), vec3(1.5f))));
+	test(a.intersects(b));
+	test(!a.intersects(box3(vec3(2.5f), vec3(3))));
+
+	box3 e = box3::inverted();
+	test(!e.valid());
+	e = e.expand(vec3(1, 2, 3)).expand(vec3(-1, 5, 0));
+	test(e.min == vec3(-1, 2, 0) && e.max == vec3(1, 5, 3));
+
+	test(b.center() == vec3(2, 2.5f, 3));
+	test(b.half_extent() == vec3(1, 1.5f, 2));
+	box3 c = box3::from_center(b.center(), b.half_extent());
+	test(c.min == b.min && c.max == b.max);
+	test(a.surface_area() == 24 && a.volume() == 8);
+}
+
+static
+void test_box3_ray() {
+	box3 b(vec3(-1), vec3(1));
+
+	float t;
+	test(b.intersect(ray3(vec3(0, 0, 5), vec3(0, 0, -1)), 0, 100, t) && fabsf(t - 4) < 1e-6f);
+	test(!b.intersect(ray3(vec3(0, 0, 5), vec3(0, 0, 1))));
+	test(!b.intersect(ray3(vec3(0, 3, 5), vec3(0, 0, -1))));
+	test(!b.intersect(ray3(vec3(0, 0, 5), vec3(0, 0, -1)), 3.5f));
+	test(b.intersect(ray3(vec3(0, 0, 0), vec3(1, 1, 0)), 0, 1, t) && t <= 0);
+
+	// Rays running inside a face or along an edge, the parallel axes give 0 * inf = nan
+	ray3 const face_rays[4] = {
+		ray3(vec3(-3, 1, 0.5f), vec3(1, 0, 0)),
+		ray3(vec3(3, -1, 0.5f), vec3(-1, -0.f, 0)),
+		ray3(vec3(-3, 1, 1), vec3(1, 0, 0)),
+		ray3(vec3(0.5f, -3, -1), vec3(0, 1, -0.f)),
+	};
+	bool face_ok = true;
+	for(ray3 const& r : face_rays) face_ok &= b.intersect(r, 0, 100, t) && t == 2;
+	test(face_ok);
+	test(!b.intersect(ray3(vec3(-3, 1, 5), vec3(1, 0, 0))));
+	test(box3(vec3(-1, 0, -1), vec3(1, 0, 1)).intersect(ray3(vec3(-3, 0, 0), vec3(1, 0, 0)), 0, 100, t) && t == 2);
+
+	simd::float4 t_face;
+	int const face_hits = simd::movemask(ray3x4::load(face_rays).intersect(b, simd::float4(0.f), simd::float4(100.f), t_face));
+	test(face_hits == 15 && t_face[0] == 2 && t_face[1] == 2 && t_face[2] == 2 && t_face[3] == 2);
+	box3 const face_boxes[4] = { b, box3(vec3(-1, 1, 0), vec3(1, 2, 1)), box3(vec3(-1, 0, 0), vec3(1, 1, 0.5f)), box3(vec3(-1, 2, 0), vec3(1, 3, 1)) };
+	test(simd::movemask(box3x4::load(face_boxes).intersect(face_rays[0], simd::float4(0.f), simd::float4(100.f), t_face)) == 7);
+
+	// Packets against the scalar test
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dist(-10, 10);
+
+	std::vector<box3> boxes(8);
+	std::vector<ray3> rays(8);
+	bool box_packets_ok = true, ray_packets_ok = true;
+	for(int n = 0; n < 200; n++) {
+		for(auto& bx : boxes) {
+			vec3 p(dist(rng), dist(rng), dist(rng));
+			bx = box3(p, p + vec3(fabsf(dist(rng)), fabsf(dist(rng)), fabsf(dist(rng))));
+		}
+		for(auto& r : rays) r = ray3(vec3(dist(rng), dist(rng), dist(rng)), vec3(dist(rng), dist(rng), dist(rng)));
+
+		simd::float8 t_near;
+		int hits = simd::movemask(box3x8::load(boxes.data()).intersect(rays[0], simd::float8(0.f), simd::float8(50.f), t_near));
+		for(unsigned i = 0; i < 8; i++) {
+			float ts;
+			box_packets_ok &= ((hits >> i) & 1) == (int) boxes[i].intersect(rays[0], 0, 50, ts);
+		}
+
+		simd::float4 t4;
+		hits = simd::movemask(ray3x4::load(rays.data()).intersect(boxes[0], simd::float4(0.f), simd::float4(50.f), t4));
+		for(unsigned i = 0; i < 4; i++) {
+			float ts;
+			bool hit = boxes[0].intersect(rays[i], 0, 50, ts);
+			ray_packets_ok &= ((hits >> i) & 1) == (int) hit;
+			if(hit) ray_packets_ok &= fabsf(ts - t4[i]) < 1e-4f;
+		}
+	}
+	test(box_packets_ok);
+	test(ray_packets_ok);
+}
+
+void test_box() {
+	test_box3_operations();
+	test_box3_ray();
+}
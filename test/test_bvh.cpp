@@ -0,0 +1,132 @@
+#include "test.hpp"
+
+#include <xmath/bvh>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+static
+std::vector<box3> random_boxes(size_t n, std::mt19937& rng) {
+	std::uniform_real_distribution<float> pos(-100, 100);
+	std::uniform_real_distribution<float> size(0, 4);
+	std::vector<box3> result(n);
+	for(box3& b : result) {
+		vec3 const p(pos(rng), pos(rng), pos(rng));
+		b = box3(p, p + vec3(size(rng), size(rng), size(rng)));
+	}
+	return result;
+}
+
+static
+float hit_distance(box3 const& b, ray3 const& r, float t_max) {
+	float t;
+	if(!b.intersect(r, 0, t_max, t)) return std::numeric_limits<float>::infinity();
+	return std::max(t, 0.f);
+}
+
+/// Compares all queries against brute force, returns the number of mismatches
+static
+int compare_queries(bvh const& tree, std::vector<box3> const& boxes, std::mt19937& rng) {
+	std::uniform_real_distribution<float> pos(-120, 120);
+
+	int mismatches = 0;
+	for(int i = 0; i < 300; i++) {
+		ray3 const r(vec3(pos(rng), pos(rng), pos(rng)), vec3(pos(rng), pos(rng), pos(rng)));
+		float const t_max = i % 3 ? std::numeric_limits<float>::infinity() : 100;
+
+		float expected = t_max;
+		for(box3 const& b : boxes) expected = std::min(expected, hit_distance(b, r, expected));
+
+		bvh_hit const hit = tree.closest_hit(r, [&](uint32_t p, ray3 const& r, float t_max) { return hit_distance(boxes[p], r, t_max); }, t_max);
+		if(hit.t != expected || bool(hit) != (expected < t_max)) mismatches++;
+
+		bool const any = tree.any_hit(r, [&](uint32_t p, ray3 const& r, float t_max) { return hit_distance(boxes[p], r, t_max) <= t_max; }, t_max);
+		if(any != (expected < t_max)) mismatches++;
+
+		vec3 const p(pos(rng), pos(rng), pos(rng));
+		box3 const query(p, p + vec3(10));
+		std::vector<uint32_t> found, expected_found;
+		tree.overlap(query, [&](uint32_t p) { if(boxes[p].intersects(query)) found.push_back(p); });
+		for(uint32_t k = 0; k < boxes.size(); k++) {
+			if(boxes[k].intersects(query)) expected_found.push_back(k);
+		}
+		std::sort(found.begin(), found.end());
+		if(found != expected_found) mismatches++;
+	}
+	return mismatches;
+}
+
+static
+void test_bvh_queries() {
+	std::mt19937 rng(11);
+
+	bvh empty_tree(nullptr, 0);
+	test(empty_tree.empty());
+	test(!empty_tree.closest_hit(ray3(), [](uint32_t, ray3 const&, float) { return 0.f; }));
+
+	std::vector<box3> single = { box3(vec3(-1), vec3(1)) };
+	bvh single_tree(single.data(), single.size());
+	test(compare_queries(single_tree, single, rng) == 0);
+
+	std::vector<box3> boxes = random_boxes(3000, rng);
+	bvh tree(boxes.data(), boxes.size());
+	test(tree.size() == boxes.size());
+	test(tree.bounds().contains(boxes[0]) && tree.bounds().contains(boxes[2999]));
+	test(compare_queries(tree, boxes, rng) == 0);
+
+	// Unit cells of a grid share their faces, axis aligned rays along grid lines run inside them
+	std::vector<box3> grid;
+	for(int x = 0; x < 6; x++) for(int y = 0; y < 6; y++) for(int z = 0; z < 6; z++) {
+		grid.push_back(box3(vec3(x, y, z), vec3(x + 1, y + 1, z + 1)));
+	}
+	bvh grid_tree(grid.data(), grid.size());
+	bool grid_ok = true;
+	for(int y = 0; y <= 6; y++) {
+		ray3 const r(vec3(-5, y, 0.5f), vec3(1, 0, 0));
+		bvh_hit const hit = grid_tree.closest_hit(r, [&](uint32_t p, ray3 const& r, float t_max) { return hit_distance(grid[p], r, t_max); });
+		grid_ok &= hit && hit.t == 5;
+		grid_ok &= grid_tree.any_hit(r, [&](uint32_t p, ray3 const& r, float t_max) { return hit_distance(grid[p], r, t_max) <= t_max; }, 100);
+	}
+	test(grid_ok);
+
+	// Identical boxes leave no SAH split, the builder has to fall back to median splits
+	std::vector<box3> same(100, box3(vec3(0), vec3(1)));
+	bvh same_tree(same.data(), same.size());
+	test(compare_queries(same_tree, same, rng) == 0);
+}
+
+static
+void test_bvh_parallel_build() {
+	std::mt19937 rng(12);
+	std::vector<box3> boxes = random_boxes(20000, rng);
+
+	bvh_build_options options;
+	options.threads = 4;
+	bvh tree(boxes.data(), boxes.size(), options);
+	test(compare_queries(tree, boxes, rng) == 0);
+}
+
+static
+void test_bvh_refit() {
+	std::mt19937 rng(13);
+	std::vector<box3> boxes = random_boxes(2000, rng);
+	bvh tree(boxes.data(), boxes.size());
+
+	std::uniform_real_distribution<float> offset(-20, 20);
+	for(box3& b : boxes) {
+		vec3 const d(offset(rng), offset(rng), offset(rng));
+		b = box3(b.min + d, b.max + d);
+	}
+	tree.refit(boxes.data());
+	test(compare_queries(tree, boxes, rng) == 0);
+}
+
+void test_bvh() {
+	test_bvh_queries();
+	test_bvh_parallel_build();
+	test_bvh_refit();
+}
@@ -0,0 +1,73 @@
+#include "test.hpp"
+
+#include <xmath/camera>
+
+#include <cmath>
+
+using namespace stx;
+using namespace test_helpers;
+
+static
+void test_camera_matrices() {
+	vec3 const position(1, 2, 3);
+	quat const orientation = quat::angle_axis(.3f, vec3(0, 1, 1).normalize());
+	camera cam(position, orientation, 1.2f, 16.f / 9, .1f, 100.f);
+
+	test(cam.dirty());
+	mat4 const pose = mat4::transform(orientation, position);
+	test(near(cam.inverse_view(), pose, 1e-6f));
+	test(near(cam.view(), pose.inverse(), 1e-5f));
+	test(near(cam.projection(), perspective(1.2f, 16, 9, .1f, 100.f), 1e-6f));
+	test(near(cam.inverse_projection(), cam.projection().inverse(), 1e-5f));
+	test(near(cam.view_projection(), cam.projection() * cam.view(), 1e-6f));
+	test(near(cam.inverse_view_projection(), cam.view_projection().inverse(), 1e-4f));
+	// Only the frustum is left
+	test(cam.dirty());
+	cam.frustum();
+	test(!cam.dirty());
+
+	// A point in front of the camera round trips through clip space. Depth precision falls off with distance
+	// from the near plane, so the error is relative to the distance from the camera.
+	vec3 const p = position + orientation * vec3(.5f, -.2f, -10);
+	vec4 const clip = cam.view_projection() * vec4(p.x, p.y, p.z, 1);
+	vec4 const back = cam.inverse_view_projection() * clip;
+	test((vec3(back.x, back.y, back.z) / back.w - p).length() < 1e-3f * (p - position).length());
+	test(cam.frustum().contains(p));
+	test(!cam.frustum().contains(position - orientation * vec3(.5f, -.2f, -10)));
+}
+
+static
+void test_camera_caching() {
+	camera cam;
+	cam.update();
+	test(!cam.dirty());
+
+	// Same object until an input changes
+	mat4 const* cached = &cam.view_projection();
+	test(&cam.view_projection() == cached);
+
+	mat4 const view = cam.view();
+	mat4 const projection = cam.projection();
+	cam.set_position(vec3(0, 0, 5));
+	test(cam.dirty());
+	test(near(cam.projection(), projection, 0));
+	test(!near(cam.view(), view, 1e-3f));
+	test(near(cam.view_projection(), cam.projection() * cam.view(), 1e-6f));
+
+	cam.set_aspect(2);
+	test(near(cam.projection(), perspective(1.f, 2, 1, .1f, 1000.f), 1e-6f));
+	test(near(cam.view_projection(), cam.projection() * cam.view(), 1e-6f));
+
+	cam.set_clip(1, 10);
+	test(fabsf(cam.frustum().distance(frustum::plane_far, vec3(0, 0, -2)) - 3) < 1e-3f);
+
+	cam.look_at(vec3(0, 0, 0));
+	vec4 const center = cam.view() * vec4(0, 0, 0, 1);
+	test(near(center, vec4(0, 0, -5, 1), 1e-5f));
+	test(cam.frustum().contains(vec3(0, 0, 0)));
+}
+
+void test_camera() {
+	test_camera_matrices();
+	test_camera_caching();
+}
@@ -0,0 +1,112 @@
+#include "test.hpp"
+
+#include <xmath/constexpr_math>
+#include <xmath/quat>
+#include <xmath/vec>
+#include <xmath/perspective>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace stx;
+
+static_assert(constexpr_sqrt(16.f) == 4.f, "constexpr_sqrt");
+static_assert(constexpr_sin(0.f) == 0.f && constexpr_cos(0.f) == 1.f, "constexpr_sin, constexpr_cos");
+static_assert(constexpr_sin(1e30f) != constexpr_sin(1e30f), "constexpr_sin is nan for huge x");
+static_assert(constexpr_atan2(1.f, 1.f) == float(M_PI / 4), "constexpr_atan2");
+static_assert(constexpr_acos(-1.f) == float(M_PI), "constexpr_acos");
+
+#if defined(STX_MATH_HAS_CONSTEXPR_MATH)
+
+static_assert(vec3(3, 0, 4).length() == 5, "vec3::length");
+static_assert(vec3(3, 0, 4).normalize() == vec3(.6f, 0, .8f), "vec3::normalize");
+static_assert(dvec3(1, 2, 2).length() == 3, "vec<N, T>::length");
+
+// A constant table of rotations, built at compile time
+constexpr quat rotations[] = {
+	quat::angle_axis(.5f, vec3(1, 0, 0)),
+	quat::angle_axis(1.5f, vec3(0, 1, 0)),
+	quat::roll_pitch_yaw(vec3(.1f, .2f, .3f)),
+	quat(1, 2, 3, 4).normalize(),
+};
+constexpr vec3 along       = vec3::look_along(vec3(1, 1, -1));
+constexpr mat4 projection  = perspective(1.f, 16, 9, .1f, 100.f);
+
+#endif
+
+namespace {
+
+/// Distance in units in the last place
+int32_t ulps(float a, float b) {
+	int32_t ia = 0, ib = 0;
+	std::memcpy(&ia, &a, 4);
+	std::memcpy(&ib, &b, 4);
+	if(ia < 0) ia = INT32_MIN - ia;
+	if(ib < 0) ib = INT32_MIN - ib;
+	return ia > ib ? ia - ib : ib - ia;
+}
+
+void test_constexpr_functions() {
+	bool sqrt_exact = true;
+	for(float x = 1e-30f; x < 1e30f; x *= 1.0137f) sqrt_exact &= constexpr_sqrt(x) == std::sqrt(x);
+	test(sqrt_exact);
+	test(constexpr_sqrt(0.f) == 0.f);
+	test(std::isnan(constexpr_sqrt(-1.f)));
+
+	int32_t err_sin = 0, err_cos = 0, err_tan = 0;
+	for(float x = -1e5f; x <= 1e5f; x += 1.37f) {
+		err_sin = std::max(err_sin, ulps(constexpr_sin(x), (float) std::sin((double) x)));
+		err_cos = std::max(err_cos, ulps(constexpr_cos(x), (float) std::cos((double) x)));
+		err_tan = std::max(err_tan, ulps(constexpr_tan(x), (float) std::tan((double) x)));
+	}
+	test(err_sin <= 1);
+	test(err_cos <= 1);
+	test(err_tan <= 1);
+
+	// Beyond 2^52 * pi/2 the quadrant doesn't fit the reduction any more
+	test(std::isnan(constexpr_sin(1e30f)));
+	test(std::isnan(constexpr_cos(-1e30f)));
+	test(std::isnan(constexpr_tan(1e30f)));
+	test(std::isfinite(constexpr_sin(7e15f)));
+
+	int32_t err_atan = 0, err_atan2 = 0, err_acos = 0;
+	for(float x = -100; x <= 100; x += .0137f) {
+		err_atan  = std::max(err_atan,  ulps(constexpr_atan(x), (float) std::atan((double) x)));
+		err_atan2 = std::max(err_atan2, ulps(constexpr_atan2(x, -3.f), (float) std::atan2((double) x, -3.)));
+	}
+	for(float x = -1; x <= 1; x += 1e-4f) {
+		err_acos = std::max(err_acos, ulps(constexpr_acos(x), (float) std::acos((double) x)));
+	}
+	test(err_atan  <= 1);
+	test(err_atan2 <= 1);
+	test(err_acos  <= 1);
+	test(std::isnan(constexpr_acos(1.5f)));
+}
+
+void test_constexpr_members() {
+#if defined(STX_MATH_HAS_CONSTEXPR_MATH)
+	// The compile time results match the runtime ones
+	auto close = [](quat const& a, quat const& b) { return std::abs(a.w - b.w) + std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z) < 1e-6f; };
+	test(close(rotations[0], quat::angle_axis(.5f, vec3(1, 0, 0))));
+	test(close(rotations[1], quat::angle_axis(1.5f, vec3(0, 1, 0))));
+	test(close(rotations[2], quat::roll_pitch_yaw(vec3(.1f, .2f, .3f))));
+	test(close(rotations[3], quat(1, 2, 3, 4).normalize()));
+
+	vec3 const runtime_along = vec3::look_along(vec3(1, 1, -1));
+	test((along - runtime_along).length() < 1e-5f);
+
+	mat4 const runtime_projection = perspective(1.f, 16, 9, .1f, 100.f);
+	bool same = true;
+	for(unsigned i = 0; i < 16; i++) same &= std::abs(projection.data[i] - runtime_projection.data[i]) < 1e-6f;
+	test(same);
+#endif
+}
+
+} // namespace
+
+void test_constexpr_math() {
+	test_constexpr_functions();
+	test_constexpr_members();
+}
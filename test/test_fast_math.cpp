@@ -0,0 +1,74 @@
+#include "test.hpp"
+
+#include <xmath/fast_math>
+#include <xmath/quat>
+#include <xmath/vec2>
+#include <xmath/vec4>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace stx;
+
+static
+void test_fast_rsqrt() {
+	double err = 0;
+	for(float x = 1e-30f; x < 1e30f; x *= 1.001f) {
+		err = std::max(err, std::abs(fast_rsqrt(x) * std::sqrt((double) x) - 1));
+	}
+	test(err < 5e-7);
+
+	test(std::abs(vec3(3, 0, 4).normalize().length() - 1) < 1e-6f);
+	test(std::abs(vec2(3, 4).normalized().length() - 1) < 1e-6f);
+	test(std::abs(vec4(1, 2, 3, 4).normalize().length() - 1) < 1e-6f);
+	test(std::abs(quat(2, 3, 5, 7).normalize().length() - 1) < 1e-6f);
+}
+
+static
+void test_fast_trig() {
+	double err_sin = 0, err_cos = 0;
+	for(float x = -8192; x <= 8192; x += .00731f) {
+		float s, c;
+		fast_sincos(x, s, c);
+		err_sin = std::max(err_sin, std::abs(s - std::sin((double) x)));
+		err_cos = std::max(err_cos, std::abs(c - std::cos((double) x)));
+	}
+	test(err_sin < 2e-7);
+	test(err_cos < 2e-7);
+	test(fast_sin(0) == 0);
+	test(fast_cos(0) == 1);
+
+	// Huge inputs are clamped before the quadrant is converted to an integer
+	bool huge_ok = true;
+	for(float x : { 1e7f, -3e9f, 1e30f, -std::numeric_limits<float>::max(), std::numeric_limits<float>::infinity() }) {
+		float s, c;
+		fast_sincos(x, s, c);
+		huge_ok &= std::abs(s) <= 1.01f && std::abs(c) <= 1.01f;
+	}
+	test(huge_ok);
+	test(std::isnan(fast_sin(std::numeric_limits<float>::quiet_NaN())));
+
+	double err_atan2 = 0;
+	for(float y = -3; y <= 3; y += .0173f) {
+		for(float x = -3; x <= 3; x += .0173f) {
+			err_atan2 = std::max(err_atan2, std::abs(fast_atan2(y, x) - std::atan2((double) y, (double) x)));
+		}
+	}
+	test(err_atan2 < 3e-6);
+	test(fast_atan2(0, 0) == 0);
+	test(fast_atan2(0, -1) == std::atan2(0.f, -1.f));
+
+	double err_acos = 0;
+	for(float x = -1; x <= 1; x += 1e-5f) {
+		err_acos = std::max(err_acos, std::abs(fast_acos(x) - std::acos((double) x)));
+	}
+	test(err_acos < 5e-7);
+	test(fast_acos(1.0001f) == 0);
+	test(std::abs(fast_acos(-1.0001f) - std::acos(-1.f)) < 1e-6f);
+}
+
+void test_fast_math() {
+	test_fast_rsqrt();
+	test_fast_trig();
+}
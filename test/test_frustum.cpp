@@ -0,0 +1,89 @@
+#include "test.hpp"
+
+#include <xmath/frustum>
+#include <xmath/perspective>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+namespace {
+
+frustum test_frustum() {
+	mat4 view = mat4::transform(quat::angle_axis(.3f, vec3::yaxis()), vec3(1, 2, 3)).inverse_rigid();
+	return frustum(perspective(1.2f, 16, 9, .1f, 100.f) * view);
+}
+
+bool bit(std::vector<uint32_t> const& mask, size_t i) {
+	return mask[i / 32] >> (i % 32) & 1;
+}
+
+} // namespace
+
+static
+void test_frustum_planes() {
+	frustum f(perspective(1.2f, 1, 1, 1.f, 10.f));
+
+	test(f.contains(vec3(0, 0, -5)));
+	test(!f.contains(vec3(0, 0, 5)));
+	test(!f.contains(vec3(0, 0, -11)));
+	test(!f.contains(vec3(0, 0, -.5f)));
+	test(!f.contains(vec3(100, 0, -5)));
+
+	test(fabsf(f.distance(frustum::plane_near, vec3(0, 0, -3)) - 2) < 1e-4f);
+	test(fabsf(f.distance(frustum::plane_far,  vec3(0, 0, -3)) - 7) < 1e-3f);
+
+	test(f.intersects_sphere(vec3(0, 0, 2), 3.5f));
+	test(!f.intersects_sphere(vec3(0, 0, 2), 2.5f));
+	test(f.intersects_box(vec3(-1, -1, -12), vec3(1, 1, -9)));
+	test(!f.intersects_box(vec3(-1, -1, -13), vec3(1, 1, -11)));
+}
+
+static
+void test_frustum_batch() {
+	frustum f = test_frustum();
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> pos(-120, 120), size(0, 5);
+
+	size_t const n = 1003;
+	std::vector<vec4> spheres(n);
+	std::vector<vec3> mins(n), maxs(n);
+	for(size_t i = 0; i < n; i++) {
+		spheres[i] = vec4(pos(rng), pos(rng), pos(rng), size(rng));
+		mins[i] = vec3(pos(rng), pos(rng), pos(rng));
+		maxs[i] = mins[i] + vec3(size(rng), size(rng), size(rng));
+	}
+
+	std::vector<uint32_t> sphere_mask((n + 31) / 32), box_mask((n + 31) / 32);
+	f.cull_spheres(spheres.data(), n, sphere_mask.data());
+	f.cull_boxes(mins.data(), maxs.data(), n, box_mask.data());
+
+	std::vector<uint32_t> cached_sphere_mask((n + 31) / 32), cached_box_mask((n + 31) / 32);
+	std::vector<uint8_t> sphere_cache(n), box_cache(n);
+
+	bool spheres_ok = true, boxes_ok = true, cache_ok = true;
+	size_t visible = 0;
+	for(int frame = 0; frame < 2; frame++) {
+		f.cull_spheres(spheres.data(), n, cached_sphere_mask.data(), sphere_cache.data());
+		f.cull_boxes(mins.data(), maxs.data(), n, cached_box_mask.data(), box_cache.data());
+		for(size_t i = 0; i < n; i++) {
+			bool s = f.intersects_sphere(vec3(spheres[i].x, spheres[i].y, spheres[i].z), spheres[i].w);
+			bool b = f.intersects_box(mins[i], maxs[i]);
+			spheres_ok &= bit(sphere_mask, i) == s;
+			boxes_ok   &= bit(box_mask, i) == b;
+			cache_ok   &= bit(cached_sphere_mask, i) == s && bit(cached_box_mask, i) == b;
+			visible += s;
+		}
+	}
+	test(spheres_ok);
+	test(boxes_ok);
+	test(cache_ok);
+	test(visible > 0 && visible < 2 * n);
+}
+
+void test_frustum() {
+	test_frustum_planes();
+	test_frustum_batch();
+}
@@ -0,0 +1,119 @@
+#include "test.hpp"
+
+#include <xmath/hierarchy>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+/// World matrix by walking the parent chain, the way update() avoids
+static
+mat4 world_by_parents(transform_hierarchy const& h, uint32_t node) {
+	mat4 result = h.local(node);
+	for(uint32_t p = h.parent(node); p != transform_hierarchy::none; p = h.parent(p)) result = h.local(p) * result;
+	return result;
+}
+
+static
+bool all_up_to_date(transform_hierarchy const& h) {
+	for(uint32_t i = 0; i < h.size(); i++) {
+		if(h.dirty(i) || max_difference(h.world(i), world_by_parents(h, i)) > 1e-3f) return false;
+	}
+	return true;
+}
+
+static
+mat4 random_transform(std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-1, 1);
+	return mat4::transform(
+		quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize(),
+		vec3(dist(rng), dist(rng), dist(rng))
+	);
+}
+
+static
+void test_hierarchy_small() {
+	transform_hierarchy h;
+	uint32_t const root  = h.add(transform_hierarchy::none, mat4::translation(vec3(1, 0, 0)));
+	uint32_t const child = h.add(root, vec3(0, 2, 0), quat(), vec3(2));
+	uint32_t const leaf  = h.add(child, mat4::translation(vec3(0, 0, 1)));
+	h.update();
+
+	test(!h.dirty(leaf));
+	test(h.world(leaf).translation() == vec3(1, 2, 2));
+
+	h.set_local(root, mat4::translation(vec3(0, 0, 0)));
+	test(h.dirty(root) && !h.dirty(leaf));
+	h.update();
+	test(h.world(leaf).translation() == vec3(0, 2, 2));
+
+	// Only the changed subtree is touched
+	uint32_t const other = h.add(transform_hierarchy::none, mat4::translation(vec3(5, 0, 0)));
+	h.update();
+	h.set_local(leaf, mat4::translation(vec3(0, 0, 3)));
+	h.update();
+	test(h.world(leaf).translation() == vec3(0, 2, 6));
+	test(h.world(other).translation() == vec3(5, 0, 0));
+	test(all_up_to_date(h));
+}
+
+/// The translation, rotation and scale overloads match the mat4 ones with translation * rotation * scale, non uniform scales included
+static
+void test_hierarchy_trs() {
+	quat const r = quat::angle_axis(.7f, vec3(1, 2, 3).normalize());
+	quat const r2 = quat::angle_axis(-1.3f, vec3(2, -1, 1).normalize());
+	vec3 const t(1, 2, 3), s(1, 2, 3), s2(.5f, 4, 2);
+	auto trs_matrix = [](vec3 const& t, quat const& r, vec3 const& s) { return mat4::translation(t) * mat4::rotation(r) * mat4::scaling(s); };
+
+	transform_hierarchy a, b;
+	uint32_t const a_root  = a.add(transform_hierarchy::none, t, r, s);
+	uint32_t const a_child = a.add(a_root, vec3(-2, 0, 1), r2, s2);
+	uint32_t const b_root  = b.add(transform_hierarchy::none, trs_matrix(t, r, s));
+	uint32_t const b_child = b.add(b_root, trs_matrix(vec3(-2, 0, 1), r2, s2));
+	a.update();
+	b.update();
+	test(max_difference(a.local(a_root), b.local(b_root)) < 1e-5f);
+	test(max_difference(a.world(a_child), b.world(b_child)) < 1e-5f);
+
+	a.set_local(a_root, vec3(0, 1, 0), r2, s2);
+	b.set_local(b_root, trs_matrix(vec3(0, 1, 0), r2, s2));
+	a.update();
+	b.update();
+	test(max_difference(a.world(a_child), b.world(b_child)) < 1e-5f);
+}
+
+static
+void test_hierarchy_random(unsigned threads) {
+	std::mt19937 rng(21);
+
+	// Mostly deep chains with some wide fan outs, big enough for the parallel path
+	transform_hierarchy h;
+	for(uint32_t i = 0; i < 20000; i++) {
+		uint32_t const parent = i < 4 ? transform_hierarchy::none : std::uniform_int_distribution<uint32_t>(i * 3 / 4, i - 1)(rng);
+		h.add(parent, random_transform(rng));
+	}
+	h.update(threads);
+	test(all_up_to_date(h));
+
+	for(int round = 0; round < 3; round++) {
+		for(int k = 0; k < 50; k++) {
+			h.set_local(std::uniform_int_distribution<uint32_t>(0, 19999)(rng), random_transform(rng));
+		}
+		h.update(threads);
+		test(all_up_to_date(h));
+	}
+
+	// Moving a root dirties almost everything below it
+	h.set_local(0, random_transform(rng));
+	h.update(threads);
+	test(all_up_to_date(h));
+}
+
+void test_hierarchy() {
+	test_hierarchy_small();
+	test_hierarchy_trs();
+	test_hierarchy_random(1);
+	test_hierarchy_random(4);
+}
@@ -0,0 +1,100 @@
+#include "test.hpp"
+
+#include <xmath/mat>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace stx;
+
+namespace {
+
+template<unsigned R, unsigned C, class T>
+double max_difference(mat<R, C, T> const& a, mat<R, C, T> const& b) {
+	double result = 0;
+	for(unsigned c = 0; c < C; c++) {
+		for(unsigned r = 0; r < R; r++) result = std::max(result, (double) std::abs(a(r, c) - b(r, c)));
+	}
+	return result;
+}
+
+void test_mat_generic() {
+	dmat3 const a(
+		2, 0, 1,
+		1, 3, 0,
+		0, 1, 4
+	);
+	test(a(0, 2) == 1 && a[2][0] == 1); // row 0, column 2
+	test(a.determinant() == 2 * 12 - 0 + 1 * 1);
+	test(max_difference(a * a.inverse(), dmat3()) < 1e-12);
+	test(a.transpose().transpose() == a);
+	test(a * dvec3(1, 1, 1) == dvec3(3, 4, 5));
+
+	// Same results as the float specializations
+	mat3 const f(
+		2, 0, 1,
+		1, 3, 0,
+		0, 1, 4
+	);
+	test(dmat3(f) == a);
+	test(mat3(a) == f);
+	test(fabsf(f.determinant() - (float) a.determinant()) < 1e-5f);
+
+	mat4 const m4 = mat4::translation(vec3(1, 2, 3)) * mat4::scaling(vec3(2, 3, 4));
+	dmat4 const d4(m4);
+	test(max_difference(d4 * d4.inverse(), dmat4()) < 1e-12);
+	test(d4 * dvec4(1, 1, 1, 1) == dvec4(3, 5, 7, 1));
+	test(fabs(d4.determinant() - m4.determinant()) < 1e-9);
+
+	// dmat4 products take simd::double4 columns with STX_MATH_SIMD, integer inputs keep them exact
+	dmat4 const g(
+		1,  2,  3,  4,
+		5,  6,  7,  8,
+		9, 10, 11, 12,
+		13, 14, 15, 16
+	);
+	mat<4, 4, int> const gi(g);
+	test(g * g.transpose() == dmat4(gi * gi.transpose()));
+	test(g * dvec4(2, -1, 3, 1) == dvec4(gi * ivec4(2, -1, 3, 1)));
+	using dmat4x2 = mat<4, 2, double>;
+	using imat4x2 = mat<4, 2, int>;
+	dmat4x2 const k(
+		1, 2,
+		3, 4,
+		5, 6,
+		7, 8
+	);
+	test(g * k == dmat4x2(gi * imat4x2(k)));
+
+	constexpr dmat4 s = dmat4(2.) * dmat4(3.);
+	static_assert(s(1, 1) == 6 && s(0, 1) == 0, "dmat4 products are constexpr");
+
+	// Non square shapes
+	mat<2, 3, double> const p(
+		1, 2, 3,
+		4, 5, 6
+	);
+	mat<3, 2, double> const t = p.transpose();
+	test(t(2, 1) == 6 && t(0, 1) == 4);
+	dmat2 const pp = p * t;
+	test(pp == dmat2(14, 32, 32, 77));
+	test(p * dvec3(1, 0, -1) == dvec2(-2, -2));
+
+	// Integer matrices stay exact
+	mat<3, 3, int> const i(
+		1, 2, 3,
+		0, 1, 4,
+		5, 6, 0
+	);
+	test(i.determinant() == 1);
+	test(i * ivec3(1, 1, 1) == ivec3(6, 5, 11));
+
+	mat<2, 2, int> const cols(ivec2(1, 2), ivec2(3, 4));
+	test(cols(1, 0) == 2 && cols(0, 1) == 3);
+}
+
+} // namespace
+
+void test_mat() {
+	test_mat_generic();
+}
@@ -88,9 +88,22 @@ void test_determinant() {
 	test(mat3(0, 1, 2, 3, 2, 1, 1, 1, 0).determinant() == 3);
 }
 
+static
+void test_inverse() {
+	mat3 m(
+		2, 3,  5,
+		7, 11, 13,
+		17, 19, 23
+	);
+	test(m * m.inverse() == mat3());
+	test(m.inverse() * m == mat3());
+	test(rotx.inverse() == rotx.transpose());
+}
+
 void test_mat3() {
 	test_mat3_multiplication();
 	test_mat3_rotation();
 	test_quat_to_mat3();
 	test_determinant();
+	test_inverse();
 }
@@ -2,6 +2,83 @@
 
 #include <xmath/mat4>
 
+#include <cfloat>
+#include <random>
+
+using namespace stx;
+using namespace test_helpers;
+
+namespace {
+
+mat4 random_mat4(std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-10, 10);
+	mat4 m;
+	for(size_t i = 0; i < 16; i++)
+		m.data[i] = dist(rng);
+	return m;
+}
+
+} // namespace
+
+static
+void test_mat4_multiplication() {
+	mat4 a(
+		 2,  3,  5,  7,
+		11, 13, 17, 19,
+		23, 29, 31, 37,
+		41, 43, 47, 53
+	);
+	test(memcmp((a * mat4::identity()).data, a.data, sizeof(a.data)) == 0);
+	test(memcmp((mat4::identity() * a).data, a.data, sizeof(a.data)) == 0);
+
+	vec4 v = a * vec4(1, 2, 3, 4);
+	test(v == vec4(2 + 6 + 15 + 28, 11 + 26 + 51 + 76, 23 + 58 + 93 + 148, 41 + 86 + 141 + 212));
+
+	// Compare against a double precision reference within the bound documented on mat4::operator*
+	std::mt19937 rng(42);
+	bool within_bound = true;
+	for(int n = 0; n < 100; n++) {
+		mat4 x = random_mat4(rng);
+		mat4 y = random_mat4(rng);
+		mat4 p = x * y;
+		for(size_t col = 0; col < 4; col++) {
+			for(size_t row = 0; row < 4; row++) {
+				double exact = 0, magnitude = 0;
+				for(size_t k = 0; k < 4; k++) {
+					exact     += (double) x[k][row] * y[col][k];
+					magnitude += fabs((double) x[k][row] * y[col][k]);
+				}
+				if(fabs(p[col][row] - exact) > 4 * FLT_EPSILON * magnitude)
+					within_bound = false;
+			}
+		}
+	}
+	test(within_bound);
+}
+
+static
+void test_mat4_inverse() {
+	std::mt19937 rng(1337);
+
+	float general_error = 0;
+	for(int n = 0; n < 100; n++) {
+		mat4 m = random_mat4(rng);
+		general_error = fmaxf(general_error, max_difference(m * m.inverse(), mat4::identity()));
+	}
+	test(general_error < 1e-3f);
+
+	test(fabsf(mat4(2.f).determinant() - 8) < 1e-6f);
+
+	mat4 rigid  = mat4::transform(quat::angle_axis(float(M_PI / 6), vec3(1, 2, 3).normalize()), vec3(4, -5, 6));
+	mat4 affine = mat4::transform(quat::angle_axis(1.2f, vec3(-3, 1, 2).normalize()), vec3(-1, 7, 2), vec3(2, .5f, 3));
+
+	test(max_difference(rigid * rigid.inverse_rigid(), mat4::identity()) < 1e-5f);
+	test(max_difference(rigid.inverse_rigid(), rigid.inverse()) < 1e-5f);
+	test(max_difference(affine * affine.inverse_affine(), mat4::identity()) < 1e-5f);
+	test(max_difference(affine.inverse_affine(), affine.inverse()) < 1e-5f);
+}
+
 void test_mat4() {
-	// TODO
+	test_mat4_multiplication();
+	test_mat4_inverse();
 }
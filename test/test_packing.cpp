@@ -0,0 +1,167 @@
+#include "test.hpp"
+
+#include <xmath/packing>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+
+namespace {
+
+void test_half() {
+	test(float_to_half(0.f)  == 0x0000);
+	test(float_to_half(-0.f) == 0x8000);
+	test(float_to_half(1.f)  == 0x3C00);
+	test(float_to_half(-2.f) == 0xC000);
+	test(float_to_half(65504.f) == 0x7BFF);
+	test(float_to_half(1e6f) == 0x7C00);
+	test(float_to_half(5.9604645e-8f) == 0x0001); // smallest subnormal
+	test(float_to_half(1.f + 1.f / 2048) == 0x3C00); // ties round to even
+	test(float_to_half(1.f + 3.f / 2048) == 0x3C02);
+	test(float_to_half(1.f + 3.f / 4096) == 0x3C01);
+	test(std::isnan(half_to_float(float_to_half(NAN))));
+
+	// Every half survives the round trip
+	bool exact = true;
+	for(uint32_t h = 0; h < 0x10000; h++) {
+		if((h & 0x7C00) == 0x7C00 && (h & 0x3FF)) continue; // nan
+		exact &= float_to_half(half_to_float((uint16_t) h)) == h;
+	}
+	test(exact);
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-1000, 1000);
+	std::vector<vec3> in(37);
+	for(vec3& v : in) v = vec3(dist(rng), dist(rng), dist(rng) * 1e-3f);
+
+	std::vector<half3> packed(in.size());
+	std::vector<vec3> out(in.size());
+	pack_batch(in.data(), packed.data(), in.size());
+	unpack_batch(packed.data(), out.data(), in.size());
+
+	bool same = true, close = true;
+	for(size_t i = 0; i < in.size(); i++) {
+		half3 const single(in[i]);
+		for(unsigned k = 0; k < 3; k++) {
+			same  &= single.v[k] == packed[i].v[k];
+			close &= std::abs(out[i][k] - in[i][k]) <= std::abs(in[i][k]) * (1.f / 2048);
+		}
+		same &= out[i] == single.unpack();
+	}
+	test(same);
+	test(close);
+}
+
+void test_normalized() {
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dist(-1.1f, 1.1f);
+	std::vector<vec4> in(23);
+	for(vec4& v : in) v = vec4(dist(rng), dist(rng), dist(rng), dist(rng));
+
+	std::vector<snorm16x4> s(in.size());
+	std::vector<unorm8x4>  u(in.size());
+	std::vector<vec4> out_s(in.size()), out_u(in.size());
+	pack_batch(in.data(), s.data(), in.size());
+	pack_batch(in.data(), u.data(), in.size());
+	unpack_batch(s.data(), out_s.data(), in.size());
+	unpack_batch(u.data(), out_u.data(), in.size());
+
+	bool ok = true;
+	for(size_t i = 0; i < in.size(); i++) {
+		for(unsigned k = 0; k < 4; k++) {
+			float const f = in[i].xyzw[k];
+			ok &= std::abs(out_s[i].xyzw[k] - std::max(-1.f, std::min(1.f, f))) <= 1.53e-5f;
+			ok &= std::abs(out_u[i].xyzw[k] - std::max(0.f, std::min(1.f, f))) <= 1.96e-3f;
+			ok &= std::abs(s[i].v[k] - snorm16x4(in[i]).v[k]) <= 1;
+			ok &= u[i].v[k] == unorm8x4(in[i]).v[k];
+		}
+	}
+	test(ok);
+
+	test(snorm16x3(vec3(-1, 0, 1)).unpack() == vec3(-1, 0, 1));
+	test(unorm8x4(vec4(0, 1, .5f, 2)).v[2] == 128);
+	test(unorm8x4(vec4(0, 1, .5f, 2)).v[3] == 255);
+}
+
+void test_oct() {
+	std::mt19937 rng(11);
+	std::normal_distribution<float> dist;
+	std::vector<vec3> in(4099);
+	for(vec3& v : in) v = vec3(dist(rng), dist(rng), dist(rng)).normalize();
+	in[0] = vec3(0, 0, -1);
+	in[1] = vec3(1, 0, 0);
+
+	std::vector<oct16> p16(in.size());
+	std::vector<oct32> p32(in.size());
+	std::vector<vec3> out16(in.size()), out32(in.size());
+	pack_batch(in.data(), p16.data(), in.size());
+	pack_batch(in.data(), p32.data(), in.size());
+	unpack_batch(p16.data(), out16.data(), in.size());
+	unpack_batch(p32.data(), out32.data(), in.size());
+
+	auto angle = [](vec3 const& a, vec3 const& b) { return std::atan2(a.cross(b).length(), a.dot(b)); };
+
+	float max16 = 0, max32 = 0;
+	bool unit = true, same = true;
+	for(size_t i = 0; i < in.size(); i++) {
+		max16 = std::max(max16, angle(in[i], out16[i]));
+		max32 = std::max(max32, angle(in[i], out32[i]));
+		unit &= std::abs(out16[i].length() - 1) < 1e-6f && std::abs(out32[i].length() - 1) < 1e-6f;
+
+		oct16 const single(in[i]);
+		same &= std::abs(single.x - p16[i].x) <= 1 && std::abs(single.y - p16[i].y) <= 1;
+		same &= angle(single.unpack(), out16[i]) < .02f;
+	}
+	test(max16 < .017f);
+	test(max32 < 6.5e-5f);
+	test(unit);
+	test(same);
+}
+
+void test_smallest_three() {
+	std::mt19937 rng(5);
+	std::normal_distribution<float> dist;
+	std::vector<quat> in(1031);
+	for(quat& q : in) q = quat(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+	in[0] = quat();
+	in[1] = quat(0, 0, 0, -1);
+	in[2] = quat(.5f, -.5f, .5f, -.5f);
+
+	std::vector<quat32> p32(in.size());
+	std::vector<quat48> p48(in.size());
+	std::vector<quat> out32(in.size()), out48(in.size());
+	pack_batch(in.data(), p32.data(), in.size());
+	pack_batch(in.data(), p48.data(), in.size());
+	unpack_batch(p32.data(), out32.data(), in.size());
+	unpack_batch(p48.data(), out48.data(), in.size());
+
+	float err32 = 0, err48 = 0, err_single = 0;
+	for(size_t i = 0; i < in.size(); i++) {
+		// Unpacking may flip the sign, which is the same rotation
+		float const s32 = in[i].dot(out32[i]) < 0 ? -1.f : 1.f;
+		float const s48 = in[i].dot(out48[i]) < 0 ? -1.f : 1.f;
+		quat const single = quat32(in[i]).unpack();
+		float const ss = in[i].dot(single) < 0 ? -1.f : 1.f;
+		for(unsigned k = 0; k < 4; k++) {
+			err32 = std::max(err32, std::abs(out32[i].wxyz[k] * s32 - in[i].wxyz[k]));
+			err48 = std::max(err48, std::abs(out48[i].wxyz[k] * s48 - in[i].wxyz[k]));
+			err_single = std::max(err_single, std::abs(single.wxyz[k] * ss - in[i].wxyz[k]));
+		}
+	}
+	test(err32 < 2.1e-3f);
+	test(err48 < 6.5e-5f);
+	test(err_single < 2.1e-3f);
+	test(std::abs(out48[1].z) > .99999f);
+	test(quat48(in[2]).unpack().dot(in[2]) > .99999f);
+}
+
+} // namespace
+
+void test_packing() {
+	test_half();
+	test_normalized();
+	test_oct();
+	test_smallest_three();
+}
@@ -0,0 +1,58 @@
+#include "test.hpp"
+
+#include <xmath/parallel>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace stx;
+
+static
+void test_parallel_for() {
+	// Every index exactly once, over many calls reusing the pool
+	std::vector<int> hits(10007);
+	bool calls_ok = true;
+	for(unsigned threads = 1; threads <= 8; threads++) {
+		for(size_t grain : { size_t(1), size_t(100), size_t(5000), size_t(20000) }) {
+			std::fill(hits.begin(), hits.end(), 0);
+			std::atomic<unsigned> calls{0};
+			parallel_for(3, hits.size(), grain, [&](size_t first, size_t last) {
+				calls++;
+				for(size_t i = first; i < last; i++) hits[i]++;
+			}, threads);
+
+			size_t const expected = std::min<size_t>(threads, (hits.size() - 3 + grain - 1) / grain);
+			calls_ok &= calls == expected && hits[0] == 0 && hits[2] == 0;
+			for(size_t i = 3; i < hits.size(); i++) calls_ok &= hits[i] == 1;
+		}
+	}
+	test(calls_ok);
+
+	bool empty_ok = true;
+	parallel_for(5, 5, 1, [&](size_t, size_t) { empty_ok = false; }, 4);
+	test(empty_ok);
+}
+
+/// Nested calls from inside the ranges, more than there are pool threads, don't deadlock
+static
+void test_parallel_nested() {
+	std::atomic<size_t> sum{0};
+	parallel_for(0, 16, 1, [&](size_t first, size_t last) {
+		for(size_t i = first; i < last; i++) {
+			parallel_for(0, 100, 1, [&](size_t a, size_t b) {
+				for(size_t k = a; k < b; k++) sum += k;
+			}, 4);
+		}
+	}, 8);
+	test(sum == 16 * 4950u);
+
+	int a = 0, b = 0;
+	parallel_invoke([&]() { parallel_invoke([&]() { a += 1; }, [&]() { a += 2; }); }, [&]() { b = 5; });
+	test(a == 3 && b == 5);
+}
+
+void test_parallel() {
+	test_parallel_for();
+	test_parallel_nested();
+}
@@ -0,0 +1,200 @@
+#include "test.hpp"
+
+#include <xmath/projection>
+#include <xmath/camera>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+namespace {
+
+/// Depth of the view space point (0, 0, z)
+float depth_at(mat4 const& projection, float z) {
+	vec4 const clip = projection * vec4(0, 0, z, 1);
+	return clip.z / clip.w;
+}
+
+depth_mode const all_modes[] = { depth_mode::zero_to_one, depth_mode::reverse_z, depth_mode::infinite, depth_mode::infinite_reverse_z };
+
+} // namespace
+
+static
+void test_depth_modes() {
+	float const n = .5f, f = 200.f;
+	mat4 const standard = perspective(1.2f, 4, 3, n, f, depth_mode::zero_to_one);
+	mat4 const reverse  = perspective(1.2f, 4, 3, n, f, depth_mode::reverse_z);
+	mat4 const infinite = perspective(1.2f, 4, 3, n, f, depth_mode::infinite);
+	mat4 const infinite_reverse = perspective(1.2f, 4, 3, n, f, depth_mode::infinite_reverse_z);
+
+	test(near(standard, perspective(1.2f, 4, 3, n, f), 0));
+	test(fabsf(depth_at(standard, -n)) < 1e-6f && fabsf(depth_at(standard, -f) - 1) < 1e-6f);
+	test(fabsf(depth_at(reverse,  -n) - 1) < 1e-6f && fabsf(depth_at(reverse, -f)) < 1e-6f);
+	test(fabsf(depth_at(infinite, -n)) < 1e-6f && depth_at(infinite, -1e6f) < 1 && depth_at(infinite, -1e6f) > .99999f);
+	test(fabsf(depth_at(infinite_reverse, -n) - 1) < 1e-6f && depth_at(infinite_reverse, -1e6f) > 0 && depth_at(infinite_reverse, -1e6f) < 1e-5f);
+
+	// Reverse z keeps distinct depths far away, where the standard mapping rounds many of them together
+	mat4 const far_standard = perspective(1.2f, 4, 3, n, 1e4f, depth_mode::zero_to_one);
+	mat4 const far_reverse  = perspective(1.2f, 4, 3, n, 1e4f, depth_mode::reverse_z);
+	size_t distinct_standard = 0, distinct_reverse = 0;
+	for(unsigned i = 0; i < 10000; i++) {
+		float const z = -5000 - i * .5f, next = z - .5f;
+		distinct_standard += depth_at(far_standard, z) != depth_at(far_standard, next);
+		distinct_reverse  += depth_at(far_reverse, z)  != depth_at(far_reverse, next);
+	}
+	test(distinct_reverse == 10000);
+	test(distinct_standard < 9000);
+
+	// The infinite far plane contains everything
+	frustum const fi(infinite);
+	frustum const fr(infinite_reverse);
+	test(fi.contains(vec3(0, 0, -1e20f)) && fr.contains(vec3(0, 0, -1e20f)));
+	test(!fi.contains(vec3(0, 0, -.1f)) && !fr.contains(vec3(0, 0, -.1f)));
+	test(!fi.contains(vec3(1e6f, 0, -10)));
+
+	// The camera's closed form inverse holds for all modes
+	bool inverses_ok = true;
+	for(depth_mode mode : all_modes) {
+		camera cam(vec3(0), quat(), 1.2f, 4.f / 3, n, f, mode);
+		inverses_ok &= near(cam.inverse_projection(), cam.projection().inverse(), 1e-5f);
+	}
+	test(inverses_ok);
+}
+
+static
+void test_orthographic_depth() {
+	mat4 const o = orthographic(vec2(8, 6), 1, 11);
+	test(fabsf(depth_at(o, -1)) < 1e-6f);
+	test(fabsf(depth_at(o, -6) - .5f) < 1e-6f);
+	test(fabsf(depth_at(o, -11) - 1) < 1e-6f);
+
+	mat4 const r = orthographic(vec2(8, 6), 1, 11, depth_mode::reverse_z);
+	test(fabsf(depth_at(r, -1) - 1) < 1e-6f);
+	test(fabsf(depth_at(r, -11)) < 1e-6f);
+
+	// x and y as before
+	vec4 const p = o * vec4(2, 3, -5, 1);
+	test(p.x == -.5f && p.y == -1 && p.w == 1);
+}
+
+static
+void test_unproject_depth() {
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(.01f, .99f);
+
+	// Enough pixels for 4 chunks of projection_grain, with an odd width for the scalar tail of each row
+	size_t const width = 259, height = 300;
+	test(width * height > 4 * projection_grain);
+	std::vector<float> depth(width * height);
+	for(float& d : depth) d = dist(rng);
+	std::vector<vec3> world(depth.size()), threaded(depth.size()), view(depth.size());
+
+	for(depth_mode mode : all_modes) {
+		camera cam(vec3(1, 2, 3), quat::angle_axis(.4f, vec3(1, 1, 0).normalize()), 1.f, float(width) / height, .5f, 50.f, mode);
+		unproject_depth(cam.inverse_view_projection(), depth.data(), width, height, world.data(), 1);
+		unproject_depth(cam.inverse_view_projection(), depth.data(), width, height, threaded.data(), 4);
+		unproject_depth(cam.inverse_projection(), depth.data(), width, height, view.data());
+		test(world == threaded);
+
+		// Projecting back gives the pixel centers and depths
+		bool world_ok = true, view_ok = true;
+		for(size_t y = 0; y < height; y++) {
+			for(size_t x = 0; x < width; x++) {
+				size_t const i = y * width + x;
+				vec3 const& p = world[i];
+				vec4 const clip = cam.view_projection() * vec4(p.x, p.y, p.z, 1);
+				float const nx = (x + .5f) / width * 2 - 1;
+				float const ny = 1 - (y + .5f) / height * 2;
+				world_ok &= fabsf(clip.x / clip.w - nx) < 1e-4f && fabsf(clip.y / clip.w - ny) < 1e-4f && fabsf(clip.z / clip.w - depth[i]) < 1e-4f;
+
+				vec4 const in_view = cam.view() * vec4(p.x, p.y, p.z, 1);
+				view_ok &= (vec3(in_view.x, in_view.y, in_view.z) - view[i]).length() < 1e-3f * fmaxf(1, view[i].length());
+			}
+		}
+		test(world_ok);
+		test(view_ok);
+	}
+}
+
+static
+void test_project_to_screen() {
+	std::mt19937 rng(25);
+	std::uniform_real_distribution<float> dist(-60, 60);
+
+	camera const cam(vec3(1, 2, 3), quat::angle_axis(.3f, vec3(1, 2, 0).normalize()), 1.f, 16.f / 9, .5f, 40.f);
+	rect const viewport(100, 50, 1600, 900);
+
+	// The center of the view lands in the middle of the viewport, the top edge at its top
+	vec3 const ahead = cam.position() + cam.orientation() * vec3(0, 0, -10);
+	vec3 const up    = cam.position() + cam.orientation() * vec3(0, std::tan(.5f) * 10, -10);
+	vec3 const points[] = { ahead, up };
+	vec2 screen[2];
+	float depth[2];
+	uint8_t clip[2];
+	project_to_screen(cam.view_projection(), viewport, points, 2, screen, depth, clip);
+	test((screen[0] - vec2(900, 500)).length() < 1e-3f);
+	test(fabsf(screen[1].y - 50) < 1e-2f && clip[0] == 0);
+
+	// Against mat4 * vec4, with points outside of every plane and behind the camera
+	// More than 2 chunks of projection_grain, and a tail that isn't a multiple of 8
+	size_t const n = 4 * projection_grain + 5;
+	std::vector<vec3> in(n);
+	for(vec3& p : in) p = vec3(dist(rng), dist(rng), dist(rng));
+
+	std::vector<vec2> out(n), out_threaded(n), out_alone(n);
+	std::vector<float> depths(n), depths_threaded(n);
+	std::vector<uint8_t> codes(n), codes_threaded(n);
+	project_to_screen(cam.view_projection(), viewport, in.data(), n, out.data(), depths.data(), codes.data(), 1);
+	project_to_screen(cam.view_projection(), viewport, in.data(), n, out_threaded.data(), depths_threaded.data(), codes_threaded.data(), 4);
+	project_to_screen(cam.view_projection(), viewport, in.data(), n, out_alone.data());
+	test(out == out_threaded && depths == depths_threaded && codes == codes_threaded);
+	test(out == out_alone);
+
+	bool screen_ok = true, codes_ok = true, visible_ok = true;
+	unsigned seen = 0, visible = 0;
+	for(size_t i = 0; i < n; i++) {
+		vec4 const c = cam.view_projection() * vec4(in[i].x, in[i].y, in[i].z, 1);
+		unsigned code = 0;
+		if(c.x < -c.w) code |= clip_left;
+		if(c.x >  c.w) code |= clip_right;
+		if(c.y < -c.w) code |= clip_bottom;
+		if(c.y >  c.w) code |= clip_top;
+		if(c.z < 0)    code |= clip_near;
+		if(c.z >  c.w) code |= clip_far;
+		// Points within rounding of a plane may land on either side of it, depending on fma contraction
+		float const eps = 1e-5f * fmaxf(1, fabsf(c.w));
+		unsigned on_plane = 0;
+		if(fabsf(c.x + c.w) < eps) on_plane |= clip_left;
+		if(fabsf(c.x - c.w) < eps) on_plane |= clip_right;
+		if(fabsf(c.y + c.w) < eps) on_plane |= clip_bottom;
+		if(fabsf(c.y - c.w) < eps) on_plane |= clip_top;
+		if(fabsf(c.z)       < eps) on_plane |= clip_near;
+		if(fabsf(c.z - c.w) < eps) on_plane |= clip_far;
+		codes_ok &= ((codes[i] ^ code) & ~on_plane) == 0;
+		seen |= code;
+		visible += code == 0;
+
+		// Close to the camera plane the divide magnifies rounding, so only points clearly in front are compared
+		if(c.w > 1) {
+			vec2 const expected(viewport.position.x + (c.x / c.w * .5f + .5f) * viewport.size.x, viewport.position.y + (.5f - c.y / c.w * .5f) * viewport.size.y);
+			screen_ok &= (out[i] - expected).length() < 1e-5f * fmaxf(1000, expected.length()) && fabsf(depths[i] - c.z / c.w) < 1e-4f;
+		}
+		if(code == 0) {
+			visible_ok &= cam.frustum().contains(in[i]) && out[i].x >= 100 && out[i].x <= 1700 && out[i].y >= 50 && out[i].y <= 950;
+		}
+	}
+	test(codes_ok);
+	test(screen_ok);
+	test(visible_ok);
+	test(seen == 63u && visible > 0);
+}
+
+void test_projection() {
+	test_depth_modes();
+	test_orthographic_depth();
+	test_unproject_depth();
+	test_project_to_screen();
+}
@@ -35,6 +35,15 @@ void test_quat_operations() {
 
 	quat q = quat(2, 3, 5, 7).normalize();
 	test((q * q.conjugate() - quat()).length2() < 1e-7f);
+
+	test(quat(2, 3, 5, 7).conjugate() == quat(2, -3, -5, -7));
+	test(-quat(2, 3, 5, 7) == quat(-2, -3, -5, -7));
+	test(quat(2, 3, 5, 7).dot(quat(11, 13, 17, 19)) == 22 + 39 + 85 + 133);
+	test(fabsf(q.length() - 1) < 1e-6f);
+
+	// Round trip through a matrix
+	test((quat(q.to_mat3()) - q).length2() < 1e-10f);
+	test((quat(quat::angle_axis(1.f, vec3::yaxis()).to_mat3()) - quat::angle_axis(1.f, vec3::yaxis())).length2() < 1e-10f);
 }
 
 static
@@ -69,8 +78,36 @@ void test_look_at_look_along() {
 	);
 }
 
+static
+void test_from_mat3() {
+	// Same rotation, either sign
+	auto same = [](quat const& a, quat const& b) { return fminf((a - b).length2(), (a + b).length2()) < 1e-10f; };
+
+	vec3 const axes[] = { vec3::xaxis(), vec3::yaxis(), vec3::zaxis(), vec3(1, 2, 3).normalize(), vec3(-1, 1, -1).normalize() };
+	float const angles[] = { 0, 1e-4f, .5f, 2, 3.1f, 3.14159f, float(M_PI) };
+
+	bool round_trip = true, positive_w = true;
+	for(vec3 const& axis : axes) {
+		for(float angle : angles) {
+			quat const q = quat::angle_axis(angle, axis);
+			quat const r(q.to_mat3());
+			round_trip &= same(r, q);
+			positive_w &= r.w >= 0;
+		}
+	}
+	test(round_trip);
+	test(positive_w);
+
+	// Half turns, where 1 + trace is zero
+	test(same(quat(mat3(1, 0, 0, 0, -1, 0, 0, 0, -1)), quat(0, 1, 0, 0)));
+	test(same(quat(mat3(-1, 0, 0, 0, 1, 0, 0, 0, -1)), quat(0, 0, 1, 0)));
+	test(same(quat(mat3(-1, 0, 0, 0, -1, 0, 0, 0, 1)), quat(0, 0, 0, 1)));
+	test(quat(mat3()) == quat());
+}
+
 void test_quat() {
 	test_quat_operations();
+	test_from_mat3();
 	test_angle_axis();
 	test_look_at_look_along();
 }
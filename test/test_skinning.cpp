@@ -0,0 +1,143 @@
+#include "test.hpp"
+
+#include <xmath/skinning>
+
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+static
+void test_dualquat() {
+	std::mt19937 rng(31);
+
+	bool transforms_ok = true, compose_ok = true, inverse_ok = true, matrix_ok = true;
+	for(int i = 0; i < 100; i++) {
+		quat const r = random_rotation(rng);
+		vec3 const t = random_vec3(rng);
+		vec3 const p = random_vec3(rng);
+		dualquat const a(r, t);
+		dualquat const b(random_rotation(rng), random_vec3(rng));
+
+		transforms_ok &= near(a.transform_point(p), r * p + t) && near(a.translation(), t);
+		compose_ok    &= near((a * b).transform_point(p), a.transform_point(b.transform_point(p)));
+		inverse_ok    &= near(a.conjugate().transform_point(a.transform_point(p)), p);
+		matrix_ok     &= near(dualquat(a.to_mat4()).transform_point(p), a.transform_point(p));
+	}
+	test(transforms_ok);
+	test(compose_ok);
+	test(inverse_ok);
+	test(matrix_ok);
+
+	// Blending two rotations about the same axis is the rotation halfway
+	dualquat const a(quat::angle_axis(0, vec3(0, 0, 1)), vec3(0));
+	dualquat const b(quat::angle_axis(1.5f, vec3(0, 0, 1)), vec3(0));
+	test(near(a.blend(b, .5f).transform_point(vec3(1, 0, 0)), vec3(cosf(.75f), sinf(.75f), 0)));
+}
+
+/// Skinning reference built from the scalar types
+static
+void reference_skin(std::vector<mat4> const& bones, skin_influences const& inf, vec3 const& p, vec3& lbs, vec3& dqs) {
+	mat4 blended = mat4::zero();
+	for(unsigned k = 0; k < 4; k++) {
+		for(unsigned j = 0; j < 16; j++) blended.data[j] += bones[inf.bone[k]].data[j] * inf.weight[k];
+	}
+	lbs = blended * p;
+
+	dualquat const pivot(bones[inf.bone[0]]);
+	dualquat sum = pivot * 0.f;
+	for(unsigned k = 0; k < 4; k++) {
+		dualquat const q(bones[inf.bone[k]]);
+		sum += q * (q.real.dot(pivot.real) < 0 ? -inf.weight[k] : inf.weight[k]);
+	}
+	dqs = sum.normalize().transform_point(p);
+}
+
+static
+void test_skinning_kernels() {
+	std::mt19937 rng(32);
+	std::uniform_int_distribution<uint16_t> bone(0, 15);
+	std::uniform_real_distribution<float>   weight(0, 1);
+
+	std::vector<mat4>        bones;
+	std::vector<skin_matrix> matrices;
+	std::vector<dualquat>    dualquats;
+	for(int i = 0; i < 16; i++) {
+		bones.push_back(mat4::transform(random_rotation(rng), random_vec3(rng)));
+		matrices.push_back(skin_matrix(bones.back()));
+		dualquats.push_back(dualquat(bones.back()));
+	}
+
+	size_t const n = 10000;
+	std::vector<skin_influences> influences(n);
+	std::vector<vec3> positions(n), normals(n);
+	std::vector<vec4> tangents(n);
+	for(size_t i = 0; i < n; i++) {
+		float sum = 0;
+		for(unsigned k = 0; k < 4; k++) {
+			influences[i].bone[k]   = bone(rng);
+			influences[i].weight[k] = weight(rng);
+			sum += influences[i].weight[k];
+		}
+		for(float& w : influences[i].weight) w /= sum;
+		positions[i] = random_vec3(rng);
+		normals[i]   = random_vec3(rng).normalize();
+		vec3 const t = random_vec3(rng).normalize();
+		tangents[i]  = vec4(t.x, t.y, t.z, i % 2 ? 1.f : -1.f);
+	}
+
+	std::vector<vec3> lbs(n), lbs_normals(n), dqs(n), dqs_normals(n), dqs_threaded(n);
+	std::vector<vec4> lbs_tangents(n), dqs_tangents(n);
+
+	skin_streams s;
+	s.positions = positions.data();
+	s.normals   = normals.data();
+	s.tangents  = tangents.data();
+
+	s.out_positions = lbs.data();
+	s.out_normals   = lbs_normals.data();
+	s.out_tangents  = lbs_tangents.data();
+	skin_linear(matrices.data(), influences.data(), n, s, 1);
+
+	s.out_positions = dqs.data();
+	s.out_normals   = dqs_normals.data();
+	s.out_tangents  = dqs_tangents.data();
+	skin_dual_quat(dualquats.data(), influences.data(), n, s, 1);
+
+	bool lbs_ok = true, dqs_ok = true, normals_ok = true, tangents_ok = true;
+	for(size_t i = 0; i < n; i++) {
+		vec3 expected_lbs, expected_dqs;
+		reference_skin(bones, influences[i], positions[i], expected_lbs, expected_dqs);
+		lbs_ok &= near(lbs[i], expected_lbs, 1e-3f);
+		dqs_ok &= near(dqs[i], expected_dqs, 1e-3f);
+		normals_ok &= fabsf(lbs_normals[i].length() - 1) < 1e-4f && fabsf(dqs_normals[i].length() - 1) < 1e-4f;
+		tangents_ok &= lbs_tangents[i].w == tangents[i].w && dqs_tangents[i].w == tangents[i].w;
+	}
+	test(lbs_ok);
+	test(dqs_ok);
+	test(normals_ok);
+	test(tangents_ok);
+
+	// A single rigid bone skins the same in both modes
+	skin_influences const rigid = { { 3, 0, 0, 0 }, { 1, 0, 0, 0 } };
+	vec3 p = positions[0], p_lbs, p_dqs;
+	skin_streams single;
+	single.positions = &p;
+	single.out_positions = &p_lbs;
+	skin_linear(matrices.data(), &rigid, 1, single);
+	single.out_positions = &p_dqs;
+	skin_dual_quat(dualquats.data(), &rigid, 1, single);
+	test(near(p_lbs, bones[3] * p) && near(p_dqs, bones[3] * p));
+
+	// Threads only change who does the work
+	s.normals = nullptr; s.tangents = nullptr;
+	s.out_positions = dqs_threaded.data(); s.out_normals = nullptr; s.out_tangents = nullptr;
+	skin_dual_quat(dualquats.data(), influences.data(), n, s, 4);
+	test(dqs_threaded == dqs);
+}
+
+void test_skinning() {
+	test_dualquat();
+	test_skinning_kernels();
+}
@@ -0,0 +1,87 @@
+#include "test.hpp"
+
+#include <xmath/solve>
+#include <xmath/mat3>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+static
+void test_solve_cramer() {
+	vec3 const a(2, 0, 1), b(1, 3, 0), c(0, 1, 4), x(1, -2, 3);
+	vec3 const d = a * x.x + b * x.y + c * x.z;
+	test(near(mat3::solveWithCramersRule(a, b, c, d), x, 1e-5f));
+}
+
+static
+void test_solve_batch() {
+	std::mt19937 rng(20);
+	std::uniform_real_distribution<float> dist(-10, 10);
+	auto random_vec3 = [&]() { return vec3(dist(rng), dist(rng), dist(rng)); };
+
+	size_t const n = 1003;
+	vec3_soa a(n), b(n), c(n), d(n), x;
+	std::vector<vec3> expected(n);
+	for(size_t i = 0; i < n; i++) {
+		a.set(i, random_vec3());
+		b.set(i, random_vec3());
+		c.set(i, random_vec3());
+		expected[i] = random_vec3();
+		d.set(i, a[i] * expected[i].x + b[i] * expected[i].y + c[i] * expected[i].z);
+	}
+
+	// Singular systems: parallel columns, a zero column, an almost flat one and one in the tail
+	size_t const singular_index[] = { 3, 17, 500, n - 2 };
+	b.set(3, a[3] * 2);
+	c.set(17, vec3(0));
+	c.set(500, a[500] + b[500] + vec3(0, 0, 1e-6f));
+	b.set(n - 2, c[n - 2] * -.5f);
+
+	std::vector<uint8_t> singular(n, 7);
+	size_t const count = solve3_batch(a, b, c, d, x, singular.data());
+	test(count == 4);
+	test(x.size() == n);
+
+	bool flags_ok = true, solutions_ok = true, finite = true;
+	for(size_t i = 0; i < n; i++) {
+		bool const expect_singular = std::find(std::begin(singular_index), std::end(singular_index), i) != std::end(singular_index);
+		flags_ok &= singular[i] == (expect_singular ? 1 : 0);
+		finite   &= std::isfinite(x.x[i]) && std::isfinite(x.y[i]) && std::isfinite(x.z[i]);
+		if(expect_singular) {
+			solutions_ok &= x[i] == vec3(0);
+		}
+		else {
+			// Well conditioned random systems, the residual is what matters
+			vec3 const residual = a[i] * x[i].x + b[i] * x[i].y + c[i] * x[i].z - d[i];
+			solutions_ok &= residual.length() <= 1e-3f * (d[i].length() + 1);
+		}
+	}
+	test(flags_ok);
+	test(solutions_ok);
+	test(finite);
+
+	// Same result for the 4 lane version, up to contractions into fma
+	vec3x4 result;
+	simd::float4 const mask = solve3(a.packet<vec3x4>(0), b.packet<vec3x4>(0), c.packet<vec3x4>(0), d.packet<vec3x4>(0), result);
+	test(simd::movemask(mask) == 1 << 3);
+	test(near(result.lane(0), x[0], 1e-5f) && near(result.lane(1), x[1], 1e-5f));
+
+	// The tolerance scales with the system
+	vec3_soa big_a(1), big_b(1), big_c(1), big_d(1), big_x;
+	big_a.set(0, vec3(1e5f, 0, 0));
+	big_b.set(0, vec3(0, 1e5f, 0));
+	big_c.set(0, vec3(0, 0, 1e-5f));
+	big_d.set(0, vec3(1e5f, 2e5f, 3e-5f));
+	test(solve3_batch(big_a, big_b, big_c, big_d, big_x) == 0);
+	test(near(big_x[0], vec3(1, 2, 3), 1e-5f));
+}
+
+void test_solve() {
+	test_solve_cramer();
+	test_solve_batch();
+}
@@ -0,0 +1,88 @@
+#include "test.hpp"
+
+#include <xmath/transform>
+#include <xmath/batch>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+static
+void test_free_functions() {
+	quat const q = quat::angle_axis(.7f, vec3(1, 2, 3).normalize());
+	mat3 const r = rotate(q), expected = q.to_mat3();
+	bool same = true;
+	for(unsigned i = 0; i < 9; i++) same &= r.data[i] == expected.data[i];
+	test(same);
+
+	test(near(mat4(scale(vec3(2, 3, 4))) * vec3(1, 1, 1), vec3(2, 3, 4)));
+	test(near(translate(vec3(1, 2, 3)) * vec3(1, 1, 1), vec3(2, 3, 4)));
+}
+
+static
+void test_affine3() {
+	std::mt19937 rng(18);
+
+	test(affine3().transform_point(vec3(1, 2, 3)) == vec3(1, 2, 3));
+	test(affine3::translation(vec3(1, 2, 3)).transform_vector(vec3(1, 1, 1)) == vec3(1, 1, 1));
+	test(affine3::scaling(vec3(2, 3, 4)) * vec3(1, 1, 1) == vec3(2, 3, 4));
+
+	bool mat4_ok = true, compose_ok = true, inverse_ok = true, rigid_ok = true, parts_ok = true;
+	for(int i = 0; i < 100; i++) {
+		vec3 const t = random_vec3(rng);
+		vec3 const s = random_vec3(rng, .5f, 2);
+		quat const r = random_rotation(rng);
+		vec3 const p = random_vec3(rng);
+
+		affine3 const a = affine3::compose(t, r, s);
+		affine3 const b = affine3::compose(random_vec3(rng), random_rotation(rng), random_vec3(rng, .5f, 2));
+		mat4 const m = mat4::translation(t) * mat4::rotation(r) * mat4(mat3(s));
+
+		mat4_ok    &= near(a.to_mat4(), m) && affine3(m) == affine3(a.to_mat4()) && near(a.transform_point(p), m * p);
+		compose_ok &= near((a * b).transform_point(p), a.transform_point(b.transform_point(p)), 1e-3f);
+		compose_ok &= near((a * b).to_mat4(), a.to_mat4() * b.to_mat4(), 1e-3f);
+		inverse_ok &= near(a.inverse().transform_point(a.transform_point(p)), p, 1e-3f);
+		inverse_ok &= near(a.inverse().to_mat4(), m.inverse_affine(), 1e-3f);
+		parts_ok   &= near(affine3(a.linear(), a.translation()).to_mat4(), m) && a.translation() == t;
+
+		affine3 const rigid = affine3::compose(t, r);
+		rigid_ok &= near(rigid.inverse_rigid().to_mat4(), rigid.inverse().to_mat4());
+	}
+	test(mat4_ok);
+	test(compose_ok);
+	test(inverse_ok);
+	test(rigid_ok);
+	test(parts_ok);
+	test(sizeof(affine3) == 3 * sizeof(vec4));
+
+	affine3 c = affine3::translation(vec3(1, 0, 0));
+	c *= affine3::scaling(vec3(2));
+	test(c.transform_point(vec3(1, 1, 1)) == vec3(3, 2, 2));
+}
+
+static
+void test_affine3_batch() {
+	std::mt19937 rng(19);
+	affine3 const a = affine3::compose(random_vec3(rng), random_rotation(rng), random_vec3(rng, .5f, 2));
+
+	std::vector<vec3> in(37), points(in.size()), vectors(in.size());
+	for(vec3& v : in) v = random_vec3(rng);
+	transform_points(a, in.data(), points.data(), in.size());
+	transform_vectors(a, in.data(), vectors.data(), in.size());
+
+	bool ok = true;
+	for(size_t i = 0; i < in.size(); i++) {
+		ok &= near(points[i], a.transform_point(in[i]));
+		ok &= near(vectors[i], a.transform_vector(in[i]));
+	}
+	test(ok);
+}
+
+void test_transform() {
+	test_free_functions();
+	test_affine3();
+	test_affine3_batch();
+}
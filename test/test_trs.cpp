@@ -0,0 +1,142 @@
+#include "test.hpp"
+
+#include <xmath/trs>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace stx;
+using namespace test_helpers;
+
+/// Same rotation, q and -q included
+static
+bool same_rotation(quat const& a, quat const& b, float eps = 1e-5f) {
+	return std::abs(std::abs(a.dot(b)) - 1) <= eps;
+}
+
+static
+void test_trs_ops() {
+	std::mt19937 rng(19);
+
+	test(near(trs().to_mat4(), mat4(), 0));
+
+	bool matrix_ok = true, compose_ok = true, inverse_ok = true, lerp_ok = true;
+	for(int i = 0; i < 100; i++) {
+		float const uniform = std::uniform_real_distribution<float>(.5f, 2)(rng);
+		trs const a(random_vec3(rng), random_rotation(rng), vec3(uniform));
+		trs const b(random_vec3(rng), random_rotation(rng), random_vec3(rng, .5f, 2));
+		vec3 const p = random_vec3(rng);
+
+		matrix_ok  &= near(b.to_mat4() * p, b.transform_point(p)) && near(b.to_mat4(), b.to_affine3().to_mat4());
+		matrix_ok  &= near(b.to_mat4(), mat4::translation(b.translation) * mat4::rotation(b.rotation) * mat4(mat3(b.scale)));
+		compose_ok &= near((a * b).to_mat4(), a.to_mat4() * b.to_mat4(), 1e-3f);
+		inverse_ok &= near(a.inverse().transform_point(a.transform_point(p)), p, 1e-3f);
+		inverse_ok &= near((a * a.inverse()).to_mat4(), mat4(), 1e-5f);
+
+		trs const half = a.lerp(b, .5f);
+		lerp_ok &= near(half.translation, (a.translation + b.translation) * .5f) && near(half.scale, (a.scale + b.scale) * .5f);
+		lerp_ok &= same_rotation(half.rotation, a.rotation.lerp(b.rotation, .5f));
+		lerp_ok &= same_rotation(a.slerp(b, .3f).rotation, a.rotation.slerp(b.rotation, .3f));
+	}
+	test(matrix_ok);
+	test(compose_ok);
+	test(inverse_ok);
+	test(lerp_ok);
+}
+
+static
+void test_trs_decompose() {
+	std::mt19937 rng(20);
+
+	bool roundtrip_ok = true;
+	for(int i = 0; i < 1000; i++) {
+		trs const t(random_vec3(rng), random_rotation(rng), random_vec3(rng, .1f, 10));
+		trs const d(t.to_mat4());
+		roundtrip_ok &= near(d.translation, t.translation) && near(d.scale, t.scale, 1e-4f) && same_rotation(d.rotation, t.rotation, 1e-5f);
+		roundtrip_ok &= d.rotation.w >= 0 && near(trs(t.to_affine3()).to_mat4(), t.to_mat4(), 1e-4f);
+	}
+	test(roundtrip_ok);
+
+	// to_mat4() is translation * rotation * scale, mat4::transform() translation * scale * rotation,
+	// which decomposes back for uniform scales only
+	bool transform_ok = true;
+	for(int i = 0; i < 100; i++) {
+		quat const r = random_rotation(rng);
+		vec3 const t = random_vec3(rng), s = random_vec3(rng, .1f, 10);
+		mat4 const m = mat4::translation(t) * mat4::rotation(r) * mat4::scaling(s);
+		trs const d(m);
+		transform_ok &= near(trs(t, r, s).to_mat4(), m, 1e-4f) && near(d.to_mat4(), m, 1e-4f);
+		transform_ok &= near(d.translation, t) && near(d.scale, s, 1e-4f) && same_rotation(d.rotation, r, 1e-5f);
+		transform_ok &= near(mat4::transform(r, t, s), mat4::translation(t) * mat4::scaling(s) * mat4::rotation(r), 1e-4f);
+
+		trs const u(mat4::transform(r, t, vec3(s.x)));
+		transform_ok &= near(u.translation, t) && near(u.scale, vec3(s.x), 1e-4f) && same_rotation(u.rotation, r, 1e-5f);
+	}
+	test(transform_ok);
+
+	// Rotations by (almost) 180 degrees, where the trace alone loses all precision
+	bool half_turn_ok = true;
+	for(vec3 const axis : { vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1), vec3(1, 2, 3).normalize() }) {
+		for(float angle : { 3.14159274f, 3.1415f, 3.14f }) {
+			quat const q = quat::angle_axis(angle, axis);
+			half_turn_ok &= same_rotation(trs(mat4::rotation(q)).rotation, q, 1e-6f);
+		}
+	}
+	test(half_turn_ok);
+
+	// A mirroring turns into a negative z scale, the rotation stays proper
+	trs const mirrored(mat4(mat3(vec3(-2, 3, 4))));
+	test(near(mirrored.to_mat4(), mat4(mat3(vec3(-2, 3, 4)))));
+	test(mirrored.scale.z < 0);
+
+	// Zero scales keep a valid rotation
+	for(vec3 const s : { vec3(0, 1, 1), vec3(1, 0, 1), vec3(1, 1, 0), vec3(0, 0, 2), vec3(0) }) {
+		quat const r = quat::angle_axis(.7f, vec3(1, 2, 3).normalize());
+		mat4 const m = mat4::translation(vec3(1, 2, 3)) * mat4::rotation(r) * mat4(mat3(s));
+		trs const d(m);
+		test(std::abs(d.rotation.length() - 1) < 1e-5f && near(d.to_mat4(), m));
+	}
+
+	// Sheared matrices keep the first axis and drop the shear
+	mat4 const sheared(
+		1, 1, 0, 0,
+		0, 1, 0, 0,
+		0, 0, 1, 0,
+		0, 0, 0, 1
+	);
+	trs const unsheared(sheared);
+	test(same_rotation(unsheared.rotation, quat()) && near(unsheared.scale, vec3(1)));
+}
+
+static
+void test_trs_batch() {
+	std::mt19937 rng(21);
+
+	std::vector<trs> transforms(103), decomposed(transforms.size());
+	for(trs& t : transforms) t = trs(random_vec3(rng), random_rotation(rng), random_vec3(rng, -3, 3));
+	transforms[5].scale = vec3(0, 1, 2);
+	transforms[6].scale = vec3(0);
+	transforms[7].rotation = quat::angle_axis(3.14159274f, vec3(0, 1, 0));
+
+	std::vector<mat4> matrices(transforms.size());
+	compose_batch(transforms.data(), matrices.data(), transforms.size());
+	decompose_batch(matrices.data(), decomposed.data(), matrices.size());
+
+	bool compose_ok = true, decompose_ok = true;
+	for(size_t i = 0; i < transforms.size(); i++) {
+		compose_ok &= near(matrices[i], transforms[i].to_mat4(), 1e-5f);
+
+		trs const single(matrices[i]);
+		decompose_ok &= near(decomposed[i].translation, single.translation, 1e-5f) && near(decomposed[i].scale, single.scale, 1e-5f);
+		decompose_ok &= same_rotation(decomposed[i].rotation, single.rotation) && near(decomposed[i].to_mat4(), matrices[i], 1e-4f);
+	}
+	test(compose_ok);
+	test(decompose_ok);
+}
+
+void test_trs() {
+	test_trs_ops();
+	test_trs_decompose();
+	test_trs_batch();
+}
@@ -3,6 +3,10 @@
 #include <xmath/vec2>
 #include <xmath/vec3>
 #include <xmath/vec4>
+#include <xmath/vec>
+#include <xmath/soa>
+
+#include <vector>
 
 #include <xlogging>
 
@@ -59,6 +63,93 @@ void test_vec3() {
 
 void test_vec4() {
 	test_vecN<vec4>();
+
+	{
+		vec4 a(1, 2, 3, 4);
+		vec4 b(8, 7, 6, 5);
+
+		test(a.dot(b) == 8 + 14 + 18 + 20);
+		test(a.min(b) == vec4(1, 2, 3, 4));
+		test(a.max(b) == vec4(8, 7, 6, 5));
+		test(-a == vec4(-1, -2, -3, -4));
+		test(a / 2 == vec4(.5f, 1, 1.5f, 2));
+		test(a.mix(b, .5f) == vec4(4.5f));
+		test(fabsf(vec4(2, 0, 0, 0).normalize().x - 1) < 1e-7f);
+		test(fabsf(vec4(1, 2, 2, 4).length() - 5) < 1e-6f);
+		test(a != b);
+	}
+}
+
+void test_vec_generic() {
+	test_vecN<dvec2>();
+	test_vecN<dvec3>();
+	test_vecN<ivec4>();
+	test_vecN<vec<5, double>>();
+
+	test(vec3(1, 2, 3) != vec3(1, 2, 4));
+	test(vec4::dimensions() == 4);
+
+	{
+		dvec3 a(1, 2, 3);
+		dvec3 b(-4, 5, .5);
+		dvec3 c = a.cross(b);
+		test(c.dot(a) == 0 && c.dot(b) == 0);
+		test(dot(a, b) == -4 + 10 + 1.5);
+		test(2 * a == dvec3(2, 4, 6));
+		test(a.x == 1 && a.y == 2 && a.z == 3);
+		test(fabs(dvec3(3, 0, 4).length() - 5) < 1e-12);
+		test(a.mix(b, .5) == dvec3(-1.5, 3.5, 1.75));
+
+		// Large world coordinates keep their precision in double
+		dvec3 const far(1e9, 0, 0);
+		test((far + dvec3(.25, 0, 0)).x - far.x == .25);
+	}
+
+	{
+		ivec2 a(7, -3);
+		ivec2 b(2, 2);
+		test(a / b == ivec2(3, -1));
+		test(a % b == ivec2(1, -1));
+		test(a.min(b) == ivec2(2, -3));
+		test(a.abs() == ivec2(7, 3));
+		test(a.length2() == 58);
+		test(fabs(ivec2(3, 4).length() - 5) < 1e-12);
+	}
+
+	{
+		// Conversions between the element types and the float vectors
+		vec3 const f(1.5f, -2.25f, 8);
+		dvec3 const d(f);
+		test(d == dvec3(1.5, -2.25, 8));
+		test(vec3(d) == f);
+		test(ivec3(d.floor()) == ivec3(1, -3, 8));
+		test(dvec4(vec4(1, 2, 3, 4)) == dvec4(1, 2, 3, 4));
+		test(vec2(dvec2(.5, 2)) == vec2(.5f, 2));
+	}
+
+	{
+		constexpr ivec3 c = ivec3(1, 2, 3) * 2 + ivec3(1);
+		static_assert(c.dot(ivec3(1, 1, 1)) == 15, "generic vec arithmetic is constexpr");
+		test(c == ivec3(3, 5, 7));
+	}
+
+	{
+		// simd::double4 kernels with STX_MATH_SIMD
+		test_vecN<dvec4>();
+
+		dvec4 const a(1, 2, 3, 4);
+		dvec4 const b(8, 7, 6, 5);
+		test(a.dot(b) == 8 + 14 + 18 + 20);
+		test(a - b == dvec4(-7, -5, -3, -1));
+		test(-a == dvec4(-1, -2, -3, -4));
+		test(a / 2 == dvec4(.5, 1, 1.5, 2));
+		test(b / a == dvec4(8, 3.5, 2, 1.25));
+		test(2 * a == dvec4(2, 4, 6, 8));
+		test(a.mix(b, .5) == dvec4(4.5));
+
+		constexpr dvec4 c = dvec4(1, 2, 3, 4) * 2. - dvec4(1);
+		static_assert(c.dot(dvec4(1, 1, 1, 1)) == 16, "dvec4 arithmetic is constexpr");
+	}
 }
 
 void test_vec3_lookAt() {
@@ -72,6 +163,73 @@ void test_vec3_lookAt() {
 	info("Look along forward: %% %% %%", fwd.x, fwd.y, fwd.z);
 }
 
+template<typename Packet>
+void test_vec3_packet() {
+	constexpr unsigned N = Packet::width;
+
+	vec3 a[N], b[N];
+	for(unsigned i = 0; i < N; i++) {
+		a[i] = vec3(i + 1.f, 7.f - i * 2, (i % 3) * 1.5f);
+		b[i] = vec3(3.f - i, i * .5f + 1, 2.f);
+	}
+
+	Packet pa = Packet::load(a);
+	Packet pb = Packet::load(b);
+
+	auto close = [](vec3 const& x, vec3 const& y) { return (x - y).length2() < 1e-10f; };
+
+	bool ok = true;
+	Packet cross = pa.cross(pb), normal = pa.normalize(), mixed = pa.mix(pb, .25f), mn = pa.min(pb), mx = pa.max(pb);
+	Packet longest = pa.longest_axis();
+	auto dot = pa.dot(pb);
+	for(unsigned i = 0; i < N; i++) {
+		ok &= close(cross.lane(i), a[i].cross(b[i]));
+		ok &= close(normal.lane(i), a[i].normalize());
+		ok &= close(mixed.lane(i), a[i].mix(b[i], .25f));
+		ok &= mn.lane(i) == a[i].min(b[i]);
+		ok &= mx.lane(i) == a[i].max(b[i]);
+		ok &= fabsf(dot[i] - a[i].dot(b[i])) < 1e-5f;
+
+		unsigned axis = a[i].longest_axis();
+		ok &= (simd::movemask(longest.x) >> i & 1) == (axis == 0);
+		ok &= (simd::movemask(longest.y) >> i & 1) == (axis == 1);
+		ok &= (simd::movemask(longest.z) >> i & 1) == (axis == 2);
+	}
+	test(ok);
+
+	vec3 roundtrip[N];
+	pa.store(roundtrip);
+	bool same = true;
+	for(unsigned i = 0; i < N; i++) same &= roundtrip[i] == a[i];
+	test(same);
+}
+
+void test_vec_soa() {
+	std::vector<vec3> v;
+	for(int i = 0; i < 11; i++) v.push_back(vec3(i, i * 2, i * 3));
+
+	vec3_soa soa(v.data(), v.size());
+	test(soa.size() == 11);
+	test(soa[10] == vec3(10, 20, 30));
+	test(soa.x[5] == 5 && soa.y[5] == 10 && soa.z[5] == 15);
+
+	vec3x4 p = soa.packet<vec3x4>(4);
+	test(p.lane(3) == vec3(7, 14, 21));
+	soa.store(0, p);
+	test(soa[0] == vec3(4, 8, 12));
+
+	std::vector<vec3> back(soa.size());
+	soa.to_aos(back.data());
+	test(back[10] == v[10] && back[0] == vec3(4, 8, 12));
+
+	std::vector<vec4> v4;
+	for(int i = 0; i < 6; i++) v4.push_back(vec4(i, -i, i * i, 1));
+	vec4_soa soa4(v4.data(), v4.size());
+	std::vector<vec4> back4(v4.size());
+	soa4.to_aos(back4.data());
+	test(soa4.z[5] == 25 && back4[5] == v4[5] && back4[1] == v4[1]);
+}
+
 } // namespace
 
 void test_vec() {
@@ -79,4 +237,8 @@ void test_vec() {
 	test_vec3();
 	test_vec3_lookAt();
 	test_vec4();
+	test_vec3_packet<vec3x4>();
+	test_vec3_packet<vec3x8>();
+	test_vec_soa();
+	test_vec_generic();
 }